@@ -17,6 +17,8 @@
 #ifndef __TIZEN_MEDIA_AUDIO_IO_H__
 #define __TIZEN_MEDIA_AUDIO_IO_H__
 
+#include <time.h>
+#include <sys/uio.h>
 #include <tizen.h>
 #include <sound_manager.h>
 
@@ -42,6 +44,36 @@ extern "C"
  */
 typedef struct audio_in_s *audio_in_h;
 
+/**
+ * @brief  Called when a period of audio data has been captured in asynchronous (callback) mode
+ *
+ * @remarks  This callback is invoked on the capture thread owned by the library, not on the application thread.\n
+ * @a buffer is only valid until the callback returns.
+ *
+ * @param[in]  handle     The handle to the audio input
+ * @param[in]  buffer     The captured PCM data
+ * @param[in]  length     The length of captured PCM data (in bytes)
+ * @param[in]  user_data  The user data passed from the callback registration function
+ * @see audio_in_set_stream_cb()
+ */
+typedef void (*audio_in_stream_cb)(audio_in_h handle, const void *buffer, unsigned int length, void *user_data);
+
+/**
+ * @brief Called by the capture processing chain to process a chunk of recorded data in place
+ *
+ * @remarks  The data is the device format of the handle converted to float in -1.0 ~ 1.0, before any conversion
+ * to the sample rate, channel type and sample type of the handle. It is called on the thread reading the data.
+ *
+ * @param[in]      handle       The handle to the audio input
+ * @param[in,out]  data         The interleaved samples
+ * @param[in]      channels     The number of channels of @a data
+ * @param[in]      sample_rate  The sample rate of @a data
+ * @param[in]      frames       The number of frames in @a data
+ * @param[in]      user_data    The user data passed from the callback registration function
+ * @see audio_in_add_custom_process_stage()
+ */
+typedef void (*audio_in_process_cb)(audio_in_h handle, float *data, int channels, int sample_rate, unsigned int frames, void *user_data);
+
 /**
  * @}
 */
@@ -56,6 +88,33 @@ typedef struct audio_in_s *audio_in_h;
  */
 typedef struct audio_out_s *audio_out_h;
 
+/**
+ * @brief  Called when the audio output device needs more audio data in pull (callback) mode
+ *
+ * @remarks  This callback is invoked on the render thread owned by the library, not on the application thread.\n
+ * The callback must fill the whole @a buffer; the data is written to the device when the callback returns.
+ *
+ * @param[in]   handle     The handle to the audio output
+ * @param[out]  buffer     The PCM buffer to fill
+ * @param[in]   length     The length of @a buffer (in bytes), which is always the size from audio_out_get_buffer_size()
+ * @param[in]   user_data  The user data passed from the callback registration function
+ * @see audio_out_set_stream_cb()
+ */
+typedef void (*audio_out_stream_cb)(audio_out_h handle, void *buffer, unsigned int length, void *user_data);
+
+/**
+ * @brief  Called when the playback of a file started by audio_out_play_file() ends
+ *
+ * @remarks  This callback is invoked on the playback thread owned by the library. It is not invoked when the playback
+ * is stopped by audio_out_stop_file(), audio_out_unprepare() or audio_out_destroy(), which must not be called from it.
+ *
+ * @param[in]  handle     The handle to the audio output
+ * @param[in]  result     #AUDIO_IO_ERROR_NONE when the whole file was played, otherwise the error that stopped the playback
+ * @param[in]  user_data  The user data passed from the callback registration function
+ * @see audio_out_play_file()
+ */
+typedef void (*audio_out_playback_cb)(audio_out_h handle, int result, void *user_data);
+
  /**
  * @}
  */
@@ -72,6 +131,9 @@ typedef enum
 {
     AUDIO_SAMPLE_TYPE_U8 = 0x70,   /**< Unsigned 8-bit audio samples */
     AUDIO_SAMPLE_TYPE_S16_LE,   /**< Signed 16-bit audio samples */
+    AUDIO_SAMPLE_TYPE_S24_LE,   /**< Signed 24-bit audio samples, packed in 3 bytes */
+    AUDIO_SAMPLE_TYPE_S32_LE,   /**< Signed 32-bit audio samples */
+    AUDIO_SAMPLE_TYPE_FLOAT32_LE,   /**< 32-bit floating point audio samples in the range [-1.0, 1.0] */
 } audio_sample_type_e;
 
 /**
@@ -80,6 +142,12 @@ typedef enum
 typedef enum {
     AUDIO_CHANNEL_MONO = 0x80,    /**< 1 channel, mono */
     AUDIO_CHANNEL_STEREO,      /**< 2 channel, stereo */
+    AUDIO_CHANNEL_MULTI_3,     /**< 3 channel, FL FR FC */
+    AUDIO_CHANNEL_MULTI_4,     /**< 4 channel, quad : FL FR BL BR */
+    AUDIO_CHANNEL_MULTI_5,     /**< 5 channel, FL FR FC BL BR */
+    AUDIO_CHANNEL_MULTI_6,     /**< 6 channel, 5.1 : FL FR FC LFE BL BR */
+    AUDIO_CHANNEL_MULTI_7,     /**< 7 channel, 6.1 : FL FR FC LFE BC SL SR */
+    AUDIO_CHANNEL_MULTI_8,     /**< 8 channel, 7.1 : FL FR FC LFE BL BR SL SR */
 } audio_channel_e;
 
 /**
@@ -90,328 +158,2009 @@ typedef enum{
     AUDIO_IO_ERROR_OUT_OF_MEMORY       = TIZEN_ERROR_OUT_OF_MEMORY,     /**< Out of memory */
     AUDIO_IO_ERROR_INVALID_PARAMETER   = TIZEN_ERROR_INVALID_PARAMETER, /**< Invalid parameter */
     AUDIO_IO_ERROR_INVALID_OPERATION   = TIZEN_ERROR_INVALID_OPERATION, /**< Invalid operation */
+    AUDIO_IO_ERROR_PERMISSION_DENIED   = TIZEN_ERROR_PERMISSION_DENIED, /**< Permission denied */
     AUDIO_IO_ERROR_DEVICE_NOT_OPENED   = AUDIO_IO_ERROR_CLASS | 0x01, /**< Device open error */
     AUDIO_IO_ERROR_DEVICE_NOT_CLOSED   = AUDIO_IO_ERROR_CLASS | 0x02, /**< Device close error */
     AUDIO_IO_ERROR_INVALID_BUFFER      = AUDIO_IO_ERROR_CLASS | 0x03, /**< Invalid buffer pointer */
     AUDIO_IO_ERROR_SOUND_POLICY        = AUDIO_IO_ERROR_CLASS | 0x04, /**< Sound policy error */
 } audio_io_error_e;
 
+/**
+ * @brief Enumerations of library log level
+ * @remarks Errors are always logged regardless of the log level.
+ */
+typedef enum {
+    AUDIO_IO_LOG_LEVEL_ERROR,      /**< Log errors only */
+    AUDIO_IO_LOG_LEVEL_WARNING,    /**< Log errors and warnings (default) */
+    AUDIO_IO_LOG_LEVEL_INFO,       /**< Also log informational messages; per-call I/O messages are rate limited */
+    AUDIO_IO_LOG_LEVEL_DEBUG,      /**< Log everything */
+} audio_io_log_level_e;
+
+/**
+ * @brief Enumerations of resampler quality, used for sample rates the device does not support
+ */
+typedef enum {
+    AUDIO_IO_RESAMPLER_QUALITY_LOW,      /**< Shortest filter, lowest CPU load */
+    AUDIO_IO_RESAMPLER_QUALITY_MEDIUM,   /**< Balanced quality and CPU load (default) */
+    AUDIO_IO_RESAMPLER_QUALITY_HIGH,     /**< Longest filter, widest passband and best stopband rejection */
+} audio_io_resampler_quality_e;
+
+/**
+ * @brief Enumerations of latency class, which selects the period size and count of a handle
+ */
+typedef enum {
+    AUDIO_IO_LATENCY_CLASS_DEFAULT,        /**< Period of the device buffer size (default) */
+    AUDIO_IO_LATENCY_CLASS_LOW,            /**< Periods of about 5 ms with 2 periods queued, for voice and games */
+    AUDIO_IO_LATENCY_CLASS_POWER_SAVING,   /**< Periods of about 100 ms, for background playback */
+} audio_io_latency_class_e;
+
+/**
+ * @brief Enumerations of the shape of a volume ramp
+ */
+typedef enum {
+    AUDIO_IO_VOLUME_RAMP_LINEAR,        /**< The gain changes by the same amount every frame (default) */
+    AUDIO_IO_VOLUME_RAMP_EXPONENTIAL,   /**< The gain changes by the same number of decibels every frame */
+} audio_io_volume_ramp_e;
+
+/**
+ * @brief Enumerations of the built-in stages of the capture processing chain
+ */
+typedef enum {
+    AUDIO_IO_PROCESS_STAGE_DC_BLOCKER,   /**< First order DC blocker; the parameter is the corner frequency in Hz */
+    AUDIO_IO_PROCESS_STAGE_HIGH_PASS,    /**< Second order Butterworth high-pass filter; the parameter is the cutoff frequency in Hz */
+    AUDIO_IO_PROCESS_STAGE_AGC,          /**< Automatic gain control of -20 dB ~ +30 dB; the parameter is the target peak level in -60 ~ 0 dBFS */
+    AUDIO_IO_PROCESS_STAGE_NOISE_GATE,   /**< Noise gate with 6 dB of hysteresis; the parameter is the opening threshold in -96 ~ 0 dBFS */
+} audio_io_process_stage_e;
+
+/**
+ * @brief Enumerations of the backend a handle transfers its data through
+ */
+typedef enum {
+    AUDIO_IO_BACKEND_DEFAULT,    /**< The backend named by the @c AUDIO_IO_BACKEND environment variable, or mm-sound (default) */
+    AUDIO_IO_BACKEND_MM_SOUND,   /**< The sound server */
+    AUDIO_IO_BACKEND_NULL,       /**< Output is discarded and input is silence, both as fast as the application transfers */
+    AUDIO_IO_BACKEND_FILE,       /**< Output is written to a WAV file and input is read from one */
+    AUDIO_IO_BACKEND_LOOPBACK,   /**< Output is captured by the input handle connected to the same loopback name */
+} audio_io_backend_e;
+
+/**
+ * @brief Enumerations of the scheduling policy of audio threads
+ */
+typedef enum {
+    AUDIO_IO_THREAD_POLICY_NORMAL,   /**< The default time sharing policy (default) */
+    AUDIO_IO_THREAD_POLICY_FIFO,     /**< Real-time first in, first out policy (SCHED_FIFO) */
+    AUDIO_IO_THREAD_POLICY_RR,       /**< Real-time round robin policy (SCHED_RR) */
+} audio_io_thread_policy_e;
+
+/**
+ * @brief Enumerations of the file formats audio_in_start_recording() writes and audio_out_play_file() reads
+ */
+typedef enum {
+    AUDIO_IO_CONTAINER_WAV,   /**< WAV file with a 44 byte header, IEEE float for #AUDIO_SAMPLE_TYPE_FLOAT32_LE and PCM otherwise */
+    AUDIO_IO_CONTAINER_RAW,   /**< The samples alone, in the format of the handle */
+} audio_io_container_e;
+
+/**
+ * @brief Audio handle attribute type, used to create handles with audio_in_create_ex() and audio_out_create_ex()
+ */
+typedef struct audio_io_attr_s *audio_io_attr_h;
+
+/**
+ * @brief Number of buckets in the per-call latency histogram of #audio_io_stats_s
+ */
+#define AUDIO_IO_STATS_LATENCY_BUCKETS	20
+
+/**
+ * @brief Performance statistics of an audio input or output handle
+ * @remarks  Bucket @c i of @a latency_histogram counts device calls that took 2^i to 2^(i+1) microseconds;
+ * the last bucket also counts all slower calls. @a xrun_count is estimated from gaps between device calls
+ * longer than one buffer period.
+ */
+typedef struct {
+	unsigned long long total_bytes;			/**< Total bytes transferred to or from the device */
+	unsigned long long call_count;			/**< Number of device read or write calls */
+	unsigned long long blocked_time_us;		/**< Total time spent blocked in the device (in microseconds) */
+	unsigned long long short_count;			/**< Number of calls that transferred fewer bytes than requested */
+	unsigned long long xrun_count;			/**< Number of underruns (output) or overruns (input) */
+	unsigned long long latency_histogram[AUDIO_IO_STATS_LATENCY_BUCKETS];	/**< Per-call latency histogram */
+} audio_io_stats_s;
+
+/**
+ * @brief Real-time settings a handle was granted
+ * @remarks  The thread fields describe the last thread the library started for the handle, or the mixer thread
+ * of a mixed output, and hold #AUDIO_IO_THREAD_POLICY_NORMAL until one runs.
+ */
+typedef struct {
+	audio_io_thread_policy_e policy;	/**< Scheduling policy of the library thread */
+	int priority;				/**< Real-time priority of the library thread, 0 for #AUDIO_IO_THREAD_POLICY_NORMAL */
+	unsigned long long cpu_mask;		/**< CPUs the library thread was bound to, 0 when it kept the inherited affinity */
+	bool memory_locked;			/**< Whether the buffers of the handle are locked in memory */
+} audio_io_realtime_status_s;
+
+/**
+ * @brief Progress of a recording started by audio_in_start_recording()
+ * @remarks  A period is dropped whole when the writer thread is so far behind that the recording queue cannot hold it.
+ */
+typedef struct {
+	unsigned long long captured_periods;	/**< Number of periods captured */
+	unsigned long long dropped_periods;	/**< Number of captured periods dropped because the queue was full or the file could not be written */
+	unsigned long long written_bytes;	/**< Bytes of audio data written to the file */
+	bool write_error;			/**< Whether writing to the file failed, after which the captured data is dropped */
+} audio_io_recording_status_s;
+
+/**
+ * @brief Maximum number of idle handles the handle cache can hold
+ */
+#define AUDIO_IO_HANDLE_CACHE_MAX	64
+
+/**
+ * @brief Duration of audio the recording queue of audio_in_start_recording() holds, in milliseconds
+ */
+#define AUDIO_IO_RECORDING_QUEUE_MS	2000
+
+/**
+ * @brief Statistics of the handle cache
+ */
+typedef struct {
+	unsigned long long hits;		/**< Number of creates served from the cache */
+	unsigned long long misses;		/**< Number of creates that opened a new stream while the cache was enabled */
+	unsigned long long evictions;		/**< Number of idle streams closed because the cache was full or they timed out */
+	unsigned int idle_handles;		/**< Number of idle streams currently held */
+} audio_io_handle_cache_stats_s;
+
+/**
+ * @brief Full-duplex handle type, an audio input and an audio output driven by one thread.
+ */
+typedef struct _audio_io_duplex_s *audio_io_duplex_h;
+
+/**
+ * @brief Timing of a period exchanged by a full-duplex handle
+ *
+ * @details  Both directions move the same number of frames per period, so @a frames counts the frames of either.
+ *           The difference between @a playback_time and @a capture_time is the echo path delay of the library and the devices.
+ */
+typedef struct {
+	unsigned long long frames;		/**< Frames captured and played before this period since audio_io_duplex_prepare() */
+	struct timespec capture_time;		/**< @c CLOCK_MONOTONIC time at which the first input frame was captured */
+	struct timespec playback_time;		/**< @c CLOCK_MONOTONIC time at which the first output frame is expected to be played */
+} audio_io_duplex_timing_s;
+
+/**
+ * @brief  Called once per period of a full-duplex handle with the captured data and the data to play
+ *
+ * @remarks  This callback is invoked on the thread owned by the handle. The callback must fill the whole @a output;
+ * @a input and @a output are only valid until the callback returns.
+ *
+ * @param[in]   duplex     The full-duplex handle
+ * @param[in]   input      The captured PCM data
+ * @param[out]  output     The PCM buffer to fill, played after the data of the previous periods
+ * @param[in]   length     The length of @a input and @a output (in bytes), which is the size from audio_io_duplex_get_buffer_size()
+ * @param[in]   timing     The timing of the period
+ * @param[in]   user_data  The user data passed from the callback registration function
+ * @see audio_io_duplex_set_cb()
+ */
+typedef void (*audio_io_duplex_cb)(audio_io_duplex_h duplex, const void *input, void *output, unsigned int length,
+		const audio_io_duplex_timing_s *timing, void *user_data);
+
+
+/**
+ * @brief    Sets the log level of the library for the whole process
+ *
+ * @details  The initial level is #AUDIO_IO_LOG_LEVEL_WARNING, or the value of the @c AUDIO_IO_LOG_LEVEL
+ *           environment variable ("error", "warning", "info" or "debug") if it is set.
+ *           Levels above the one the library was built with are never logged.
+ *
+ * @param[in]  level  The log level
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_io_get_log_level()
+ */
+int audio_io_set_log_level(audio_io_log_level_e level);
+
+/**
+ * @brief    Gets the log level of the library
+ *
+ * @param[out]  level  The log level
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_io_set_log_level()
+ */
+int audio_io_get_log_level(audio_io_log_level_e *level);
+
+/**
+ * @brief    Enables, resizes or disables the handle cache of the process
+ *
+ * @details  While the cache is enabled, audio_in_destroy() and audio_out_destroy() keep the device stream open
+ *           and idle, and a later audio_in_create() or audio_out_create() with the same device format takes it
+ *           back instead of opening a new one, which can take tens of milliseconds.
+ *           Streams are matched on the sample rate, channel and sample type the device plays
+ *           (and the sound type for output), so handles that differ only in conversion share streams.
+ *           When the cache is full, the stream idle for the longest time is closed.
+ *
+ * @remarks  The cache is disabled by default. Shrinking the cache closes the oldest idle streams,
+ *           and a @a max_handles of 0 closes them all.
+ *
+ * @param[in]  max_handles      The maximum number of idle streams to keep, up to #AUDIO_IO_HANDLE_CACHE_MAX (0 disables the cache)
+ * @param[in]  idle_timeout_ms  The time after which an idle stream is closed, in milliseconds (0 keeps idle streams until reused or evicted)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_in_prefill_handle_cache()
+ * @see audio_out_prefill_handle_cache()
+ * @see audio_io_get_handle_cache_stats()
+ */
+int audio_io_set_handle_cache(unsigned int max_handles, unsigned int idle_timeout_ms);
+
+/**
+ * @brief    Gets the statistics of the handle cache
+ *
+ * @param[out]  stats  The cache statistics
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_io_set_handle_cache()
+ */
+int audio_io_get_handle_cache_stats(audio_io_handle_cache_stats_s *stats);
+
+/**
+ * @brief    Sets the scheduling policy, priority and CPU affinity of the audio threads the library starts
+ *
+ * @details  Applies to the stream callback and non-blocking drain threads of handles created without a thread
+ *           policy in their attribute, and to the mixer threads of audio_out_create_mixed(). Threads started
+ *           after the call use the new settings. When the process may not use a real-time policy, the threads
+ *           keep the normal policy and audio_in_get_realtime_status() or audio_out_get_realtime_status() reports it.
+ *
+ * @param[in]  policy    The scheduling policy
+ * @param[in]  priority  The real-time priority in 1 ~ 99, ignored for #AUDIO_IO_THREAD_POLICY_NORMAL
+ * @param[in]  cpu_mask  The CPUs the threads may run on, bit @c i for CPU @c i, or 0 to keep the affinity of the thread that starts them
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_io_get_thread_policy()
+ * @see audio_io_attr_set_thread_policy()
+ */
+int audio_io_set_thread_policy(audio_io_thread_policy_e policy, int priority, unsigned long long cpu_mask);
+
+/**
+ * @brief    Gets the scheduling policy, priority and CPU affinity of the audio threads the library starts
+ *
+ * @param[out]  policy    The scheduling policy
+ * @param[out]  priority  The real-time priority
+ * @param[out]  cpu_mask  The CPUs the threads may run on, 0 when the affinity is inherited
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_io_set_thread_policy()
+ */
+int audio_io_get_thread_policy(audio_io_thread_policy_e *policy, int *priority, unsigned long long *cpu_mask);
+
+/**
+ * @brief    Sets the scheduling policy, priority and CPU affinity of the calling thread
+ *
+ * @details  Meant for application threads that call audio_out_write() or audio_in_read() with low latency.
+ *           When the real-time policy is not permitted the thread keeps its policy, the CPU affinity is still
+ *           applied and #AUDIO_IO_ERROR_PERMISSION_DENIED is returned.
+ *
+ * @param[in]  policy    The scheduling policy
+ * @param[in]  priority  The real-time priority in 1 ~ 99, ignored for #AUDIO_IO_THREAD_POLICY_NORMAL
+ * @param[in]  cpu_mask  The CPUs the thread may run on, bit @c i for CPU @c i, or 0 to leave the affinity unchanged
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_PERMISSION_DENIED The policy or the affinity could not be applied
+ */
+int audio_io_set_current_thread_policy(audio_io_thread_policy_e policy, int priority, unsigned long long cpu_mask);
+
+/**
+ * @brief    Releases a buffer allocated by audio_in_buffer_alloc() or audio_out_buffer_alloc()
+ *
+ * @details  The buffer returns to a pool shared by the process, so that a later allocation of the same size
+ *           does not go to the system allocator. It may be released after the handle it was sized for is destroyed.
+ *
+ * @param[in]  buffer  The buffer to release
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER @a buffer is NULL or was not allocated by the library
+ * @see audio_in_buffer_alloc()
+ * @see audio_out_buffer_alloc()
+ */
+int audio_io_buffer_free(void *buffer);
+
+/**
+ * @brief    Creates a handle attribute with the default latency class and no period request
+ *
+ * @remarks  @a attr must be released by audio_io_attr_destroy().
+ *
+ * @param[out]  attr  The handle attribute
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @see audio_io_attr_destroy()
+ */
+int audio_io_attr_create(audio_io_attr_h *attr);
+
+/**
+ * @brief    Destroys a handle attribute
+ *
+ * @param[in]  attr  The handle attribute
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_io_attr_create()
+ */
+int audio_io_attr_destroy(audio_io_attr_h attr);
+
+/**
+ * @brief    Sets the latency class, which selects the period size and count that are not set explicitly
+ *
+ * @param[in]  attr           The handle attribute
+ * @param[in]  latency_class  The latency class
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_set_latency_class(audio_io_attr_h attr, audio_io_latency_class_e latency_class);
+
+/**
+ * @brief    Gets the latency class
+ *
+ * @param[in]   attr           The handle attribute
+ * @param[out]  latency_class  The latency class
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_get_latency_class(audio_io_attr_h attr, audio_io_latency_class_e *latency_class);
+
+/**
+ * @brief    Requests the period size, the amount of data transferred to or from the device at a time
+ *
+ * @remarks  The granted size is at least 32 frames and at most one second of audio,
+ *           and is rounded to the granularity of the device.
+ *
+ * @param[in]  attr         The handle attribute
+ * @param[in]  period_size  The period size in frames of the handle sample rate, 0 for the latency class default
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_set_period_size(audio_io_attr_h attr, unsigned int period_size);
+
+/**
+ * @brief    Gets the period size, which is the granted size once a handle was created with @a attr
+ *
+ * @param[in]   attr         The handle attribute
+ * @param[out]  period_size  The period size in frames
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_get_period_size(audio_io_attr_h attr, unsigned int *period_size);
+
+/**
+ * @brief    Requests the number of periods an output handle queues in non-blocking mode
+ *
+ * @remarks  The granted count is between 2 and 16. Input handles always report a count of 1.
+ *
+ * @param[in]  attr          The handle attribute
+ * @param[in]  period_count  The period count, 0 for the latency class default
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_set_period_count(audio_io_attr_h attr, unsigned int period_count);
+
+/**
+ * @brief    Gets the period count, which is the granted count once a handle was created with @a attr
+ *
+ * @param[in]   attr          The handle attribute
+ * @param[out]  period_count  The period count
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_get_period_count(audio_io_attr_h attr, unsigned int *period_count);
+
+/**
+ * @brief    Selects the backend of the handle and the file or loopback name it uses
+ *
+ * @details  #AUDIO_IO_BACKEND_FILE handles read from or write to the WAV file at @a path. An input file must hold
+ *           PCM in the device format of the handle : mono for mono handles and stereo otherwise, 8-bit for
+ *           #AUDIO_SAMPLE_TYPE_U8 and 16-bit otherwise, at the sample rate clamped to 8000 ~ 48000 Hz.
+ *           It is followed by silence once it is read to the end.
+ *           #AUDIO_IO_BACKEND_LOOPBACK connects at most one output handle to at most one input handle of the same
+ *           format through the loopback named @a path. The input waits up to one period for the output data and
+ *           hears silence when nothing was played; the output blocks while the input has not taken the data yet,
+ *           and is discarded while no input is capturing.
+ *
+ * @remarks  When @a path is @c NULL, the @c AUDIO_IO_BACKEND_IN_PATH or @c AUDIO_IO_BACKEND_OUT_PATH environment
+ *           variable is used, and the loopback named "default" if that is not set either.
+ *           The @c AUDIO_IO_BACKEND environment variable ("mm-sound", "null", "file" or "loopback") selects the backend
+ *           of handles created without an attribute, and of the mixers of audio_out_create_mixed().
+ *           Only mm-sound streams are kept in the handle cache.
+ *
+ * @param[in]  attr     The handle attribute
+ * @param[in]  backend  The backend
+ * @param[in]  path     The WAV file path or loopback name, or @c NULL for the environment default
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ */
+int audio_io_attr_set_backend(audio_io_attr_h attr, audio_io_backend_e backend, const char *path);
+
+/**
+ * @brief    Gets the backend selected in the attribute
+ *
+ * @param[in]   attr     The handle attribute
+ * @param[out]  backend  The backend
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_get_backend(audio_io_attr_h attr, audio_io_backend_e *backend);
+
+/**
+ * @brief    Sets the scheduling policy, priority and CPU affinity of the threads the library starts for the handle
+ *
+ * @remarks  Handles created without this setting follow audio_io_set_thread_policy().
+ *
+ * @param[in]  attr      The handle attribute
+ * @param[in]  policy    The scheduling policy
+ * @param[in]  priority  The real-time priority in 1 ~ 99, ignored for #AUDIO_IO_THREAD_POLICY_NORMAL
+ * @param[in]  cpu_mask  The CPUs the threads may run on, bit @c i for CPU @c i, or 0 to keep the affinity of the thread that starts them
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_set_thread_policy(audio_io_attr_h attr, audio_io_thread_policy_e policy, int priority, unsigned long long cpu_mask);
+
+/**
+ * @brief    Gets the thread settings of the attribute, which are the audio_io_set_thread_policy() ones if none were set
+ *
+ * @param[in]   attr      The handle attribute
+ * @param[out]  policy    The scheduling policy
+ * @param[out]  priority  The real-time priority
+ * @param[out]  cpu_mask  The CPUs the threads may run on, 0 when the affinity is inherited
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_get_thread_policy(audio_io_attr_h attr, audio_io_thread_policy_e *policy, int *priority, unsigned long long *cpu_mask);
+
+/**
+ * @brief    Requests the buffers and queue memory of the handle to be locked in memory while it is prepared
+ *
+ * @details  Locked buffers never page fault, so a real-time thread does not wait on the memory manager.
+ *           When the process may not lock that much memory the buffers stay unlocked, and
+ *           audio_in_get_realtime_status() or audio_out_get_realtime_status() reports it.
+ *
+ * @param[in]  attr  The handle attribute
+ * @param[in]  lock  @c true to lock the buffers, @c false to leave them pageable (default)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_set_memory_lock(audio_io_attr_h attr, bool lock);
+
+/**
+ * @brief    Gets whether the buffers of handles created with the attribute are locked in memory
+ *
+ * @param[in]   attr  The handle attribute
+ * @param[out]  lock  Whether the buffers are locked
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_attr_get_memory_lock(audio_io_attr_h attr, bool *lock);
+
+/**
+ * @brief    Creates a full-duplex handle, an audio input and an audio output of the same format that run in lock-step
+ *
+ * @details  One thread reads a period from the input, passes it with a period to play to the callback set by
+ *           audio_io_duplex_set_cb() and writes that period to the output, so both directions share one sample clock.
+ *           The period is the capture period of the input. The attribute, if any, applies to both directions.
+ *
+ * @remarks  @a duplex must be released by audio_io_duplex_destroy().
+ *
+ * @param[in]   sample_rate  The audio sample rate in 8000[Hz] ~ 192000[Hz]
+ * @param[in]   channel      The audio channel type
+ * @param[in]   type         The type of audio sample
+ * @param[in]   sound_type   The type of sound of the output (#sound_type_e)
+ * @param[in]   attr         The handle attribute, or @c NULL for the defaults
+ * @param[out]  duplex       The full-duplex handle
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
+ * @see audio_io_duplex_destroy()
+ */
+int audio_io_duplex_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type,
+		audio_io_attr_h attr, audio_io_duplex_h *duplex);
+
+/**
+ * @brief    Stops and releases a full-duplex handle and its input and output
+ *
+ * @param[in]  duplex  The full-duplex handle
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_SOUND_POLICY Sound policy error
+ * @see audio_io_duplex_create()
+ */
+int audio_io_duplex_destroy(audio_io_duplex_h duplex);
+
+/**
+ * @brief    Sets the callback that exchanges the periods of a full-duplex handle
+ *
+ * @param[in]  duplex     The full-duplex handle
+ * @param[in]  callback   The callback
+ * @param[in]  user_data  The user data to be passed to the callback
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is running
+ */
+int audio_io_duplex_set_cb(audio_io_duplex_h duplex, audio_io_duplex_cb callback, void *user_data);
+
+/**
+ * @brief    Starts capturing and playing, and the thread that calls the callback
+ *
+ * @details  The output starts with one period of silence, so that it has data to play while the first period is captured.
+ *
+ * @param[in]  duplex  The full-duplex handle
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is running or has no callback
+ * @see audio_io_duplex_unprepare()
+ */
+int audio_io_duplex_prepare(audio_io_duplex_h duplex);
+
+/**
+ * @brief    Stops capturing and playing, and joins the thread that calls the callback
+ *
+ * @param[in]  duplex  The full-duplex handle
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_io_duplex_prepare()
+ */
+int audio_io_duplex_unprepare(audio_io_duplex_h duplex);
+
+/**
+ * @brief    Gets the size of the periods exchanged by a full-duplex handle
+ *
+ * @param[in]   duplex  The full-duplex handle
+ * @param[out]  size    The size of a period in bytes
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_duplex_get_buffer_size(audio_io_duplex_h duplex, int *size);
+
+/**
+ * @brief    Gets the input and the output of a full-duplex handle
+ *
+ * @details  They may be used for the settings and the statistics of each direction, such as
+ *           audio_in_add_process_stage(), audio_out_set_volume() or audio_in_get_stats().
+ *
+ * @remarks  The handles belong to @a duplex. They must not be prepared, read, written, given a stream callback or destroyed.
+ *
+ * @param[in]   duplex  The full-duplex handle
+ * @param[out]  input   The audio input, or @c NULL if it is not needed
+ * @param[out]  output  The audio output, or @c NULL if it is not needed
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ */
+int audio_io_duplex_get_handles(audio_io_duplex_h duplex, audio_in_h *input, audio_out_h *output);
+
+/**
+ * @}
+*/
+
+/**
+ * @addtogroup CAPI_MEDIA_AUDIO_IN_MODULE
+ * @{
+*/
+
+
+//
+//AUDIO INPUT
+//
+
+
+/**
+ * @brief    Creates an audio device instance and returns an input handle to record PCM (pulse-code modulation) data
+ * @details  This function is used for audio input initialization.
+ *
+ * @remarks @a input must be release audio_in_destroy() by you.\n
+ * The device records 8- or 16-bit samples; other sample types are converted by the library.\n
+ * The device records at most two channels; multichannel input carries them on the front pair.
+ *
+ * @param[in]  sample_rate	The audio sample rate in 1000[Hz] ~ 384000[Hz]. \n
+ *                          Rates outside 8000[Hz] ~ 48000[Hz] are resampled by the library.
+ * @param[in]  channel	The audio channel type, mono, stereo or multichannel
+ * @param[in]  type	The type of audio sample
+ * @param[out] input	An audio input handle will be created, if successful
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
+ * @retval #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ * @see audio_in_destroy()
+ */
+int audio_in_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type , audio_in_h *input);
+
+
+
+/**
+ * @brief    Creates an audio device instance with the period settings of a handle attribute
+ *
+ * @details  Same as audio_in_create(), but the period size, that is the amount read from the device at a time
+ *           and the buffer size of the handle, follows @a attr.
+ *           On return, the period size and count of @a attr are updated to the granted values.
+ *
+ * @remarks  @a input must be released by audio_in_destroy().
+ *
+ * @param[in]      sample_rate  The audio sample rate in 1000Hz ~ 384000Hz
+ * @param[in]      channel      The audio channel type
+ * @param[in]      type         The type of audio sample
+ * @param[in,out]  attr         The handle attribute
+ * @param[out]     input        An audio input handle will be created, if successful
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
+ * @retval #AUDIO_IO_ERROR_SOUND_POLICY Sound policy error
+ * @see audio_in_create()
+*/
+int audio_in_create_ex(int sample_rate, audio_channel_e channel, audio_sample_type_e type, audio_io_attr_h attr, audio_in_h *input);
+
+
+
+/**
+ * @brief    Releases the audio input handle and all its resources associated with an audio stream
+ *
+ * @param[in]	input	The handle to the audio input to destroy
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_DEVICE_NOT_CLOSED Device not closed
+ * @see audio_in_create()
+ */
+int audio_in_destroy(audio_in_h input);
+
+
+
+/**
+ * @brief   Prepare reading audio in by starting buffering the audio data from the device
+ * @param[in]	input	The handle to the audio input
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_in_unprepare()
+ */
+int audio_in_prepare(audio_in_h input);
+
+
+
+/**
+ * @brief    Unprepare reading audio in by stopping buffering the audio data from the device
+ * @remarks  When a device error stopped the stream callback, the error is returned here.
+ * @param[in]	input	The handle to the audio input
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_in_prepare()
+ */
+int audio_in_unprepare(audio_in_h input);
+
+
+
+/**
+ * @brief    Pauses capturing, keeping the prepared state of the handle
+ *
+ * @details  The device stops recording and the position stops advancing. Data already read with
+ *           audio_in_peek() is kept. audio_in_read() is not available while the handle is paused.
+ *
+ * @param[in]	input	The handle to the audio input
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is not prepared or already paused
+ * @see audio_in_resume()
+ */
+int audio_in_pause(audio_in_h input);
+
+
+
+/**
+ * @brief    Resumes capturing after audio_in_pause()
+ * @param[in]	input	The handle to the audio input
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is not paused
+ * @see audio_in_pause()
+ */
+int audio_in_resume(audio_in_h input);
+
+
+
+/**
+ * @brief    Discards the recorded data that has not been read yet
+ *
+ * @details  The data the device holds, the data kept by audio_in_peek() and the conversion state are dropped,
+ *           so that the next read returns freshly recorded data.
+ *           Capture queues nothing toward the device, so there is no draining counterpart.
+ *
+ * @param[in]	input	The handle to the audio input
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle delivers data through a stream callback
+ */
+int audio_in_flush(audio_in_h input);
+
+
+
+/**
+ * @brief   Reads audio data from the audio input buffer
+ *
+ * @param[in]	input	The handle to the audio input
+ * @param[out]	buffer	The PCM buffer address
+ * @param[in]	length	The length of PCM data buffer (in bytes)
+ *
+ * @return  Number of read bytes on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval  #AUDIO_IO_ERROR_INVALID_BUFFER  Invalid buffer pointer
+ * @retval  #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ * @retval  #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation
+ * @pre audio_in_start_recording() 
+ * @remarks  This function is not available while a view obtained by audio_in_peek() has not been dropped.
+*/
+int audio_in_read(audio_in_h input, void *buffer, unsigned int length);
+
+
+
+/**
+ * @brief    Gets the size to be allocated for audio input buffer
+ * @param[in]   input	The handle to the audio input
+ * @param[out]  size	The buffer size (in bytes). \n The maximum size is 1 MB.
+ *
+ * @return  0 on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_NONE Successful
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_in_read()
+*/
+int audio_in_get_buffer_size(audio_in_h input, int *size);
+
+
+
+/**
+ * @brief    Gets the sample rate of the audio input data stream
+ *
+ * @param[in]   input	The handle to the audio input
+ * @param[out]  sample_rate  The audio sample rate in Hertz (1000 ~ 384000)
+ *
+ * @return  0 on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_NONE Successful
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+*/
+int audio_in_get_sample_rate(audio_in_h input, int *sample_rate);
+
+
+
+/**
+ * @brief    Gets the channel type of audio input data stream
+ *
+ * @details  The audio channel type defines whether the audio is mono, stereo or multichannel.
+ *
+ * @param[in]   input   The handle to the audio input
+ * @param[out]  channel The audio channel type
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+*/
+int audio_in_get_channel(audio_in_h input, audio_channel_e *channel);
+
+
+
+/**
+ * @brief    Gets the sample audio format of audio input data stream
+ *
+ * @param[in]  input    The handle to the audio input
+ * @param[out] type     The audio sample type
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+*/
+int audio_in_get_sample_type(audio_in_h input, audio_sample_type_e *type);
+
+
+
+/**
+ * @brief    Registers a callback function to be invoked with each captured period of audio data
+ *
+ * @details  Once a callback is registered, audio_in_prepare() starts a capture thread owned by the library,
+ *           which reads one buffer of audio_in_get_buffer_size() bytes at a time and passes it to @a callback.
+ *           audio_in_unprepare() stops and joins the thread. audio_in_read() is not available in this mode.
+ *
+ * @param[in]  input      The handle to the audio input
+ * @param[in]  callback   The callback function to register
+ * @param[in]  user_data  The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (already prepared)
+ * @pre The audio input must not be prepared.
+ * @see audio_in_unset_stream_cb()
+ * @see audio_in_stream_cb()
+*/
+int audio_in_set_stream_cb(audio_in_h input, audio_in_stream_cb callback, void *user_data);
+
+
+
+/**
+ * @brief    Unregisters the callback function and returns the audio input to blocking audio_in_read() mode
+ *
+ * @param[in]  input    The handle to the audio input
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (already prepared)
+ * @pre The audio input must not be prepared.
+ * @see audio_in_set_stream_cb()
+*/
+int audio_in_unset_stream_cb(audio_in_h input);
+
+
+
+/**
+ * @brief    Gets a read-only view of the next captured period of audio data without copying it
+ *
+ * @details  The data stays in a library-owned buffer until audio_in_drop() is called. Calling this function
+ *           again before audio_in_drop() returns the same view. Blocks until a period has been captured.
+ *
+ * @param[in]   input   The handle to the audio input
+ * @param[out]  data    The captured PCM data, valid until audio_in_drop()
+ * @param[out]  length  The length of captured PCM data (in bytes)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (not prepared or callback mode)
+ * @pre audio_in_prepare()
+ * @see audio_in_drop()
+*/
+int audio_in_peek(audio_in_h input, const void **data, unsigned int *length);
+
+
+
+/**
+ * @brief    Releases the view returned by audio_in_peek() so the next period can be captured
+ *
+ * @param[in]   input   The handle to the audio input
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (no data has been peeked)
+ * @see audio_in_peek()
+*/
+int audio_in_drop(audio_in_h input);
+
+
+
+/**
+ * @brief    Gets the performance statistics of the audio input
+ *
+ * @remarks  The counters are updated with relaxed atomic operations, so a snapshot taken while capturing
+ *           may mix values from consecutive device calls.
+ *
+ * @param[in]   input   The handle to the audio input
+ * @param[out]  stats   The statistics collected since creation or the last audio_in_reset_stats()
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_in_reset_stats()
+*/
+int audio_in_get_stats(audio_in_h input, audio_io_stats_s *stats);
+
+
+
+/**
+ * @brief    Resets the performance statistics of the audio input to zero
+ *
+ * @param[in]   input   The handle to the audio input
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_in_get_stats()
+*/
+int audio_in_reset_stats(audio_in_h input);
+
+
+
+/**
+ * @brief    Gets the number of frames captured by the device since audio_in_prepare()
+ *
+ * @details  The position includes frames still held by the device that have not been read yet,
+ *           extrapolated from the sample clock since the last completed read.
+ *
+ * @param[in]   input      The handle to the audio input
+ * @param[out]  frames     The number of frames captured
+ * @param[out]  timestamp  The @c CLOCK_MONOTONIC time at which @a frames was sampled
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+*/
+int audio_in_get_position(audio_in_h input, unsigned long long *frames, struct timespec *timestamp);
+
+
+
+/**
+ * @brief   Reads audio data from the audio input buffer into one buffer per channel
+ *
+ * @param[in]	input	The handle to the audio input
+ * @param[out]	planes	The array of PCM buffer addresses, one for each channel of the input
+ * @param[in]	length	The length of each PCM buffer (in bytes)
+ *
+ * @return  Number of read bytes per channel on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval  #AUDIO_IO_ERROR_INVALID_BUFFER  Invalid buffer pointer
+ * @retval  #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval  #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ * @retval  #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation
+ * @see audio_in_read()
+*/
+int audio_in_read_planar(audio_in_h input, void **planes, unsigned int length);
+
+
+
+/**
+ * @brief    Sets the quality of the resampler used when the sample rate is outside the device range
+ *
+ * @remarks  This has no effect when the device records at the requested sample rate.
+ *
+ * @param[in]   input    The handle to the audio input
+ * @param[in]   quality  The resampler quality
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (the callback thread is running)
+ * @pre The audio input is not prepared, or no data has been read since audio_in_prepare().
+*/
+int audio_in_set_resampler_quality(audio_in_h input, audio_io_resampler_quality_e quality);
+
+
+
+/**
+ * @brief    Opens idle device streams into the handle cache ahead of audio_in_create()
+ *
+ * @remarks  Streams are opened until @a count are added or the cache is full.
+ *
+ * @param[in]   sample_rate  The audio sample rate in 1000Hz ~ 384000Hz
+ * @param[in]   channel      The audio channel type
+ * @param[in]   type         The type of audio sample
+ * @param[in]   count        The number of streams to open
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (the cache is disabled)
+ * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
+ * @retval #AUDIO_IO_ERROR_SOUND_POLICY Sound policy error
+ * @see audio_io_set_handle_cache()
+*/
+int audio_in_prefill_handle_cache(int sample_rate, audio_channel_e channel, audio_sample_type_e type, unsigned int count);
+
+
+
+/**
+ * @brief    Reads audio data from the device into several buffers
+ *
+ * @details  The buffers are filled in order as one stream. Data is read from the device one buffer size
+ *           (see audio_in_get_buffer_size()) at a time, so many small buffers cost no more device reads
+ *           than one large buffer.
+ *
+ * @param[in]   input   The handle to the audio input
+ * @param[in]   iov     The array of buffers to fill
+ * @param[in]   iovcnt  The number of buffers in @a iov
+ *
+ * @return  The total number of bytes read on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval  #AUDIO_IO_ERROR_INVALID_BUFFER  Invalid buffer pointer
+ * @retval  #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval  #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ * @retval  #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation
+ * @see audio_in_read()
+*/
+int audio_in_readv(audio_in_h input, const struct iovec *iov, int iovcnt);
+
+
+
+/**
+ * @brief    Sets the gain applied to the recorded data
+ *
+ * @details  The gain is applied by the library on the way from the device, with saturation, so the application
+ *           does not need to scale the data itself. The gain moves from its current value to @a gain over @a ramp_ms
+ *           milliseconds, following the shape set by audio_in_set_volume_ramp(), so that changes do not click.
+ *           A new call restarts the ramp from the gain reached so far.
+ *
+ * @param[in]   input    The handle to the audio input
+ * @param[in]   gain     The linear gain in 0.0 ~ 4.0 (default 1.0)
+ * @param[in]   ramp_ms  The ramp duration in 0 ~ 10000 milliseconds, 0 to apply the gain at once
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_in_get_volume()
+*/
+int audio_in_set_volume(audio_in_h input, float gain, unsigned int ramp_ms);
+
+
+
+/**
+ * @brief    Gets the gain set by audio_in_set_volume(), which is the end point of any ramp in progress
+ *
+ * @param[in]   input    The handle to the audio input
+ * @param[out]  gain     The linear gain
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_in_set_volume()
+*/
+int audio_in_get_volume(audio_in_h input, float *gain);
+
+
+
+/**
+ * @brief    Sets the shape of the ramps started by audio_in_set_volume()
+ *
+ * @remarks  An exponential ramp to or from silence runs down to or up from -60 dB.
+ *
+ * @param[in]   input    The handle to the audio input
+ * @param[in]   ramp     The ramp shape (default #AUDIO_IO_VOLUME_RAMP_LINEAR)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_in_set_volume()
+*/
+int audio_in_set_volume_ramp(audio_in_h input, audio_io_volume_ramp_e ramp);
+
+
+
+/**
+ * @brief    Adds a built-in stage at the end of the capture processing chain
+ *
+ * @details  The stages run in the order they were added, in place on the recorded data before it is returned
+ *           by audio_in_read() or passed to the stream callback. They work on 8- and 16-bit device data, before the
+ *           conversion to the format of the handle, and restart from a clean state on audio_in_prepare().
+ *
+ * @remarks  The chain can only be changed while the handle is not capturing. At most 8 stages can be added.
+ *
+ * @param[in]   input    The handle to the audio input
+ * @param[in]   stage    The stage type
+ * @param[in]   param    The stage parameter, see #audio_io_process_stage_e
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is capturing, or the chain is full
+ * @see audio_in_add_custom_process_stage()
+ * @see audio_in_clear_process_stages()
+*/
+int audio_in_add_process_stage(audio_in_h input, audio_io_process_stage_e stage, float param);
+
+
+
+/**
+ * @brief    Adds a stage calling @a callback at the end of the capture processing chain
+ *
+ * @remarks  The chain can only be changed while the handle is not capturing. At most 8 stages can be added.
+ *
+ * @param[in]   input      The handle to the audio input
+ * @param[in]   callback   The processing callback
+ * @param[in]   user_data  The user data passed to @a callback
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is capturing, or the chain is full
+ * @see audio_in_add_process_stage()
+*/
+int audio_in_add_custom_process_stage(audio_in_h input, audio_in_process_cb callback, void *user_data);
+
+
+
+/**
+ * @brief    Removes all the stages of the capture processing chain
+ *
+ * @param[in]   input    The handle to the audio input
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is capturing
+ * @see audio_in_add_process_stage()
+*/
+int audio_in_clear_process_stages(audio_in_h input);
+
+
+
+/**
+ * @brief    Gets the real-time settings the handle was granted
+ *
+ * @param[in]   input    The handle to the audio input
+ * @param[out]  status   The granted settings
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_io_attr_set_thread_policy()
+ * @see audio_io_attr_set_memory_lock()
+*/
+int audio_in_get_realtime_status(audio_in_h input, audio_io_realtime_status_s *status);
+
+/**
+ * @brief    Starts capturing into a file, with a capture thread and a writer thread owned by the library
+ *
+ * @details  The capture thread queues each period in a queue of #AUDIO_IO_RECORDING_QUEUE_MS of audio, and the writer
+ *           thread writes the queue to the file in batches, so that a slow write does not hold up the capture.
+ *           The file holds the data in the sample rate, channel type and sample type of the handle.
+ *           audio_in_pause() and audio_in_resume() pause and resume the recording.
+ *
+ * @remarks  The handle must not be prepared nor have a stream callback. It is prepared by the call and
+ *           stays prepared until audio_in_stop_recording().
+ *
+ * @param[in]  input      The handle to the audio input
+ * @param[in]  path       The file to write, which is replaced if it exists
+ * @param[in]  container  The file format
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is prepared, has a stream callback or is recording
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_PERMISSION_DENIED The file could not be created
+ * @see audio_in_stop_recording()
+ * @see audio_in_get_recording_status()
+*/
+int audio_in_start_recording(audio_in_h input, const char *path, audio_io_container_e container);
+
+/**
+ * @brief    Stops capturing, writes what is queued and closes the file
+ *
+ * @details  The handle is unprepared, and the WAV header gets the final size of the data.
+ *
+ * @param[in]  input  The handle to the audio input
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is not recording, or the file could not be completed
+ * @see audio_in_start_recording()
+*/
+int audio_in_stop_recording(audio_in_h input);
+
+/**
+ * @brief    Gets the progress of the recording of the handle
+ *
+ * @param[in]   input   The handle to the audio input
+ * @param[out]  status  The progress of the recording
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is not recording
+ * @see audio_in_start_recording()
+*/
+int audio_in_get_recording_status(audio_in_h input, audio_io_recording_status_s *status);
+
+/**
+ * @brief    Allocates a buffer of whole periods of the handle
+ *
+ * @details  The buffer is aligned to a cache line, which also suits the SIMD loads of the library, and holds
+ *           @a periods times the size returned by audio_in_get_buffer_size().
+ *
+ * @remarks  @a buffer must be released by audio_io_buffer_free().
+ *
+ * @param[in]   input    The handle to the audio input
+ * @param[in]   periods  The number of periods the buffer holds
+ * @param[out]  buffer   The buffer
+ * @param[out]  size     The size of the buffer in bytes
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @see audio_io_buffer_free()
+*/
+int audio_in_buffer_alloc(audio_in_h input, unsigned int periods, void **buffer, unsigned int *size);
+
+
+
+
+//
+//  AUDIO OUTPUT
+//
+
+/**
+ * @}
+*/
+
+/**
+ * @addtogroup CAPI_MEDIA_AUDIO_OUT_MODULE
+ * @{
+ */
+
+/**
+ * @brief    Creates an audio device instance and returns an output handle to play PCM (pulse-code modulation) data
+ * @details  This function is used for audio output initialization. 
+ * @remarks @a output must be released audio_out_destroy() by you.\n
+ * The device plays 8- or 16-bit samples; other sample types are converted by the library.\n
+ * The device plays at most two channels; multichannel output is downmixed to stereo.
+ *
+ * @param[in]  sample_rate  The audio sample rate in 1000[Hz] ~ 384000[Hz]. \n
+ *                          Rates outside 8000[Hz] ~ 48000[Hz] are resampled by the library.
+ * @param[in]  channel      The audio channel type, mono, stereo or multichannel
+ * @param[in]  type         The type of audio sample
+ * @param[in]  sound_type   The type of sound (#sound_type_e)
+ * @param[out] output       An audio output handle will be created, if successful
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
+ * @retval #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ *
+ * @see audio_out_destroy()
+*/
+int audio_out_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type,  audio_out_h *output);
+
+
+
+/**
+ * @brief    Creates an audio player handle with the period settings of a handle attribute
+ *
+ * @details  Same as audio_out_create(), but the period size, that is the amount written to the device at a time
+ *           and the buffer size of the handle, and the number of periods queued in non-blocking mode follow @a attr.
+ *           On return, the period size and count of @a attr are updated to the granted values.
+ *
+ * @remarks  @a output must be released by audio_out_destroy().
+ *
+ * @param[in]      sample_rate  The audio sample rate in 1000Hz ~ 384000Hz
+ * @param[in]      channel      The audio channel type
+ * @param[in]      type         The type of audio sample
+ * @param[in]      sound_type   The type of sound (#sound_type_e)
+ * @param[in,out]  attr         The handle attribute
+ * @param[out]     output       An audio output handle will be created, if successful
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
+ * @retval #AUDIO_IO_ERROR_SOUND_POLICY Sound policy error
+ * @see audio_out_create()
+*/
+int audio_out_create_ex(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type, audio_io_attr_h attr, audio_out_h *output);
+
+
+
+/**
+ * @brief    Releases the audio output handle, along with all its resources
+ *
+ * @param[in]	output The handle to the audio output to destroy
+ *
+ * @return  0 on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_NONE Successful
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval  #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval  #AUDIO_IO_ERROR_DEVICE_NOT_CLOSED Device not closed
+ *
+ * @see audio_out_create()
+*/
+int audio_out_destroy(audio_out_h output);
+
+/**
+ * @brief   Prepare playing audio out, this must be called before audio_out_write()
+ * @param[in]	input	The handle to the audio output
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_unprepare()
+ */
+int audio_out_prepare(audio_out_h output);
+
+
+
+/**
+ * @brief    Unprepare playing audio out.
+ * @remarks  When a device error stopped the stream callback or the non-blocking queue, the error is returned here.
+ * @param[in]	input	The handle to the audio output
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_prepare()
+ */
+int audio_out_unprepare(audio_out_h output);
+
+
+
+/**
+ * @brief    Pauses playback, keeping the prepared state of the handle
+ *
+ * @details  The device stops and the position holds at the last frame played. In non-blocking mode the queued
+ *           data is kept and audio_out_write() still queues; otherwise audio_out_write() is not available
+ *           while the handle is paused. The stream callback is not called while the handle is paused.
+ *
+ * @param[in]	output	The handle to the audio output
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is not prepared or already paused
+ * @see audio_out_resume()
+ */
+int audio_out_pause(audio_out_h output);
+
+
+
+/**
+ * @brief    Resumes playback after audio_out_pause()
+ * @param[in]	output	The handle to the audio output
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is not paused
+ * @see audio_out_pause()
+ */
+int audio_out_resume(audio_out_h output);
+
+
+
+/**
+ * @brief    Blocks until all the written data has been played
+ *
+ * @details  The input the resampler still holds is pushed out with trailing silence, then the call waits for the
+ *           queued data and the device buffer to empty.
+ *
+ * @param[in]	output	The handle to the audio output
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is not playing, or plays from a stream callback
+ * @see audio_out_flush()
+ */
+int audio_out_drain(audio_out_h output);
+
+
+
+/**
+ * @brief    Discards the written data that has not been played yet
+ *
+ * @details  The queued data, the data the device holds and the conversion state are dropped. The position holds at
+ *           the last frame played. A paused handle stays paused.
+ *
+ * @param[in]	output	The handle to the audio output
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle plays from a stream callback
+ * @see audio_out_drain()
+ */
+int audio_out_flush(audio_out_h output);
+
+
+
+
+/**
+ * @brief    Starts writing the audio data to the device
+ *
+ * @param[in]       output  The handle to the audio output
+ * @param[in,out]   buffer  The PCM buffer address
+ * @param[in]       length  The length of PCM buffer (in bytes)
+ *
+ * @remarks  In non-blocking mode the returned size may be smaller than @a length when the queue is nearly full.
+ *
+ * @return  Written data size on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval  #AUDIO_IO_ERROR_INVALID_BUFFER  Invalid buffer pointer
+ * @retval  #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ * @retval  #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (in non-blocking mode, the queue is full)
+ * @see audio_out_set_nonblocking()
+*/
+int audio_out_write(audio_out_h output, void *buffer, unsigned int length);
+
+
+
+/**
+ * @brief    Gets the size to be allocated for audio output buffer
+ * @param[in]     output  The handle to the audio output
+ * @param[out]    size    The suggested buffer size (in bytes). \n The maximum size is 1 MB.
+ *
+ * @return  0 on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_NONE Successful
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_write()
+ *
+*/
+int audio_out_get_buffer_size(audio_out_h output, int *size);
+
+
+
+/**
+ * @brief    Gets the sample rate of audio output data stream
+ *
+ * @param[in]   output       The handle to the audio output
+ * @param[out]  sample_rate  The audio sample rate in Hertz (1000 ~ 384000)
+ *
+ * @return  0 on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_NONE Successful
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+*/
+int audio_out_get_sample_rate(audio_out_h output, int *sample_rate);
+
+
+
+/**
+ * @brief    Gets the channel type of audio output data stream
+ *
+ * @details  The audio channel type defines whether the audio is mono, stereo or multichannel.
+ *
+ * @param[in]   output  The handle to the audio output
+ * @param[out]  channel The audio channel type
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+*/
+int audio_out_get_channel(audio_out_h output, audio_channel_e *channel);
+
+
 
 /**
- * @}
+ * @brief    Gets the sample audio format of audio output data stream
+ *
+ * @param[in]   output  The handle to the audio output
+ * @param[out]  type    The audio sample type
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
 */
+int audio_out_get_sample_type(audio_out_h output, audio_sample_type_e *type);
+
+
 
 /**
- * @addtogroup CAPI_MEDIA_AUDIO_IN_MODULE
- * @{
+ * @brief    Gets the sound type supported by the audio output device
+ * @param[in]  output   The handle to the audio output
+ * @param[out] type     The sound type
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
 */
+int audio_out_get_sound_type(audio_out_h output, sound_type_e *type);
 
 
-//
-//AUDIO INPUT
-//
-
 
 /**
- * @brief    Creates an audio device instance and returns an input handle to record PCM (pulse-code modulation) data
- * @details  This function is used for audio input initialization.
+ * @brief    Registers a callback function to be invoked whenever the audio output device needs more data
  *
- * @remarks @a input must be release audio_in_destroy() by you.
+ * @details  Once a callback is registered, audio_out_prepare() starts a render thread owned by the library,
+ *           which asks @a callback for exactly audio_out_get_buffer_size() bytes at a time and writes them to the device.
+ *           audio_out_unprepare() stops and joins the thread. audio_out_write() is not available in this mode.
  *
- * @param[in]  sample_rate	The audio sample rate in 8000[Hz] ~ 48000[Hz]
- * @param[in]  channel	The audio channel type, mono, or stereo
- * @param[in]  type	The type of audio sample (8- or 16-bit)
- * @param[out] input	An audio input handle will be created, if successful
+ * @param[in]  output     The handle to the audio output
+ * @param[in]  callback   The callback function to register
+ * @param[in]  user_data  The user data to be passed to the callback function
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
- * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
- * @retval #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
- * @see audio_in_destroy()
- */
-int audio_in_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type , audio_in_h *input);
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (already prepared)
+ * @pre The audio output must not be prepared.
+ * @see audio_out_unset_stream_cb()
+ * @see audio_out_stream_cb()
+*/
+int audio_out_set_stream_cb(audio_out_h output, audio_out_stream_cb callback, void *user_data);
 
 
 
 /**
- * @brief    Releases the audio input handle and all its resources associated with an audio stream
+ * @brief    Unregisters the callback function and returns the audio output to audio_out_write() mode
  *
- * @param[in]	input	The handle to the audio input to destroy
+ * @param[in]  output   The handle to the audio output
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @retval #AUDIO_IO_ERROR_DEVICE_NOT_CLOSED Device not closed
- * @see audio_in_create()
- */
-int audio_in_destroy(audio_in_h input);
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (already prepared)
+ * @pre The audio output must not be prepared.
+ * @see audio_out_set_stream_cb()
+*/
+int audio_out_unset_stream_cb(audio_out_h output);
 
 
 
 /**
- * @brief   Prepare reading audio in by starting buffering the audio data from the device
- * @param[in]	input	The handle to the audio input
+ * @brief    Enables or disables non-blocking write mode
+ *
+ * @details  In non-blocking mode audio_out_write() copies the data into a library-owned queue of
+ *           several device periods and returns immediately; a library-owned drain thread started by
+ *           audio_out_prepare() feeds the queue to the device. Data written before audio_out_prepare()
+ *           is kept and played first. audio_out_unprepare() discards any queued data.
+ *           A paused output may change mode, which applies from audio_out_resume(); leaving non-blocking
+ *           mode then discards the queued data.
+ *           A device error stops the drain thread; the next write, audio_out_get_writable_size() and
+ *           audio_out_unprepare() then return that error rather than a full queue, until the output starts again.
+ *
+ * @param[in]  output       The handle to the audio output
+ * @param[in]  nonblocking  @c true to enable non-blocking mode, @c false to return to blocking mode
+ *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @see audio_in_unprepare()
- */
-int audio_in_prepare(audio_in_h input);
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (prepared and not paused, or callback mode)
+ * @pre The audio output must not be prepared, or must be paused, and no stream callback may be registered.
+ * @see audio_out_get_writable_size()
+*/
+int audio_out_set_nonblocking(audio_out_h output, bool nonblocking);
 
 
 
 /**
- * @brief    Unprepare reading audio in by stopping buffering the audio data from the device
- * @param[in]	input	The handle to the audio input
+ * @brief    Gets the number of bytes audio_out_write() can currently accept without blocking
+ *
+ * @param[in]   output  The handle to the audio output
+ * @param[out]  size    The free space of the non-blocking queue (in bytes)
+ *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @see audio_in_prepare()
- */
-int audio_in_unprepare(audio_in_h input);
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (not in non-blocking mode)
+ * @see audio_out_set_nonblocking()
+*/
+int audio_out_get_writable_size(audio_out_h output, unsigned int *size);
 
 
 
 /**
- * @brief   Reads audio data from the audio input buffer
+ * @brief    Acquires a library-owned buffer that the application can render PCM data into directly
  *
- * @param[in]	input	The handle to the audio input
- * @param[out]	buffer	The PCM buffer address
- * @param[in]	length	The length of PCM data buffer (in bytes)
+ * @details  The buffer is audio_out_get_buffer_size() bytes long and aligned for SIMD stores. It is handed to the
+ *           device by audio_out_commit_buffer(), avoiding the intermediate copy of audio_out_write(). Acquiring again
+ *           before committing returns the same buffer.
+ *           In non-blocking mode @a length is at most audio_out_get_writable_size(), so that the queue takes the whole
+ *           commit; the call fails with #AUDIO_IO_ERROR_INVALID_OPERATION while the queue is full.
  *
- * @return  Number of read bytes on success, otherwise a negative error value.
- * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @retval  #AUDIO_IO_ERROR_INVALID_BUFFER  Invalid buffer pointer
- * @retval  #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
- * @retval  #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation
- * @pre audio_in_start_recording() 
+ * @param[in]   output  The handle to the audio output
+ * @param[out]  buffer  The buffer to render into, valid until audio_out_commit_buffer()
+ * @param[out]  length  The size of @a buffer (in bytes)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (callback mode, or the non-blocking queue is full)
+ * @see audio_out_commit_buffer()
 */
-int audio_in_read(audio_in_h input, void *buffer, unsigned int length);
+int audio_out_acquire_buffer(audio_out_h output, void **buffer, unsigned int *length);
 
 
 
 /**
- * @brief    Gets the size to be allocated for audio input buffer
- * @param[in]   input	The handle to the audio input
- * @param[out]  size	The buffer size (in bytes). \n The maximum size is 1 MB.
+ * @brief    Writes the first @a length bytes of the acquired buffer to the device and releases it
  *
- * @return  0 on success, otherwise a negative error value.
- * @retval  #AUDIO_IO_ERROR_NONE Successful
+ * @remarks  In non-blocking mode the commit is queued whole, as @a length cannot exceed what audio_out_acquire_buffer()
+ *           returned.
+ *
+ * @param[in]   output  The handle to the audio output
+ * @param[in]   length  The number of valid bytes in the acquired buffer, at most the length it was acquired with
+ *
+ * @return  Written data size on success, otherwise a negative error value (see audio_out_write()).
  * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @see audio_in_read()
+ * @retval  #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (no buffer has been acquired)
+ * @retval  #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ * @pre audio_out_acquire_buffer()
+ * @see audio_out_acquire_buffer()
 */
-int audio_in_get_buffer_size(audio_in_h input, int *size);
+int audio_out_commit_buffer(audio_out_h output, unsigned int length);
 
 
 
 /**
- * @brief    Gets the sample rate of the audio input data stream
+ * @brief    Gets the performance statistics of the audio output
  *
- * @param[in]   input	The handle to the audio input
- * @param[out]  sample_rate  The audio sample rate in Hertz (8000 ~ 48000)
+ * @remarks  The counters are updated with relaxed atomic operations, so a snapshot taken while playing
+ *           may mix values from consecutive device calls.
  *
- * @return  0 on success, otherwise a negative error value.
- * @retval  #AUDIO_IO_ERROR_NONE Successful
- * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @param[in]   output  The handle to the audio output
+ * @param[out]  stats   The statistics collected since creation or the last audio_out_reset_stats()
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_reset_stats()
 */
-int audio_in_get_sample_rate(audio_in_h input, int *sample_rate);
+int audio_out_get_stats(audio_out_h output, audio_io_stats_s *stats);
 
 
 
 /**
- * @brief    Gets the channel type of audio input data stream
+ * @brief    Resets the performance statistics of the audio output to zero
  *
- * @details  The audio channel type defines whether the audio is mono or stereo.
- *
- * @param[in]   input   The handle to the audio input
- * @param[out]  channel The audio channel type
+ * @param[in]   output  The handle to the audio output
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_get_stats()
 */
-int audio_in_get_channel(audio_in_h input, audio_channel_e *channel);
+int audio_out_reset_stats(audio_out_h output);
 
 
 
 /**
- * @brief    Gets the sample audio format (8-bit or 16-bit) of audio input data stream
+ * @brief    Gets the time it takes for audio written now to be played
  *
- * @param[in]  input    The handle to the audio input
- * @param[out] type     The audio sample type
+ * @details  The latency covers the data queued in the device and, in non-blocking mode, the data
+ *           waiting in the library queue.
+ *
+ * @param[in]   output      The handle to the audio output
+ * @param[out]  latency_us  The latency (in microseconds)
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_get_position()
 */
-int audio_in_get_sample_type(audio_in_h input, audio_sample_type_e *type);
+int audio_out_get_latency(audio_out_h output, unsigned int *latency_us);
 
 
 
+/**
+ * @brief    Gets the number of frames played by the device since audio_out_prepare()
+ *
+ * @details  The position is extrapolated from the sample clock since the last completed device write
+ *           and never goes backwards until the next audio_out_prepare().
+ *
+ * @param[in]   output     The handle to the audio output
+ * @param[out]  frames     The number of frames played
+ * @param[out]  timestamp  The @c CLOCK_MONOTONIC time at which @a frames was sampled
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_get_latency()
+*/
+int audio_out_get_position(audio_out_h output, unsigned long long *frames, struct timespec *timestamp);
+
 
-//
-//  AUDIO OUTPUT
-//
 
 /**
- * @}
+ * @brief    Writes audio data held in one buffer per channel to the device
+ *
+ * @param[in]   output  The handle to the audio output
+ * @param[in]   planes  The array of PCM buffer addresses, one for each channel of the output
+ * @param[in]   length  The length of each PCM buffer (in bytes)
+ *
+ * @return  Written data size per channel on success, otherwise a negative error value.
+ * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval  #AUDIO_IO_ERROR_INVALID_BUFFER  Invalid buffer pointer
+ * @retval  #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval  #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ * @retval  #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (in non-blocking mode, the queue is full)
+ * @see audio_out_write()
 */
+int audio_out_write_planar(audio_out_h output, void **planes, unsigned int length);
+
 
-/**
- * @addtogroup CAPI_MEDIA_AUDIO_OUT_MODULE
- * @{
- */
 
 /**
- * @brief    Creates an audio device instance and returns an output handle to play PCM (pulse-code modulation) data
- * @details  This function is used for audio output initialization. 
- * @remarks @a output must be released audio_out_destroy() by you.
+ * @brief    Sets the quality of the resampler used when the sample rate is outside the device range
  *
- * @param[in]  sample_rate  The audio sample rate in 8000[Hz] ~ 48000[Hz]
- * @param[in]  channel      The audio channel type, mono, or stereo
- * @param[in]  type         The type of audio sample (8- or 16-bit)
- * @param[in]  sound_type   The type of sound (#sound_type_e)
- * @param[out] output       An audio output handle will be created, if successful
+ * @remarks  This has no effect when the device plays at the requested sample rate.
+ *
+ * @param[in]   output   The handle to the audio output
+ * @param[in]   quality  The resampler quality
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
  * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
- * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
- * @retval #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
- *
- * @see audio_out_destroy()
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (the callback or non-blocking thread is running)
+ * @pre The audio output is not prepared, or no data has been written since audio_out_prepare().
 */
-int audio_out_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type,  audio_out_h *output);
+int audio_out_set_resampler_quality(audio_out_h output, audio_io_resampler_quality_e quality);
 
 
 
 /**
- * @brief    Releases the audio output handle, along with all its resources
+ * @brief    Creates an audio output handle that plays through the shared software mixer
  *
- * @param[in]	output The handle to the audio output to destroy
+ * @details  All mixed handles of the same @a sound_type share one device stream (S16_LE stereo at 48000 Hz).
+ *           Each handle is converted to that format, scaled by its mix gain and summed with the others
+ *           with saturation, so that many outputs cost a single device stream.
  *
- * @return  0 on success, otherwise a negative error value.
- * @retval  #AUDIO_IO_ERROR_NONE Successful
- * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @retval  #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
- * @retval  #AUDIO_IO_ERROR_DEVICE_NOT_CLOSED Device not closed
+ * @remarks  @a output must be released by audio_out_destroy().
+ *           Prepared handles that have not queued enough data play silence instead of stalling the others.
  *
+ * @param[in]    sample_rate  The audio sample rate in 1000Hz ~ 384000Hz
+ * @param[in]    channel      The audio channel type
+ * @param[in]    type         The type of audio sample
+ * @param[in]    sound_type   The type of sound (#sound_type_e)
+ * @param[out]   output       An audio output handle will be created, if successful
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
  * @see audio_out_create()
+ * @see audio_out_set_mix_gain()
 */
-int audio_out_destroy(audio_out_h output);
+int audio_out_create_mixed(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type, audio_out_h *output);
+
+
 
 /**
- * @brief   Prepare playing audio out, this must be called before audio_out_write()
- * @param[in]	input	The handle to the audio output
+ * @brief    Sets the gain applied to a mixed audio output before it is summed with the others
+ *
+ * @remarks  The gain is applied with a precision of 1/16384 and takes effect from the next mixer period.
+ *
+ * @param[in]   output   The handle to the audio output created by audio_out_create_mixed()
+ * @param[in]   gain     The gain in 0.0 ~ 1.0 (default 1.0)
+ *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @see audio_out_unprepare()
- */
-int audio_out_prepare(audio_out_h output);
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (the handle is not mixed)
+ * @see audio_out_create_mixed()
+*/
+int audio_out_set_mix_gain(audio_out_h output, float gain);
 
 
 
 /**
- * @brief    Unprepare playing audio out.
- * @param[in]	input	The handle to the audio output
+ * @brief    Opens idle device streams into the handle cache ahead of audio_out_create()
+ *
+ * @remarks  Streams are opened until @a count are added or the cache is full.
+ *           Mixed handles do not use the cache.
+ *
+ * @param[in]   sample_rate  The audio sample rate in 1000Hz ~ 384000Hz
+ * @param[in]   channel      The audio channel type
+ * @param[in]   type         The type of audio sample
+ * @param[in]   sound_type   The type of sound (#sound_type_e)
+ * @param[in]   count        The number of streams to open
+ *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @see audio_out_prepare()
- */
-int audio_out_unprepare(audio_out_h output);
-
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (the cache is disabled)
+ * @retval #AUDIO_IO_ERROR_DEVICE_NOT_OPENED Device not opened
+ * @retval #AUDIO_IO_ERROR_SOUND_POLICY Sound policy error
+ * @see audio_io_set_handle_cache()
+*/
+int audio_out_prefill_handle_cache(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type, unsigned int count);
 
 
 
 /**
- * @brief    Starts writing the audio data to the device
+ * @brief    Writes audio data from several buffers to the device
  *
- * @param[in]       output  The handle to the audio output
- * @param[in,out]   buffer  The PCM buffer address
- * @param[in]       length  The length of PCM buffer (in bytes)
+ * @details  The buffers are played in order as one stream. Small buffers are gathered and written to the
+ *           device one buffer size (see audio_out_get_buffer_size()) at a time, so many small packets cost no
+ *           more device writes than one large buffer.
  *
- * @return  Written data size on success, otherwise a negative error value.
+ * @remarks  A frame may span two buffers. A trailing partial frame is dropped.
+ *           In non-blocking mode the returned size may be smaller than the total length when the queue is nearly full.
+ *
+ * @param[in]   output  The handle to the audio output
+ * @param[in]   iov     The array of buffers to write
+ * @param[in]   iovcnt  The number of buffers in @a iov
+ *
+ * @return  The total number of bytes written on success, otherwise a negative error value.
  * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
  * @retval  #AUDIO_IO_ERROR_INVALID_BUFFER  Invalid buffer pointer
+ * @retval  #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
  * @retval  #AUDIO_IO_ERROR_SOUND_POLICY    Sound policy error
+ * @retval  #AUDIO_IO_ERROR_INVALID_OPERATION Invalid operation (in non-blocking mode, the queue is full)
+ * @see audio_out_write()
 */
-int audio_out_write(audio_out_h output, void *buffer, unsigned int length);
+int audio_out_writev(audio_out_h output, const struct iovec *iov, int iovcnt);
 
 
 
 /**
- * @brief    Gets the size to be allocated for audio output buffer
- * @param[in]     output  The handle to the audio output
- * @param[out]    size    The suggested buffer size (in bytes). \n The maximum size is 1 MB.
+ * @brief    Sets the gain applied to the played data
  *
- * @return  0 on success, otherwise a negative error value.
- * @retval  #AUDIO_IO_ERROR_NONE Successful
- * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
- * @see audio_out_write()
+ * @details  The gain is applied by the library on the way to the device, with saturation, so the application
+ *           does not need to scale the data itself. The gain moves from its current value to @a gain over @a ramp_ms
+ *           milliseconds, following the shape set by audio_out_set_volume_ramp(), so that changes do not click.
+ *           A new call restarts the ramp from the gain reached so far.
+ *
+ * @param[in]   output   The handle to the audio output
+ * @param[in]   gain     The linear gain in 0.0 ~ 4.0 (default 1.0)
+ * @param[in]   ramp_ms  The ramp duration in 0 ~ 10000 milliseconds, 0 to apply the gain at once
  *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_get_volume()
 */
-int audio_out_get_buffer_size(audio_out_h output, int *size);
+int audio_out_set_volume(audio_out_h output, float gain, unsigned int ramp_ms);
 
 
 
 /**
- * @brief    Gets the sample rate of audio output data stream
+ * @brief    Gets the gain set by audio_out_set_volume(), which is the end point of any ramp in progress
  *
- * @param[in]   output       The handle to the audio output
- * @param[out]  sample_rate  The audio sample rate in Hertz (8000 ~ 48000)
+ * @param[in]   output   The handle to the audio output
+ * @param[out]  gain     The linear gain
  *
- * @return  0 on success, otherwise a negative error value.
- * @retval  #AUDIO_IO_ERROR_NONE Successful
- * @retval  #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_set_volume()
 */
-int audio_out_get_sample_rate(audio_out_h output, int *sample_rate);
+int audio_out_get_volume(audio_out_h output, float *gain);
 
 
 
 /**
- * @brief    Gets the channel type of audio output data stream
+ * @brief    Sets the shape of the ramps started by audio_out_set_volume()
  *
- * @details  The audio channel type defines whether the audio is mono or stereo.
+ * @remarks  An exponential ramp to or from silence runs down to or up from -60 dB.
  *
- * @param[in]   output  The handle to the audio output
- * @param[out]  channel The audio channel type
+ * @param[in]   output   The handle to the audio output
+ * @param[in]   ramp     The ramp shape (default #AUDIO_IO_VOLUME_RAMP_LINEAR)
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_out_set_volume()
 */
-int audio_out_get_channel(audio_out_h output, audio_channel_e *channel);
+int audio_out_set_volume_ramp(audio_out_h output, audio_io_volume_ramp_e ramp);
 
 
 
 /**
- * @brief    Gets the sample audio format (8-bit or 16-bit) of audio output data stream
+ * @brief    Gets the real-time settings the handle was granted
+ *
+ * @param[in]   output   The handle to the audio output
+ * @param[out]  status   The granted settings
  *
- * @param[in]   output  The handle to the audio output
- * @param[out]  type    The audio sample type
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @see audio_io_attr_set_thread_policy()
+ * @see audio_io_attr_set_memory_lock()
 */
-int audio_out_get_sample_type(audio_out_h output, audio_sample_type_e *type);
+int audio_out_get_realtime_status(audio_out_h output, audio_io_realtime_status_s *status);
 
+/**
+ * @brief    Allocates a buffer of whole periods of the handle
+ *
+ * @details  The buffer is aligned to a cache line, which also suits the SIMD loads of the library, and holds
+ *           @a periods times the size returned by audio_out_get_buffer_size().
+ *
+ * @remarks  @a buffer must be released by audio_io_buffer_free().
+ *
+ * @param[in]   output   The handle to the audio output
+ * @param[in]   periods  The number of periods the buffer holds
+ * @param[out]  buffer   The buffer
+ * @param[out]  size     The size of the buffer in bytes
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @see audio_io_buffer_free()
+*/
+int audio_out_buffer_alloc(audio_out_h output, unsigned int periods, void **buffer, unsigned int *size);
 
+/**
+ * @brief    Plays a WAV or raw PCM file from a playback thread owned by the library
+ *
+ * @details  The file is mapped in memory rather than read, and its pages are written to the device where no conversion
+ *           is needed, so the playback uses no heap for the file data and starts without reading it whole. The kernel
+ *           is asked to read ahead of the playback and to drop the pages already played.
+ *           A WAV file must hold PCM or IEEE float data in the sample rate, channel type and sample type of the handle;
+ *           a raw file is taken to hold the samples alone in that format.
+ *           audio_out_pause() and audio_out_resume() pause and resume the playback.
+ *
+ * @remarks  The handle must not be prepared, be non-blocking nor have a stream callback. It is prepared by the call and
+ *           stays prepared until audio_out_stop_file(), also after the end of the file.
+ *
+ * @param[in]  output     The handle to the audio output
+ * @param[in]  path       The file to play
+ * @param[in]  container  The file format
+ * @param[in]  callback   The callback invoked when the playback ends, or @c NULL
+ * @param[in]  user_data  The user data to be passed to the callback
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #AUDIO_IO_ERROR_NONE Successful
+ * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter, or the file does not hold data in the format of the handle
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is prepared, is non-blocking, has a stream callback or is playing a file
+ * @retval #AUDIO_IO_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #AUDIO_IO_ERROR_PERMISSION_DENIED The file could not be opened
+ * @see audio_out_stop_file()
+*/
+int audio_out_play_file(audio_out_h output, const char *path, audio_io_container_e container, audio_out_playback_cb callback, void *user_data);
 
 /**
- * @brief    Gets the sound type supported by the audio output device
- * @param[in]  output   The handle to the audio output
- * @param[out] type     The sound type
+ * @brief    Stops the playback of a file, unprepares the handle and releases the file
+ *
+ * @param[in]  output  The handle to the audio output
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #AUDIO_IO_ERROR_NONE Successful
  * @retval #AUDIO_IO_ERROR_INVALID_PARAMETER Invalid parameter
+ * @retval #AUDIO_IO_ERROR_INVALID_OPERATION The handle is not playing a file
+ * @see audio_out_play_file()
 */
-int audio_out_get_sound_type(audio_out_h output, sound_type_e *type);
+int audio_out_stop_file(audio_out_h output);
+
 
 
 
@@ -19,28 +19,529 @@
 #include <audio_io.h>
 #include <sound_manager.h>
 #include <mm_sound.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <dlog.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_AUDIO_IO"
+
+/*
+* Internal Macros
+*/
+#define AUDIO_IO_CHECK_CONDITION(condition,error,msg)	\
+		if(condition) {} else \
+		{ LOGE("[%s] %s(0x%08x)",__FUNCTION__, msg,error); return error;}; \
+
+#define AUDIO_IO_NULL_ARG_CHECK(arg)	\
+	AUDIO_IO_CHECK_CONDITION(arg != NULL, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER" )
+
+/*
+* Logging policy : errors are always logged through LOGE. Warning, info and debug messages are
+* compiled out above AUDIO_IO_LOG_MAX_LEVEL and filtered at run time by audio_io_set_log_level()
+* or the AUDIO_IO_LOG_LEVEL environment variable. Per-call I/O messages use the rate limited variant.
+*/
+#ifndef AUDIO_IO_LOG_MAX_LEVEL
+#define AUDIO_IO_LOG_MAX_LEVEL		AUDIO_IO_LOG_LEVEL_DEBUG
+#endif
+
+#define AUDIO_IO_LOG_RATELIMIT_US	1000000ULL
+
+extern int _audio_io_log_level;
+
+#define AUDIO_IO_LOG_ENABLED(level)	\
+	((level) <= AUDIO_IO_LOG_MAX_LEVEL && (level) <= __atomic_load_n(&_audio_io_log_level, __ATOMIC_RELAXED))
+
+#define AUDIO_IO_LOGW(fmt, arg...)	\
+	do { if (AUDIO_IO_LOG_ENABLED(AUDIO_IO_LOG_LEVEL_WARNING)) LOGW(fmt, ##arg); } while (0)
+
+#define AUDIO_IO_LOGI(fmt, arg...)	\
+	do { if (AUDIO_IO_LOG_ENABLED(AUDIO_IO_LOG_LEVEL_INFO)) LOGI(fmt, ##arg); } while (0)
+
+#define AUDIO_IO_LOGD(fmt, arg...)	\
+	do { if (AUDIO_IO_LOG_ENABLED(AUDIO_IO_LOG_LEVEL_DEBUG)) LOGD(fmt, ##arg); } while (0)
+
+#define AUDIO_IO_LOGI_RATELIMITED(fmt, arg...)	\
+	do { \
+		static unsigned long long __log_last_us; \
+		static unsigned int __log_suppressed; \
+		unsigned int __log_reported; \
+		if (AUDIO_IO_LOG_ENABLED(AUDIO_IO_LOG_LEVEL_INFO) && \
+			_audio_io_log_ratelimit(&__log_last_us, &__log_suppressed, &__log_reported)) \
+			LOGI(fmt " (%u similar messages suppressed)", ##arg, __log_reported); \
+	} while (0)
+
+#define AUDIO_IO_CACHE_LINE_SIZE	64
+
+/* number of device periods buffered by the non-blocking playback ring */
+#define AUDIO_IO_RING_PERIODS		4
+
+/* period limits and latency class targets of audio_*_create_ex() */
+#define AUDIO_IO_MIN_PERIOD_FRAMES	32
+#define AUDIO_IO_MIN_PERIOD_COUNT	2
+#define AUDIO_IO_MAX_PERIOD_COUNT	16
+#define AUDIO_IO_LOW_LATENCY_PERIOD_MS	5
+#define AUDIO_IO_POWER_SAVING_PERIOD_MS	100
+
+#define AUDIO_IO_MAX_CHANNELS		8
+
+/* shared mixer stream format and limits */
+#define AUDIO_IO_MIXER_RATE		48000
+#define AUDIO_IO_MIXER_MAX_VOICES	256
+#define AUDIO_IO_MIX_GAIN_SHIFT		14
+#define AUDIO_IO_MIX_GAIN_UNITY		(1 << AUDIO_IO_MIX_GAIN_SHIFT)
+
+/* rates accepted from the application; rates mm-sound does not take are resampled */
+#define AUDIO_IO_MIN_SAMPLE_RATE	1000
+#define AUDIO_IO_MAX_SAMPLE_RATE	384000
+
+/* capture processing chain limits; custom stages share the stage type space with the built-in ones */
+#define AUDIO_IO_MAX_PROCESS_STAGES	8
+#define AUDIO_IO_PROCESS_STAGE_CUSTOM	(AUDIO_IO_PROCESS_STAGE_NOISE_GATE + 1)
+
+/* limits of audio_*_set_volume() */
+#define AUDIO_IO_MAX_VOLUME		4.0f
+#define AUDIO_IO_MAX_VOLUME_RAMP_MS	10000
+
+#define AUDIO_IO_MIN_DEVICE_RATE	8000
+#define AUDIO_IO_MAX_DEVICE_RATE	48000
+
+/* device buffer of the backends other than mm-sound */
+#define AUDIO_IO_BACKEND_PERIOD_MS	20
+
+#define AUDIO_IO_MAX_LOCKED_REGIONS	24
+
+/* buffer pool size classes are powers of two from 1 KB to 256 KB, larger buffers are not pooled */
+#define AUDIO_IO_POOL_MIN_SHIFT		10
+#define AUDIO_IO_POOL_CLASSES		9
+#define AUDIO_IO_POOL_MAX_FREE		8	/* released buffers kept per size class */
+
+/* canonical header of the WAV files the library writes */
+#define AUDIO_IO_WAV_HEADER_SIZE	44
+
+/* amount of queued data the recording writer thread waits for before writing */
+#define AUDIO_IO_RECORDING_BATCH_SIZE	(64 * 1024)
+#define AUDIO_IO_PLAYBACK_READAHEAD	(256 * 1024)	/* bytes of a played file the kernel is asked to read ahead */
+
+/* handle slots of an arena chunk */
+#define AUDIO_IO_ARENA_SLOTS		16
+
+typedef enum {
+	AUDIO_IO_DIRECTION_IN,
+	AUDIO_IO_DIRECTION_OUT,
+} audio_io_direction_e;
+
+typedef struct _audio_io_thread_policy_s{
+	bool is_set;			/* false to follow audio_io_set_thread_policy() */
+	audio_io_thread_policy_e policy;
+	int priority;
+	unsigned long long cpu_mask;
+} audio_io_thread_policy_s;
+
+/* memory regions of a handle locked while it is prepared */
+typedef struct _audio_io_memlock_s{
+	bool requested;
+	bool active;
+	bool failed;
+	int count;
+	void *addr[AUDIO_IO_MAX_LOCKED_REGIONS];
+	size_t length[AUDIO_IO_MAX_LOCKED_REGIONS];
+} audio_io_memlock_s;
+
+typedef struct audio_io_attr_s{
+	unsigned int period_size;	/* application frames, 0 for the latency class default */
+	unsigned int period_count;	/* 0 for the latency class default */
+	audio_io_latency_class_e latency_class;
+	audio_io_backend_e backend;
+	char *backend_path;		/* NULL for the environment default */
+	audio_io_thread_policy_s thread_policy;
+	bool memory_lock;
+} audio_io_attr_s;
+
+/*
+* Device backend : every call returns an mm-sound error code, and open returns the device buffer size
+* on success, so that the callers handle all backends like mm-sound. @path is the file or loopback name
+* of the backends that use one. Only cacheable streams go to the handle cache.
+*/
+typedef struct _audio_io_backend_s{
+	const char *name;
+	bool cacheable;
+	int (*open)(void **stream, audio_io_direction_e direction, int rate, audio_channel_e channel, audio_sample_type_e type,
+			sound_type_e sound_type, const char *path);
+	int (*start)(void *stream, audio_io_direction_e direction);
+	int (*stop)(void *stream, audio_io_direction_e direction);
+	int (*read)(void *stream, void *buffer, unsigned int length);
+	int (*write)(void *stream, void *buffer, unsigned int length);
+	int (*close)(void *stream, audio_io_direction_e direction);
+} audio_io_backend_s;
+
+typedef struct _audio_io_ring_s{
+	unsigned char *buffer;
+	unsigned int size;
+	unsigned int mask;
+	unsigned int limit;
+	unsigned int head __attribute__((aligned(AUDIO_IO_CACHE_LINE_SIZE)));
+	unsigned int tail __attribute__((aligned(AUDIO_IO_CACHE_LINE_SIZE)));
+} audio_io_ring_s;
+
+typedef struct _audio_io_stats_counters_s{
+	unsigned long long total_bytes;
+	unsigned long long call_count;
+	unsigned long long blocked_time_us;
+	unsigned long long short_count;
+	unsigned long long xrun_count;
+	unsigned long long latency_histogram[AUDIO_IO_STATS_LATENCY_BUCKETS];
+	unsigned long long last_end_us;
+	unsigned long long period_us;
+} audio_io_stats_counters_s;
+
+typedef struct _audio_io_position_s{
+	unsigned long long frames;
+	unsigned long long timestamp_us;
+	unsigned long long reported;
+} audio_io_position_s;
+
+typedef struct _audio_io_resampler_s{
+	int channels;
+	unsigned int up;
+	unsigned int down;
+	unsigned int phases;
+	unsigned int taps;
+	unsigned int max_in_frames;
+	float *filter;
+	float *history[AUDIO_IO_MAX_CHANNELS];
+	unsigned int fill;
+	unsigned long long pos;
+} audio_io_resampler_s;
+
+typedef struct _audio_io_converter_s{
+	audio_sample_type_e src_type;
+	int src_channels;
+	audio_sample_type_e dst_type;
+	int dst_channels;
+	unsigned int max_frames;
+	float matrix[AUDIO_IO_MAX_CHANNELS * AUDIO_IO_MAX_CHANNELS];
+	float *buffer;
+	float *interleaved;
+	float *src_planes[AUDIO_IO_MAX_CHANNELS];
+	float *dst_planes[AUDIO_IO_MAX_CHANNELS];
+	audio_io_resampler_s *resampler;
+	float *out_buffer;
+	float *out_planes[AUDIO_IO_MAX_CHANNELS];
+	float *out_interleaved;
+	unsigned int out_offset;
+	unsigned int out_pending;
+} audio_io_converter_s;
+
+typedef struct _audio_io_gain_s{
+	pthread_mutex_t lock;
+	/* requested by the application, under lock */
+	float target;
+	unsigned int ramp_frames;
+	audio_io_volume_ramp_e ramp;
+	int changed;
+	/* owned by the thread transferring the data */
+	float current;
+	float end;
+	float factor;		/* per frame, for an exponential ramp */
+	unsigned int remaining;
+	bool exponential;
+} audio_io_gain_s;
+
+typedef struct _audio_io_process_stage_s{
+	int type;		/* audio_io_process_stage_e or AUDIO_IO_PROCESS_STAGE_CUSTOM */
+	audio_in_process_cb callback;
+	void *user_data;
+	float coef[5];
+	float z1[AUDIO_IO_MAX_CHANNELS];
+	float z2[AUDIO_IO_MAX_CHANNELS];
+	float envelope;
+	float gain;
+	unsigned int hold;
+} audio_io_process_stage_s;
+
+typedef struct _audio_io_process_chain_s{
+	audio_sample_type_e type;
+	int channels;
+	int sample_rate;
+	float *buffer;
+	int stage_count;
+	audio_io_process_stage_s stages[AUDIO_IO_MAX_PROCESS_STAGES];
+} audio_io_process_chain_s;
 
 typedef struct _audio_in_s{
-	MMSoundPcmHandle_t mm_handle;
+	const audio_io_backend_s *_backend;
+	void *_stream;
 	int _buffer_size;
 	int _sample_rate;
 	audio_channel_e _channel;
 	audio_sample_type_e _type; 	
-} audio_in_s;
+	audio_channel_e _device_channel;
+	audio_sample_type_e _device_type;
+	int _device_rate;
+	audio_io_resampler_quality_e _resampler_quality;
+	int _device_buffer_size;
+	int _period_size;
+	void *_convert_buffer;
+	audio_io_converter_s *_converter;
+	audio_in_stream_cb _stream_cb;
+	void *_stream_userdata;
+	void *_stream_buffer;
+	pthread_t _stream_thread;
+	volatile int _stream_running;
+	volatile int _thread_error;	/* mm-sound error that stopped the stream thread */
+	void *_peek_buffer;
+	unsigned int _peek_length;
+	void *_vector_buffer;
+	bool _prepared;
+	bool _paused;
+	audio_io_gain_s _gain;
+	audio_io_process_chain_s *_process;
+	audio_io_stats_counters_s _stats;
+	audio_io_position_s _position;
+	audio_io_thread_policy_s _thread_policy;
+	audio_io_thread_policy_s _thread_granted;
+	audio_io_memlock_s _memlock;
+	struct _audio_io_recorder_s *_recorder;
+} __attribute__((aligned(AUDIO_IO_CACHE_LINE_SIZE))) audio_in_s;
 
 typedef struct _audio_out_s{
-	MMSoundPcmHandle_t mm_handle;
+	const audio_io_backend_s *_backend;
+	void *_stream;
 	int _buffer_size;
 	int _sample_rate;
 	audio_channel_e _channel;
 	audio_sample_type_e _type; 	
 	sound_type_e	_sound_type;
-} audio_out_s;
+	audio_channel_e _device_channel;
+	audio_sample_type_e _device_type;
+	int _device_rate;
+	audio_io_resampler_quality_e _resampler_quality;
+	int _device_buffer_size;
+	int _period_size;
+	int _period_count;
+	void *_convert_buffer;
+	audio_io_converter_s *_converter;
+	audio_out_stream_cb _stream_cb;
+	void *_stream_userdata;
+	void *_stream_buffer;
+	pthread_t _stream_thread;
+	volatile int _stream_running;
+	bool _nonblocking;
+	audio_io_ring_s *_ring;
+	sem_t _ring_sem;
+	pthread_t _drain_thread;
+	volatile int _drain_running;
+	volatile int _thread_error;	/* mm-sound error that stopped the stream or drain thread */
+	void *_write_buffer;
+	bool _write_acquired;
+	unsigned int _write_length;	/* bytes of the acquired buffer that may be committed */
+	void *_vector_buffer;
+	bool _prepared;
+	bool _paused;
+	audio_io_gain_s _gain;
+	audio_io_stats_counters_s _stats;
+	audio_io_position_s _position;
+	struct _audio_io_mixer_s *_mixer;
+	volatile int _mix_active;
+	int _mix_gain;
+	audio_io_thread_policy_s _thread_policy;
+	audio_io_thread_policy_s _thread_granted;
+	audio_io_memlock_s _memlock;
+	struct _audio_io_player_s *_player;
+} __attribute__((aligned(AUDIO_IO_CACHE_LINE_SIZE))) audio_out_s;
+
+/* recording of audio_in_start_recording(); the capture thread queues periods that the writer thread writes */
+typedef struct _audio_io_recorder_s{
+	int fd;
+	audio_io_container_e container;
+	audio_io_ring_s *ring;
+	unsigned int batch_size;
+	sem_t sem;
+	pthread_t thread;
+	bool writer_started;
+	volatile int stopping;
+	volatile int write_error;
+	unsigned long long captured_periods;
+	unsigned long long dropped_periods;
+	unsigned long long written_bytes;
+} audio_io_recorder_s;
+
+/* file playback of audio_out_play_file(); the stream thread of the handle writes the mapped file */
+typedef struct _audio_io_player_s{
+	void *map;
+	size_t map_size;
+	const unsigned char *data;	/* the samples within the mapping */
+	size_t length;
+	size_t offset;			/* bytes of the samples written, kept across pause and resume */
+	size_t advised;			/* end of the range the kernel was asked to read ahead */
+	size_t released;		/* end of the range the kernel was asked to drop */
+	audio_out_playback_cb callback;
+	void *user_data;
+	bool finished;
+} audio_io_player_s;
+
+typedef struct _audio_io_duplex_s{
+	audio_in_s *input;
+	audio_out_s *output;
+	unsigned int period_size;	/* bytes of one period in the format of the handle, the same for both directions */
+	void *input_buffer;
+	void *output_buffer;
+	audio_io_duplex_cb callback;
+	void *user_data;
+	pthread_t thread;
+	volatile int running;
+	bool prepared;
+} __attribute__((aligned(AUDIO_IO_CACHE_LINE_SIZE))) audio_io_duplex_s;
+
+typedef struct _audio_io_mixer_s{
+	const audio_io_backend_s *backend;
+	void *stream;
+	sound_type_e sound_type;
+	int period_size;
+	int refcount;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	audio_out_s *voices[AUDIO_IO_MIXER_MAX_VOICES];
+	int voice_count;
+	int *accum;
+	short *output;
+	pthread_t thread;
+	volatile int running;
+	audio_io_thread_policy_s granted;
+} audio_io_mixer_s;
+
+int _audio_io_ring_create(audio_io_ring_s **ring, unsigned int size);
+void _audio_io_ring_destroy(audio_io_ring_s *ring);
+void _audio_io_ring_reset(audio_io_ring_s *ring);
+unsigned int _audio_io_ring_readable(audio_io_ring_s *ring);
+unsigned int _audio_io_ring_writable(audio_io_ring_s *ring);
+unsigned int _audio_io_ring_write(audio_io_ring_s *ring, const void *data, unsigned int length);
+unsigned int _audio_io_ring_read(audio_io_ring_s *ring, void *data, unsigned int length);
+unsigned int _audio_io_ring_get_read_region(audio_io_ring_s *ring, void **data);
+void _audio_io_ring_consume(audio_io_ring_s *ring, unsigned int length);
+
+int _audio_io_get_channel_count(audio_channel_e channel);
+int _audio_io_get_sample_size(audio_sample_type_e type);
+
+unsigned long long _audio_io_get_time_us(void);
+void _audio_io_stats_init(audio_io_stats_counters_s *stats, unsigned long long period_us);
+void _audio_io_stats_restart(audio_io_stats_counters_s *stats);
+unsigned long long _audio_io_stats_begin(audio_io_stats_counters_s *stats);
+void _audio_io_stats_end(audio_io_stats_counters_s *stats, unsigned long long start_us, unsigned int requested, int result);
+void _audio_io_stats_get(audio_io_stats_counters_s *stats, audio_io_stats_s *out);
+void _audio_io_stats_reset(audio_io_stats_counters_s *stats);
+void _audio_io_position_update(audio_io_position_s *position, int transferred, int frame_size);
+
+void _audio_io_convert(const void *src, audio_sample_type_e src_type, void *dst, audio_sample_type_e dst_type, unsigned int samples);
+void _audio_io_convert_to_float(const void *src, audio_sample_type_e type, float *dst, unsigned int samples);
+void _audio_io_convert_from_float(const float *src, audio_sample_type_e type, void *dst, unsigned int samples);
+
+void _audio_io_channel_get_matrix(int src_channels, int dst_channels, float *matrix);
+void _audio_io_deinterleave_f32(const float *src, float **planes, int channels, unsigned int frames);
+void _audio_io_interleave_f32(float **planes, float *dst, int channels, unsigned int frames);
+void _audio_io_mix_planes(float **src, int src_channels, float **dst, int dst_channels, const float *matrix, unsigned int frames);
+
+int _audio_io_resampler_create(audio_io_resampler_s **resampler, int channels, int in_rate, int out_rate,
+		audio_io_resampler_quality_e quality, unsigned int max_in_frames);
+void _audio_io_resampler_destroy(audio_io_resampler_s *resampler);
+void _audio_io_resampler_reset(audio_io_resampler_s *resampler);
+unsigned int _audio_io_resampler_get_max_output(audio_io_resampler_s *resampler, unsigned int in_frames);
+unsigned int _audio_io_resampler_get_max_input(audio_io_resampler_s *resampler, unsigned int out_frames);
+unsigned int _audio_io_resampler_get_delay(audio_io_resampler_s *resampler);
+unsigned int _audio_io_resampler_process(audio_io_resampler_s *resampler, float **in, unsigned int frames, float **out);
+
+int _audio_io_converter_create(audio_io_converter_s **converter, audio_sample_type_e src_type, int src_channels,
+		audio_sample_type_e dst_type, int dst_channels, unsigned int max_frames);
+int _audio_io_converter_set_resampler(audio_io_converter_s *converter, int src_rate, int dst_rate, audio_io_resampler_quality_e quality);
+void _audio_io_converter_reset(audio_io_converter_s *converter);
+void _audio_io_converter_destroy(audio_io_converter_s *converter);
+unsigned int _audio_io_converter_push(audio_io_converter_s *converter, const void *src, void **src_planes, unsigned int offset, unsigned int frames);
+unsigned int _audio_io_converter_push_silence(audio_io_converter_s *converter, unsigned int frames);
+unsigned int _audio_io_converter_pull(audio_io_converter_s *converter, void *dst, void **dst_planes, unsigned int offset, unsigned int frames);
+void _audio_io_converter_process(audio_io_converter_s *converter, const void *src, void *dst, unsigned int frames);
+void _audio_io_converter_process_from_planar(audio_io_converter_s *converter, void **src_planes, unsigned int offset,
+		void *dst, unsigned int frames);
+void _audio_io_converter_process_to_planar(audio_io_converter_s *converter, const void *src, void **dst_planes,
+		unsigned int offset, unsigned int frames);
+
+void _audio_io_gain_init(audio_io_gain_s *gain);
+void _audio_io_gain_destroy(audio_io_gain_s *gain);
+void _audio_io_gain_set(audio_io_gain_s *gain, float target, unsigned int ramp_frames);
+float _audio_io_gain_get(audio_io_gain_s *gain);
+void _audio_io_gain_set_ramp(audio_io_gain_s *gain, audio_io_volume_ramp_e ramp);
+bool _audio_io_gain_is_unity(audio_io_gain_s *gain);
+void _audio_io_gain_apply(audio_io_gain_s *gain, audio_sample_type_e type, int channels, const void *src, void *dst, unsigned int frames);
+
+int _audio_io_process_create(audio_io_process_chain_s **chain, audio_sample_type_e type, int channels, int sample_rate);
+void _audio_io_process_destroy(audio_io_process_chain_s *chain);
+int _audio_io_process_add(audio_io_process_chain_s *chain, int type, float param,
+		audio_in_process_cb callback, void *user_data);
+void _audio_io_process_reset(audio_io_process_chain_s *chain);
+void _audio_io_process_run(audio_io_process_chain_s *chain, audio_in_h input, void *data, unsigned int frames);
+
+/* reads up to @length bytes of a WAV file from @offset, returns the bytes read */
+typedef int (*audio_io_wav_read_cb)(void *source, unsigned long long offset, void *buffer, unsigned int length);
+
+void _audio_io_wav_fill_header(unsigned char *header, audio_sample_type_e type, int channels, int rate, unsigned long long data_size);
+int _audio_io_wav_parse(audio_io_wav_read_cb read, void *source, const char *path, audio_sample_type_e type, int channels, int rate,
+		unsigned long long *data_offset, unsigned int *data_size);
+
+int _audio_io_in_read_period(audio_in_s *handle, void *buffer, unsigned int length);
+int _audio_io_out_write_period(audio_out_s *handle, const void *buffer, unsigned int length);
+int _audio_io_out_finish_stream(audio_out_s *handle);
+int _audio_io_convert_error_code(int code, const char *func_name);
+int _audio_io_player_start(audio_out_s *handle);
+
+int _audio_io_mixer_attach(audio_out_s *voice, sound_type_e sound_type);
+void _audio_io_mixer_detach(audio_out_s *voice);
+int _audio_io_mixer_start_voice(audio_out_s *voice);
+void _audio_io_mixer_stop_voice(audio_out_s *voice);
+int _audio_io_mixer_write(audio_out_s *voice, const void *buffer, unsigned int length);
+
+extern const audio_io_backend_s _audio_io_backend_mm_sound;
+extern const audio_io_backend_s _audio_io_backend_null;
+extern const audio_io_backend_s _audio_io_backend_file;
+extern const audio_io_backend_s _audio_io_backend_loopback;
+
+const audio_io_backend_s *_audio_io_backend_select(const audio_io_attr_s *attr, audio_io_direction_e direction, const char **path);
+int _audio_io_backend_get_buffer_size(int rate, audio_channel_e channel, audio_sample_type_e type);
+void _audio_io_backend_fill_silence(audio_sample_type_e type, void *buffer, unsigned int length);
+
+bool _audio_io_cache_enabled(void);
+int _audio_io_cache_open(const audio_io_backend_s *backend, audio_io_direction_e direction, int rate, audio_channel_e channel,
+		audio_sample_type_e type, sound_type_e sound_type, const char *path, void **stream);
+int _audio_io_cache_close(const audio_io_backend_s *backend, audio_io_direction_e direction, int rate, audio_channel_e channel,
+		audio_sample_type_e type, sound_type_e sound_type, void *stream, int buffer_size);
+int _audio_io_cache_prefill(const audio_io_backend_s *backend, audio_io_direction_e direction, int rate, audio_channel_e channel,
+		audio_sample_type_e type, sound_type_e sound_type, const char *path, unsigned int count);
+
+bool _audio_io_thread_policy_is_valid(audio_io_thread_policy_e policy, int priority);
+void _audio_io_thread_policy_init(audio_io_thread_policy_s *out, audio_io_thread_policy_e policy, int priority, unsigned long long cpu_mask);
+void _audio_io_thread_apply(const audio_io_thread_policy_s *requested, audio_io_thread_policy_s *granted);
+void _audio_io_memlock_enable(audio_io_memlock_s *memlock);
+void _audio_io_memlock_add(audio_io_memlock_s *memlock, void *addr, size_t length);
+void _audio_io_memlock_remove(audio_io_memlock_s *memlock, const void *addr);
+void _audio_io_memlock_release(audio_io_memlock_s *memlock);
+void _audio_io_converter_lock_memory(audio_io_converter_s *converter, audio_io_memlock_s *memlock);
+void _audio_io_resampler_lock_memory(audio_io_resampler_s *resampler, audio_io_memlock_s *memlock);
+void _audio_io_process_lock_memory(audio_io_process_chain_s *chain, audio_io_memlock_s *memlock);
+void _audio_io_realtime_status_get(const audio_io_thread_policy_s *granted, const audio_io_memlock_s *memlock,
+		audio_io_realtime_status_s *status);
+
+void *_audio_io_pool_alloc(size_t size);
+void _audio_io_pool_free(void *buffer);
+bool _audio_io_pool_owns(const void *buffer);
+void *_audio_io_handle_alloc(size_t size);
+void _audio_io_handle_free(void *handle, size_t size);
+
+int _audio_io_log_ratelimit(unsigned long long *last_us, unsigned int *suppressed, unsigned int *reported);
 
 #ifdef __cplusplus
 }
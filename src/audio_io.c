@@ -16,26 +16,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <string.h>
+#include <unistd.h>
 #include <mm.h>
 #include <glib.h>
 #include <audio_io_private.h>
-#include <dlog.h>
-
-#ifdef LOG_TAG
-#undef LOG_TAG
-#endif
-#define LOG_TAG "TIZEN_N_AUDIO_IO"
-
-/*
-* Internal Macros
-*/
-#define AUDIO_IO_CHECK_CONDITION(condition,error,msg)	\
-		if(condition) {} else \
-		{ LOGE("[%s] %s(0x%08x)",__FUNCTION__, msg,error); return error;}; \
-
-#define AUDIO_IO_NULL_ARG_CHECK(arg)	\
-	AUDIO_IO_CHECK_CONDITION(arg != NULL, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER" )
 
 /*
 * Internal Implementation
@@ -81,19 +67,40 @@ static int __convert_error_code(int code, char *func_name)
 	return ret;	
 }
 
+int _audio_io_convert_error_code(int code, const char *func_name)
+{
+	return __convert_error_code(code, (char*)func_name);
+}
+
+/* converts the error a library thread stopped on; AUDIO_IO_ERROR_NONE while the thread runs */
+static int __convert_thread_error(int code, char *func_name)
+{
+	int ret;
+	if (code == MM_ERROR_NONE)
+		return AUDIO_IO_ERROR_NONE;
+	if (code == MM_ERROR_SOUND_INVALID_STATE)
+	{
+		LOGE("[%s] (0x%08x) : the device stopped",func_name, AUDIO_IO_ERROR_INVALID_OPERATION);
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	ret = __convert_error_code(code, func_name);
+	return ret != AUDIO_IO_ERROR_NONE ? ret : AUDIO_IO_ERROR_INVALID_OPERATION;
+}
+
 static int __check_parameter(int sample_rate, audio_channel_e channel, audio_sample_type_e type)
 {
-	if(sample_rate<8000 || sample_rate > 48000)
+	if(sample_rate < AUDIO_IO_MIN_SAMPLE_RATE || sample_rate > AUDIO_IO_MAX_SAMPLE_RATE)
 	{
-		LOGE("[%s] AUDIO_IO_ERROR_INVALID_PARAMETER(0x%08x) :  Invalid sample rate (8000~48000Hz) : %d",__FUNCTION__, AUDIO_IO_ERROR_INVALID_PARAMETER,sample_rate);
+		LOGE("[%s] AUDIO_IO_ERROR_INVALID_PARAMETER(0x%08x) :  Invalid sample rate (%d~%dHz) : %d",__FUNCTION__, AUDIO_IO_ERROR_INVALID_PARAMETER,
+			AUDIO_IO_MIN_SAMPLE_RATE, AUDIO_IO_MAX_SAMPLE_RATE, sample_rate);
 		return AUDIO_IO_ERROR_INVALID_PARAMETER;
 	}
-	if (channel < AUDIO_CHANNEL_MONO || channel > AUDIO_CHANNEL_STEREO)
+	if (channel < AUDIO_CHANNEL_MONO || channel > AUDIO_CHANNEL_MULTI_8)
 	{
 		LOGE("[%s] AUDIO_IO_ERROR_INVALID_PARAMETER(0x%08x) :  Invalid audio channel : %d",__FUNCTION__, AUDIO_IO_ERROR_INVALID_PARAMETER,channel);
 		return AUDIO_IO_ERROR_INVALID_PARAMETER;
 	}
-	if (type < AUDIO_SAMPLE_TYPE_U8 || type > AUDIO_SAMPLE_TYPE_S16_LE)
+	if (type < AUDIO_SAMPLE_TYPE_U8 || type > AUDIO_SAMPLE_TYPE_FLOAT32_LE)
 	{
 		LOGE("[%s] AUDIO_IO_ERROR_INVALID_PARAMETER(0x%08x) :  Invalid sample typel : %d",__FUNCTION__, AUDIO_IO_ERROR_INVALID_PARAMETER,type);
 		return AUDIO_IO_ERROR_INVALID_PARAMETER;
@@ -101,238 +108,2181 @@ static int __check_parameter(int sample_rate, audio_channel_e channel, audio_sam
 	return AUDIO_IO_ERROR_NONE;
 }
 
+int _audio_io_get_channel_count(audio_channel_e channel)
+{
+	return channel - AUDIO_CHANNEL_MONO + 1;
+}
+
+int _audio_io_get_sample_size(audio_sample_type_e type)
+{
+	switch (type)
+	{
+		case AUDIO_SAMPLE_TYPE_U8:
+			return 1;
+		case AUDIO_SAMPLE_TYPE_S16_LE:
+			return 2;
+		case AUDIO_SAMPLE_TYPE_S24_LE:
+			return 3;
+		default:
+			return 4;
+	}
+}
+
+/* mm-sound only takes U8 and S16_LE, every other sample type is converted to S16_LE */
+static audio_sample_type_e __get_device_sample_type(audio_sample_type_e type)
+{
+	return type == AUDIO_SAMPLE_TYPE_U8 ? AUDIO_SAMPLE_TYPE_U8 : AUDIO_SAMPLE_TYPE_S16_LE;
+}
+
+/* mm-sound only takes mono and stereo, multichannel streams are mixed to (or from) stereo */
+static audio_channel_e __get_device_channel(audio_channel_e channel)
+{
+	return channel > AUDIO_CHANNEL_STEREO ? AUDIO_CHANNEL_STEREO : channel;
+}
+
 /*
-* Public Implementation
+* mm-sound only takes 8000~48000Hz, other rates are resampled to the nearest end of that range.
+* Multiples of 11025Hz go to 44100Hz, which keeps the resampling ratio an integer.
 */
-int audio_in_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type , audio_in_h* input)
+static int __get_device_rate(int sample_rate)
 {
-	AUDIO_IO_NULL_ARG_CHECK(input);
-	if(__check_parameter(sample_rate, channel, type)!=AUDIO_IO_ERROR_NONE)
-		return AUDIO_IO_ERROR_INVALID_PARAMETER;
+	if (sample_rate < AUDIO_IO_MIN_DEVICE_RATE)
+		return AUDIO_IO_MIN_DEVICE_RATE;
+	if (sample_rate > AUDIO_IO_MAX_DEVICE_RATE)
+		return sample_rate % 11025 == 0 ? 44100 : AUDIO_IO_MAX_DEVICE_RATE;
+	return sample_rate;
+}
 
-	audio_in_s * handle;
-	handle = (audio_in_s*)malloc( sizeof(audio_in_s));
-	if (handle != NULL)
-		memset(handle, 0 , sizeof(audio_in_s));
+/* application frames corresponding to @frames device frames */
+static unsigned long long __to_app_frames(unsigned long long frames, int sample_rate, int device_rate)
+{
+	return sample_rate == device_rate ? frames : frames * sample_rate / device_rate;
+}
+
+static int __get_frame_size(audio_channel_e channel, audio_sample_type_e type)
+{
+	return _audio_io_get_channel_count(channel) * _audio_io_get_sample_size(type);
+}
+
+static unsigned long long __get_period_us(int buffer_size, int sample_rate, audio_channel_e channel, audio_sample_type_e type)
+{
+	int frame_size = __get_frame_size(channel, type);
+	return (unsigned long long)buffer_size * 1000000ULL / ((unsigned long long)frame_size * sample_rate);
+}
+
+/*
+* Transfer size in device bytes for the period size or latency class requested in @attr, or the device
+* buffer size when nothing is requested. The size is rounded up to whole blocks of 8 frames.
+*/
+static int __get_period_size(const audio_io_attr_s *attr, int device_buffer_size, int sample_rate, int device_rate, int device_frame_size)
+{
+	unsigned long long frames;
+
+	if (attr == NULL)
+		return device_buffer_size;
+	if (attr->period_size > 0)
+		frames = attr->period_size;
+	else if (attr->latency_class == AUDIO_IO_LATENCY_CLASS_LOW)
+		frames = (unsigned long long)sample_rate * AUDIO_IO_LOW_LATENCY_PERIOD_MS / 1000;
+	else if (attr->latency_class == AUDIO_IO_LATENCY_CLASS_POWER_SAVING)
+		frames = (unsigned long long)sample_rate * AUDIO_IO_POWER_SAVING_PERIOD_MS / 1000;
+	else
+		return device_buffer_size;
+
+	frames = (frames * device_rate + sample_rate - 1) / sample_rate;
+	if (frames < AUDIO_IO_MIN_PERIOD_FRAMES)
+		frames = AUDIO_IO_MIN_PERIOD_FRAMES;
+	if (frames > (unsigned long long)device_rate)
+		frames = device_rate;
+	frames = (frames + 7) & ~7ULL;
+	return (int)frames * device_frame_size;
+}
+
+static int __get_period_count(const audio_io_attr_s *attr)
+{
+	unsigned int count = AUDIO_IO_RING_PERIODS;
+
+	if (attr == NULL)
+		return count;
+	if (attr->period_count > 0)
+		count = attr->period_count;
+	else if (attr->latency_class == AUDIO_IO_LATENCY_CLASS_LOW)
+		count = 2;
+	if (count < AUDIO_IO_MIN_PERIOD_COUNT)
+		count = AUDIO_IO_MIN_PERIOD_COUNT;
+	if (count > AUDIO_IO_MAX_PERIOD_COUNT)
+		count = AUDIO_IO_MAX_PERIOD_COUNT;
+	return count;
+}
+
+static void __reset_position(audio_io_position_s *position)
+{
+	__atomic_store_n(&position->frames, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&position->timestamp_us, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&position->reported, 0, __ATOMIC_RELAXED);
+}
+
+/*
+* Frames the device has consumed (playback) or produced (capture) since the last transfer completed,
+* extrapolated from the sample clock and bounded by the amount the device can hold.
+*/
+static unsigned long long __get_device_progress(audio_io_position_s *position, unsigned long long now_us, int sample_rate, unsigned long long limit)
+{
+	unsigned long long last_us = __atomic_load_n(&position->timestamp_us, __ATOMIC_ACQUIRE);
+	unsigned long long progress;
+	if (last_us == 0 || now_us <= last_us)
+		return 0;
+	progress = (now_us - last_us) * sample_rate / 1000000ULL;
+	return progress < limit ? progress : limit;
+}
+
+static void __us_to_timespec(unsigned long long us, struct timespec *ts)
+{
+	ts->tv_sec = us / 1000000ULL;
+	ts->tv_nsec = (us % 1000000ULL) * 1000;
+}
+
+static unsigned long long __audio_out_get_played_frames(audio_out_s *handle, unsigned long long now_us)
+{
+	int frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	unsigned long long written = __atomic_load_n(&handle->_position.frames, __ATOMIC_RELAXED);
+	unsigned long long queued = handle->_device_buffer_size / frame_size;
+	unsigned long long played;
+	unsigned long long reported;
+
+	if (queued > written)
+		queued = written;
+	played = written - queued + __get_device_progress(&handle->_position, now_us, handle->_device_rate, queued);
+
+	reported = __atomic_load_n(&handle->_position.reported, __ATOMIC_RELAXED);
+	if (played < reported)
+		played = reported;
 	else
+		__atomic_store_n(&handle->_position.reported, played, __ATOMIC_RELAXED);
+	return played;
+}
+
+static int __audio_in_device_read(audio_in_s *handle, void *buffer, unsigned int length)
+{
+	unsigned long long start = _audio_io_stats_begin(&handle->_stats);
+	int ret = handle->_backend->read(handle->_stream, buffer, length);
+	_audio_io_stats_end(&handle->_stats, start, length, ret);
+	int frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	_audio_io_position_update(&handle->_position, ret, frame_size);
+	if (ret > 0 && handle->_process)
+		_audio_io_process_run(handle->_process, (audio_in_h)handle, buffer, ret / frame_size);
+	if (ret > 0 && !_audio_io_gain_is_unity(&handle->_gain))
+		_audio_io_gain_apply(&handle->_gain, handle->_device_type, _audio_io_get_channel_count(handle->_device_channel),
+				buffer, buffer, ret / frame_size);
+	return ret;
+}
+
+static int __audio_out_device_write(audio_out_s *handle, void *buffer, unsigned int length)
+{
+	unsigned long long start = _audio_io_stats_begin(&handle->_stats);
+	int ret = handle->_backend->write(handle->_stream, buffer, length);
+	_audio_io_stats_end(&handle->_stats, start, length, ret);
+	_audio_io_position_update(&handle->_position, ret, __get_frame_size(handle->_device_channel, handle->_device_type));
+	return ret;
+}
+
+/*
+* Allocates the device format bounce buffer and the converter between @src and @dst.
+* @max_frames is the largest number of source frames converted at once.
+* Planar I/O always goes through the converter, so it is created on first use when the formats match.
+*/
+static int __create_converter(audio_io_converter_s **converter, void **convert_buffer, int device_buffer_size, unsigned int max_frames,
+		audio_sample_type_e src_type, audio_channel_e src_channel, int src_rate,
+		audio_sample_type_e dst_type, audio_channel_e dst_channel, int dst_rate, audio_io_resampler_quality_e quality)
+{
+	audio_io_converter_s *conv;
+	int ret;
+
+	if (*convert_buffer == NULL && (*convert_buffer = _audio_io_pool_alloc(device_buffer_size)) == NULL)
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	ret = _audio_io_converter_create(&conv, src_type, _audio_io_get_channel_count(src_channel),
+			dst_type, _audio_io_get_channel_count(dst_channel), max_frames);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	if (src_rate != dst_rate)
+	{
+		ret = _audio_io_converter_set_resampler(conv, src_rate, dst_rate, quality);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			_audio_io_converter_destroy(conv);
+			return ret;
+		}
+	}
+	*converter = conv;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+static int __buffer_alloc(int period_size, unsigned int periods, void **buffer, unsigned int *size)
+{
+	AUDIO_IO_CHECK_CONDITION(periods > 0 && periods <= UINT_MAX / (unsigned int)period_size, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	*buffer = _audio_io_pool_alloc((size_t)period_size * periods);
+	if (*buffer == NULL)
 	{
 		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
 		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
 	}
-	int ret = mm_sound_pcm_capture_open( &handle->mm_handle,sample_rate, channel, type);
-	if( ret < 0)
+	*size = period_size * periods;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+static int __audio_in_create_converter(audio_in_s *handle)
+{
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	return __create_converter(&handle->_converter, &handle->_convert_buffer, handle->_period_size,
+			handle->_period_size / device_frame_size,
+			handle->_device_type, handle->_device_channel, handle->_device_rate,
+			handle->_type, handle->_channel, handle->_sample_rate, handle->_resampler_quality);
+}
+
+static int __audio_out_create_converter(audio_out_s *handle)
+{
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	unsigned int device_frames = handle->_period_size / device_frame_size;
+	/* application frames that can still be resampled into one period */
+	unsigned long long max_frames = (unsigned long long)(device_frames - 1) * handle->_sample_rate / handle->_device_rate;
+	return __create_converter(&handle->_converter, &handle->_convert_buffer, handle->_period_size,
+			max_frames > device_frames ? max_frames : device_frames,
+			handle->_type, handle->_channel, handle->_sample_rate,
+			handle->_device_type, handle->_device_channel, handle->_device_rate, handle->_resampler_quality);
+}
+
+/*
+* Resampling counterpart of __audio_in_read_data(). Output left over from a device read stays pending
+* in the converter and is returned first by the next call.
+*/
+static int __audio_in_read_resampled(audio_in_s *handle, void *buffer, void **planes, int frame_size, unsigned int frames)
+{
+	audio_io_converter_s *conv = handle->_converter;
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	unsigned int chunk = handle->_period_size / device_frame_size;
+	unsigned int done = 0;
+	unsigned int n;
+	int ret;
+
+	while (1)
 	{
-		return __convert_error_code(ret, (char*)__FUNCTION__);
+		done += _audio_io_converter_pull(conv, planes ? NULL : (char*)buffer + done * frame_size, planes, done, frames - done);
+		if (done == frames)
+			break;
+		/* enough device frames for the rest of the request, at least one */
+		n = (unsigned long long)(frames - done) * handle->_device_rate / handle->_sample_rate + 1;
+		if (n > chunk)
+			n = chunk;
+		ret = __audio_in_device_read(handle, handle->_convert_buffer, n * device_frame_size);
+		if (ret <= 0)
+			return done > 0 ? (int)(done * frame_size) : ret;
+		_audio_io_converter_push(conv, handle->_convert_buffer, NULL, 0, ret / device_frame_size);
+		if ((unsigned int)ret < n * device_frame_size)
+		{
+			done += _audio_io_converter_pull(conv, planes ? NULL : (char*)buffer + done * frame_size, planes, done, frames - done);
+			break;
+		}
 	}
-	else
+	return done * frame_size;
+}
+
+/*
+* Reads @length bytes of application format data, converting from the device format if needed.
+* With @planes, @length is the size of each plane and the data is split per channel by the converter,
+* which must exist.
+* Returns the number of application bytes (per plane) read or a negative mm-sound error.
+*/
+static int __audio_in_read_data(audio_in_s *handle, void *buffer, void **planes, unsigned int length)
+{
+	if (handle->_converter == NULL && planes == NULL)
+		return __audio_in_device_read(handle, buffer, length);
+
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	int frame_size = planes ? _audio_io_get_sample_size(handle->_type) : __get_frame_size(handle->_channel, handle->_type);
+	unsigned int frames = length / frame_size;
+	if (handle->_converter->resampler)
+		return __audio_in_read_resampled(handle, buffer, planes, frame_size, frames);
+
+	unsigned int chunk = handle->_period_size / device_frame_size;
+	unsigned int done = 0;
+	unsigned int n;
+	int ret;
+
+	while (done < frames)
 	{
-		*input = (audio_in_h)handle;
-		handle->_buffer_size= ret;
-		handle->_sample_rate= sample_rate;
-		handle->_channel= channel;
-		handle->_type= type;
-		return AUDIO_IO_ERROR_NONE;
+		n = frames - done < chunk ? frames - done : chunk;
+		ret = __audio_in_device_read(handle, handle->_convert_buffer, n * device_frame_size);
+		if (ret <= 0)
+			return done > 0 ? (int)(done * frame_size) : ret;
+		ret /= device_frame_size;
+		if (planes)
+			_audio_io_converter_process_to_planar(handle->_converter, handle->_convert_buffer, planes, done, ret);
+		else
+			_audio_io_converter_process(handle->_converter, handle->_convert_buffer, (char*)buffer + done * frame_size, ret);
+		done += ret;
+		if ((unsigned int)ret < n)
+			break;
 	}
+	return done * frame_size;
 }
 
-int audio_in_destroy(audio_in_h input)
+/*
+* Reads one stream into the segments of @iov, in transfers of one period where possible : runs of at least
+* a period are read in place, and smaller segments are filled from a period read into the vector buffer.
+* Returns the number of bytes read, or the error of the first read if nothing was read.
+*/
+static int __audio_in_readv_data(audio_in_s *handle, const struct iovec *iov, int iovcnt)
 {
-	AUDIO_IO_NULL_ARG_CHECK(input);
-	audio_in_s  * handle = (audio_in_s  *) input;
-	int ret = mm_sound_pcm_capture_close(handle->mm_handle);
+	unsigned int period = handle->_buffer_size;
+	unsigned int frame_size = __get_frame_size(handle->_channel, handle->_type);
+	unsigned int total = 0;
+	unsigned int done = 0;
+	unsigned int offset = 0;
+	unsigned int staged = 0;
+	unsigned int position = 0;
+	unsigned int length, n;
+	bool short_read = false;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < iovcnt; i++)
+		total += iov[i].iov_len;
+	total -= total % frame_size;
+
+	i = 0;
+	while (done < total)
+	{
+		while (offset == iov[i].iov_len)
+		{
+			i++;
+			offset = 0;
+		}
+		length = iov[i].iov_len - offset;
+		if (length > total - done)
+			length = total - done;
+		if (staged == 0)
+		{
+			if (short_read)
+				break;
+			if (length >= period)
+			{
+				n = length - length % period;
+				ret = __audio_in_read_data(handle, (char*)iov[i].iov_base + offset, NULL, n);
+				if (ret <= 0)
+					break;
+				offset += ret;
+				done += ret;
+				if ((unsigned int)ret < n)
+					break;
+				continue;
+			}
+			n = total - done < period ? total - done : period;
+			ret = __audio_in_read_data(handle, handle->_vector_buffer, NULL, n);
+			if (ret <= 0)
+				break;
+			staged = ret;
+			position = 0;
+			short_read = (unsigned int)ret < n;
+		}
+		n = length < staged ? length : staged;
+		memcpy((char*)iov[i].iov_base + offset, (char*)handle->_vector_buffer + position, n);
+		position += n;
+		staged -= n;
+		offset += n;
+		done += n;
+	}
+	return done > 0 ? (int)done : ret;
+}
+
+static void __audio_out_wake_drain_thread(audio_out_s *handle)
+{
+	int value = 0;
+	sem_getvalue(&handle->_ring_sem, &value);
+	if(value == 0)
+		sem_post(&handle->_ring_sem);
+}
+
+/*
+* Hands device format data to the device, to the ring in non-blocking mode, or to the shared mixer.
+* Returns the number of bytes accepted, which is 0 when the ring is full.
+*/
+static int __audio_out_queue_data(audio_out_s *handle, void *buffer, unsigned int length)
+{
+	int ret;
+	if (handle->_mixer)
+	{
+		unsigned long long start = _audio_io_stats_begin(&handle->_stats);
+		ret = _audio_io_mixer_write(handle, buffer, length);
+		_audio_io_stats_end(&handle->_stats, start, length, ret);
+		return ret;
+	}
+	if (!handle->_nonblocking)
+		return __audio_out_device_write(handle, buffer, length);
+	ret = _audio_io_ring_write(handle->_ring, buffer, length);
+	__audio_out_wake_drain_thread(handle);
+	return ret;
+}
+
+/* applies the stream gain to @frames device frames converted into the bounce buffer, and queues them */
+static int __audio_out_queue_converted(audio_out_s *handle, unsigned int frames)
+{
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	if (!_audio_io_gain_is_unity(&handle->_gain))
+		_audio_io_gain_apply(&handle->_gain, handle->_device_type, _audio_io_get_channel_count(handle->_device_channel),
+				handle->_convert_buffer, handle->_convert_buffer, frames);
+	return __audio_out_queue_data(handle, handle->_convert_buffer, frames * device_frame_size);
+}
+
+/*
+* Gain counterpart of __audio_out_write_data() for data already in the device format : each chunk is scaled
+* into the bounce buffer, which replaces the copy the application would otherwise make.
+*/
+static int __audio_out_write_scaled(audio_out_s *handle, const void *buffer, unsigned int length)
+{
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	unsigned int frames = length / device_frame_size;
+	unsigned int chunk = handle->_period_size / device_frame_size;
+	unsigned int done = 0;
+	unsigned int n;
+	int ret;
+
+	while (done < frames)
+	{
+		n = frames - done < chunk ? frames - done : chunk;
+		if (handle->_nonblocking)
+		{
+			unsigned int space = _audio_io_ring_writable(handle->_ring) / device_frame_size;
+			if (space == 0)
+				break;
+			if (n > space)
+				n = space;
+		}
+		_audio_io_gain_apply(&handle->_gain, handle->_device_type, _audio_io_get_channel_count(handle->_device_channel),
+				(const char*)buffer + done * device_frame_size, handle->_convert_buffer, n);
+		ret = __audio_out_queue_data(handle, handle->_convert_buffer, n * device_frame_size);
+		if (ret <= 0)
+			return done > 0 ? (int)(done * device_frame_size) : ret;
+		done += ret / device_frame_size;
+	}
+	return done * device_frame_size;
+}
+
+/*
+* Resampling counterpart of __audio_out_write_data(). Each chunk is sized so that its output fits in
+* one device buffer (and in the free ring space in non-blocking mode), so nothing stays pending.
+*/
+static int __audio_out_write_resampled(audio_out_s *handle, const void *buffer, void **planes, int frame_size, unsigned int frames)
+{
+	audio_io_converter_s *conv = handle->_converter;
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	unsigned int chunk = _audio_io_resampler_get_max_input(conv->resampler, handle->_period_size / device_frame_size);
+	unsigned int done = 0;
+	unsigned int n;
+	unsigned int out;
+	int ret;
+
+	while (done < frames)
+	{
+		n = frames - done < chunk ? frames - done : chunk;
+		if (handle->_nonblocking)
+		{
+			unsigned int space = _audio_io_resampler_get_max_input(conv->resampler, _audio_io_ring_writable(handle->_ring) / device_frame_size);
+			if (space == 0)
+				break;
+			if (n > space)
+				n = space;
+		}
+		_audio_io_converter_push(conv, planes ? NULL : (const char*)buffer + done * frame_size, planes, done, n);
+		out = _audio_io_converter_pull(conv, handle->_convert_buffer, NULL, 0, conv->out_pending);
+		done += n;
+		if (out == 0)
+			continue;
+		ret = __audio_out_queue_converted(handle, out);
+		if (ret <= 0)
+			return done > n ? (int)((done - n) * frame_size) : ret;
+	}
+	return done * frame_size;
+}
+
+/*
+* Writes @length bytes of application format data, converting to the device format if needed.
+* With @planes, @length is the size of each plane and the channels are interleaved by the converter,
+* which must exist.
+* Returns the number of application bytes (per plane) accepted or a negative mm-sound error.
+*/
+static int __audio_out_write_data(audio_out_s *handle, const void *buffer, void **planes, unsigned int length)
+{
+	if (handle->_converter == NULL && planes == NULL)
+	{
+		if (_audio_io_gain_is_unity(&handle->_gain))
+			return __audio_out_queue_data(handle, (void*)buffer, length);
+		return __audio_out_write_scaled(handle, buffer, length);
+	}
+
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	int frame_size = planes ? _audio_io_get_sample_size(handle->_type) : __get_frame_size(handle->_channel, handle->_type);
+	unsigned int frames = length / frame_size;
+	if (handle->_converter->resampler)
+		return __audio_out_write_resampled(handle, buffer, planes, frame_size, frames);
+
+	unsigned int chunk = handle->_period_size / device_frame_size;
+	unsigned int done = 0;
+	unsigned int n;
+	int ret;
+
+	while (done < frames)
+	{
+		n = frames - done < chunk ? frames - done : chunk;
+		if (handle->_nonblocking)
+		{
+			unsigned int space = _audio_io_ring_writable(handle->_ring) / device_frame_size;
+			if (space == 0)
+				break;
+			if (n > space)
+				n = space;
+		}
+		if (planes)
+			_audio_io_converter_process_from_planar(handle->_converter, planes, done, handle->_convert_buffer, n);
+		else
+			_audio_io_converter_process(handle->_converter, (const char*)buffer + done * frame_size, handle->_convert_buffer, n);
+		ret = __audio_out_queue_converted(handle, n);
+		if (ret <= 0)
+			return done > 0 ? (int)(done * frame_size) : ret;
+		done += ret / device_frame_size;
+	}
+	return done * frame_size;
+}
+
+/*
+* Writes the segments of @iov as one stream, in transfers of one period where possible : runs of at least
+* a period are written in place, and smaller segments are gathered into the vector buffer first.
+* Returns the number of bytes written, which is short when a non-blocking queue fills up, or the error of
+* the first write if nothing was written.
+*/
+static int __audio_out_writev_data(audio_out_s *handle, const struct iovec *iov, int iovcnt)
+{
+	unsigned int period = handle->_buffer_size;
+	unsigned int frame_size = __get_frame_size(handle->_channel, handle->_type);
+	unsigned int done = 0;
+	unsigned int staged = 0;
+	unsigned int offset, length, n;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < iovcnt; i++)
+	{
+		offset = 0;
+		while (offset < iov[i].iov_len)
+		{
+			length = iov[i].iov_len - offset;
+			if (staged == 0 && length >= period)
+			{
+				n = length - length % period;
+				ret = __audio_out_write_data(handle, (char*)iov[i].iov_base + offset, NULL, n);
+				if (ret > 0)
+					done += ret;
+				if (ret < (int)n)
+					goto out;
+				offset += n;
+				continue;
+			}
+			n = length < period - staged ? length : period - staged;
+			memcpy((char*)handle->_vector_buffer + staged, (char*)iov[i].iov_base + offset, n);
+			staged += n;
+			offset += n;
+			if (staged == period)
+			{
+				ret = __audio_out_write_data(handle, handle->_vector_buffer, NULL, period);
+				if (ret > 0)
+					done += ret;
+				if (ret < (int)period)
+					goto out;
+				staged = 0;
+			}
+		}
+	}
+	/* a trailing partial frame is dropped, like audio_out_write() does */
+	staged -= staged % frame_size;
+	if (staged > 0)
+	{
+		ret = __audio_out_write_data(handle, handle->_vector_buffer, NULL, staged);
+		if (ret > 0)
+			done += ret;
+	}
+out:
+	return done > 0 ? (int)done : ret;
+}
+
+/* period I/O of the handles driven by a full-duplex handle; the result is the mm-sound one */
+int _audio_io_in_read_period(audio_in_s *handle, void *buffer, unsigned int length)
+{
+	return __audio_in_read_data(handle, buffer, NULL, length);
+}
+
+int _audio_io_out_write_period(audio_out_s *handle, const void *buffer, unsigned int length)
+{
+	return __audio_out_write_data(handle, buffer, NULL, length);
+}
+
+static void* __audio_in_stream_thread(void *data)
+{
+	audio_in_s * handle = (audio_in_s *) data;
+	int ret;
+	_audio_io_thread_apply(&handle->_thread_policy, &handle->_thread_granted);
+	while(handle->_stream_running)
+	{
+		ret = __audio_in_read_data(handle, handle->_stream_buffer, NULL, handle->_buffer_size);
+		if(ret > 0)
+		{
+			handle->_stream_cb((audio_in_h)handle, handle->_stream_buffer, ret, handle->_stream_userdata);
+		}
+		else
+		{
+			if(handle->_stream_running)
+			{
+				__convert_error_code(ret, (char*)__FUNCTION__);
+				handle->_thread_error = ret < 0 ? ret : MM_ERROR_SOUND_INVALID_STATE;
+			}
+			break;
+		}
+	}
+	return NULL;
+}
+
+static int __audio_in_start_stream_thread(audio_in_s *handle)
+{
+	handle->_stream_buffer = _audio_io_pool_alloc(handle->_buffer_size);
+	if(handle->_stream_buffer == NULL)
+	{
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	_audio_io_memlock_add(&handle->_memlock, handle->_stream_buffer, handle->_buffer_size);
+	handle->_stream_running = 1;
+	if(pthread_create(&handle->_stream_thread, NULL, __audio_in_stream_thread, handle) != 0)
+	{
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_OPERATION(0x%08x) : failed to create capture thread" ,__FUNCTION__,AUDIO_IO_ERROR_INVALID_OPERATION );
+		handle->_stream_running = 0;
+		_audio_io_memlock_remove(&handle->_memlock, handle->_stream_buffer);
+		_audio_io_pool_free(handle->_stream_buffer);
+		handle->_stream_buffer = NULL;
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	return AUDIO_IO_ERROR_NONE;
+}
+
+static void __audio_in_join_stream_thread(audio_in_s *handle)
+{
+	pthread_join(handle->_stream_thread, NULL);
+	_audio_io_memlock_remove(&handle->_memlock, handle->_stream_buffer);
+	_audio_io_pool_free(handle->_stream_buffer);
+	handle->_stream_buffer = NULL;
+}
+
+static void* __audio_out_stream_thread(void *data)
+{
+	audio_out_s * handle = (audio_out_s *) data;
+	int ret;
+	_audio_io_thread_apply(&handle->_thread_policy, &handle->_thread_granted);
+	while(handle->_stream_running)
+	{
+		handle->_stream_cb((audio_out_h)handle, handle->_stream_buffer, handle->_buffer_size, handle->_stream_userdata);
+		if(!handle->_stream_running)
+			break;
+		ret = __audio_out_write_data(handle, handle->_stream_buffer, NULL, handle->_buffer_size);
+		if(ret <= 0)
+		{
+			if(handle->_stream_running)
+			{
+				__convert_error_code(ret, (char*)__FUNCTION__);
+				handle->_thread_error = ret < 0 ? ret : MM_ERROR_SOUND_INVALID_STATE;
+			}
+			break;
+		}
+	}
+	return NULL;
+}
+
+static int __audio_out_start_stream_thread(audio_out_s *handle)
+{
+	handle->_stream_buffer = _audio_io_pool_alloc(handle->_buffer_size);
+	if(handle->_stream_buffer == NULL)
+	{
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	_audio_io_memlock_add(&handle->_memlock, handle->_stream_buffer, handle->_buffer_size);
+	handle->_stream_running = 1;
+	if(pthread_create(&handle->_stream_thread, NULL, __audio_out_stream_thread, handle) != 0)
+	{
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_OPERATION(0x%08x) : failed to create render thread" ,__FUNCTION__,AUDIO_IO_ERROR_INVALID_OPERATION );
+		handle->_stream_running = 0;
+		_audio_io_memlock_remove(&handle->_memlock, handle->_stream_buffer);
+		_audio_io_pool_free(handle->_stream_buffer);
+		handle->_stream_buffer = NULL;
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	return AUDIO_IO_ERROR_NONE;
+}
+
+static void __audio_out_join_stream_thread(audio_out_s *handle)
+{
+	pthread_join(handle->_stream_thread, NULL);
+	_audio_io_memlock_remove(&handle->_memlock, handle->_stream_buffer);
+	_audio_io_pool_free(handle->_stream_buffer);
+	handle->_stream_buffer = NULL;
+}
+
+static void* __audio_out_drain_thread(void *data)
+{
+	audio_out_s * handle = (audio_out_s *) data;
+	void *region;
+	unsigned int length;
+	int ret;
+	_audio_io_thread_apply(&handle->_thread_policy, &handle->_thread_granted);
+	while(handle->_drain_running)
+	{
+		length = _audio_io_ring_get_read_region(handle->_ring, &region);
+		if(length == 0)
+		{
+			sem_wait(&handle->_ring_sem);
+			continue;
+		}
+		if(length > (unsigned int)handle->_period_size)
+			length = handle->_period_size;
+		ret = __audio_out_device_write(handle, region, length);
+		if(ret <= 0)
+		{
+			/* kept for the next write, which would otherwise only find the queue full */
+			if(handle->_drain_running)
+			{
+				__convert_error_code(ret, (char*)__FUNCTION__);
+				handle->_thread_error = ret < 0 ? ret : MM_ERROR_SOUND_INVALID_STATE;
+			}
+			break;
+		}
+		_audio_io_ring_consume(handle->_ring, ret);
+	}
+	return NULL;
+}
+
+static int __audio_out_start_drain_thread(audio_out_s *handle)
+{
+	handle->_drain_running = 1;
+	if(pthread_create(&handle->_drain_thread, NULL, __audio_out_drain_thread, handle) != 0)
+	{
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_OPERATION(0x%08x) : failed to create drain thread" ,__FUNCTION__,AUDIO_IO_ERROR_INVALID_OPERATION );
+		handle->_drain_running = 0;
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	return AUDIO_IO_ERROR_NONE;
+}
+
+static void __audio_out_join_drain_thread(audio_out_s *handle)
+{
+	sem_post(&handle->_ring_sem);
+	pthread_join(handle->_drain_thread, NULL);
+}
+
+/*
+* Forgets the frames still queued in the device : the frames played so far become the written count,
+* so that the position neither jumps nor counts data that will never be played.
+*/
+static void __audio_out_settle_position(audio_out_s *handle)
+{
+	unsigned long long played = __audio_out_get_played_frames(handle, _audio_io_get_time_us());
+	__atomic_store_n(&handle->_position.timestamp_us, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&handle->_position.frames, played, __ATOMIC_RELAXED);
+	__atomic_store_n(&handle->_position.reported, played, __ATOMIC_RELAXED);
+}
+
+static unsigned int __audio_out_get_pending_us(audio_out_s *handle)
+{
+	int frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	unsigned long long now = _audio_io_get_time_us();
+	unsigned long long pending = __atomic_load_n(&handle->_position.frames, __ATOMIC_RELAXED) - __audio_out_get_played_frames(handle, now);
+	if (handle->_nonblocking || handle->_mixer)
+		pending += _audio_io_ring_readable(handle->_ring) / frame_size;
+	return pending * 1000000ULL / handle->_device_rate;
+}
+
+/* locks the memory the playback path touches, when the handle asked for it */
+static void __audio_out_lock_memory(audio_out_s *handle)
+{
+	audio_io_memlock_s *memlock = &handle->_memlock;
+	_audio_io_memlock_enable(memlock);
+	_audio_io_memlock_add(memlock, handle, sizeof(audio_out_s));
+	_audio_io_memlock_add(memlock, handle->_convert_buffer, handle->_period_size);
+	_audio_io_converter_lock_memory(handle->_converter, memlock);
+	if (handle->_ring)
+	{
+		_audio_io_memlock_add(memlock, handle->_ring, sizeof(audio_io_ring_s));
+		_audio_io_memlock_add(memlock, handle->_ring->buffer, handle->_ring->size);
+	}
+	_audio_io_memlock_add(memlock, handle->_write_buffer, handle->_buffer_size);
+	_audio_io_memlock_add(memlock, handle->_vector_buffer, handle->_buffer_size);
+}
+
+/* starts the device, or the mixer voice, and the thread that feeds it */
+static int __audio_out_start(audio_out_s *handle)
+{
+	int ret;
+	handle->_thread_error = MM_ERROR_NONE;
+	if (handle->_mixer)
+	{
+		ret = _audio_io_mixer_start_voice(handle);
+		if (ret != AUDIO_IO_ERROR_NONE)
+			return ret;
+		if (handle->_stream_cb != NULL)
+			ret = __audio_out_start_stream_thread(handle);
+		else if (handle->_player != NULL)
+			ret = _audio_io_player_start(handle);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			_audio_io_mixer_stop_voice(handle);
+			return ret;
+		}
+		return AUDIO_IO_ERROR_NONE;
+	}
+	ret = handle->_backend->start(handle->_stream, AUDIO_IO_DIRECTION_OUT);
+	if (ret != MM_ERROR_NONE)
+	{
+		return __convert_error_code(ret, (char*)__FUNCTION__);
+	}
+	if (handle->_stream_cb != NULL)
+		ret = __audio_out_start_stream_thread(handle);
+	else if (handle->_player != NULL)
+		ret = _audio_io_player_start(handle);
+	else if (handle->_nonblocking)
+		ret = __audio_out_start_drain_thread(handle);
+	if (ret != AUDIO_IO_ERROR_NONE)
+	{
+		handle->_backend->stop(handle->_stream, AUDIO_IO_DIRECTION_OUT);
+		return ret;
+	}
+	return AUDIO_IO_ERROR_NONE;
+}
+
+/*
+* Stops the device, or the mixer voice, and joins the thread that feeds it.
+* Data queued in the library and the conversion state are kept. Returns the backend stop result.
+*/
+static int __audio_out_stop(audio_out_s *handle)
+{
+	int stream_running = handle->_stream_running;
+	int drain_running = handle->_drain_running;
+	handle->_stream_running = 0;
+	handle->_drain_running = 0;
+	int ret = MM_ERROR_NONE;
+	if (handle->_mixer)
+		_audio_io_mixer_stop_voice(handle);
+	else
+		ret = handle->_backend->stop(handle->_stream, AUDIO_IO_DIRECTION_OUT);
+	if (stream_running)
+		__audio_out_join_stream_thread(handle);
+	if (drain_running)
+		__audio_out_join_drain_thread(handle);
+	return ret;
+}
+
+/*
+* Pushes the input the resampler still holds back through to the device with trailing silence,
+* so that the end of the stream is played.
+*/
+static int __audio_out_write_tail(audio_out_s *handle)
+{
+	audio_io_converter_s *conv = handle->_converter;
+	if (conv == NULL || conv->resampler == NULL)
+		return MM_ERROR_NONE;
+
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	unsigned int chunk = _audio_io_resampler_get_max_input(conv->resampler, handle->_period_size / device_frame_size);
+	unsigned int remaining = _audio_io_resampler_get_delay(conv->resampler);
+	unsigned int n, length, done;
+	int ret;
+
+	while (remaining > 0)
+	{
+		n = remaining < chunk ? remaining : chunk;
+		_audio_io_converter_push_silence(conv, n);
+		length = _audio_io_converter_pull(conv, handle->_convert_buffer, NULL, 0, conv->out_pending);
+		if (!_audio_io_gain_is_unity(&handle->_gain))
+			_audio_io_gain_apply(&handle->_gain, handle->_device_type, _audio_io_get_channel_count(handle->_device_channel),
+					handle->_convert_buffer, handle->_convert_buffer, length);
+		length *= device_frame_size;
+		remaining -= n;
+		for (done = 0; done < length; done += ret)
+		{
+			ret = __audio_out_queue_data(handle, (char*)handle->_convert_buffer + done, length - done);
+			if (ret < 0)
+				return ret;
+			/* a full non-blocking queue empties at the device rate, unless the drain thread stopped on an error */
+			if (ret == 0 && handle->_thread_error != MM_ERROR_NONE)
+				return handle->_thread_error;
+			if (ret == 0)
+				usleep(__get_period_us(handle->_period_size, handle->_device_rate, handle->_device_channel, handle->_device_type));
+		}
+	}
+	return MM_ERROR_NONE;
+}
+
+/*
+* Plays out the end of the stream written by a library thread, until it is played or the thread is stopped.
+* The result is the mm-sound one.
+*/
+int _audio_io_out_finish_stream(audio_out_s *handle)
+{
+	unsigned int pending_us;
+	int ret = __audio_out_write_tail(handle);
+	if (ret != MM_ERROR_NONE)
+		return ret;
+	/* short sleeps, so that a stop does not wait for the end of the stream */
+	while (handle->_stream_running && (pending_us = __audio_out_get_pending_us(handle)) > 0)
+		usleep(pending_us < 10000 ? pending_us : 10000);
+	return MM_ERROR_NONE;
+}
+
+/*
+* Public Implementation
+*/
+static int __audio_in_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type, audio_io_attr_s *attr, audio_in_h* input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	if(__check_parameter(sample_rate, channel, type)!=AUDIO_IO_ERROR_NONE)
+		return AUDIO_IO_ERROR_INVALID_PARAMETER;
+
+	audio_in_s * handle;
+	handle = (audio_in_s*)_audio_io_handle_alloc(sizeof(audio_in_s));
+	if (handle == NULL)
+	{
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	audio_sample_type_e device_type = __get_device_sample_type(type);
+	audio_channel_e device_channel = __get_device_channel(channel);
+	int device_rate = __get_device_rate(sample_rate);
+	const char *path;
+	handle->_backend = _audio_io_backend_select(attr, AUDIO_IO_DIRECTION_IN, &path);
+	int ret = _audio_io_cache_open(handle->_backend, AUDIO_IO_DIRECTION_IN, device_rate, device_channel, device_type, 0, path, &handle->_stream);
+	if( ret < 0)
+	{
+		_audio_io_handle_free(handle, sizeof(audio_in_s));
+		return __convert_error_code(ret, (char*)__FUNCTION__);
+	}
+	else
+	{
+		int device_frame_size = __get_frame_size(device_channel, device_type);
+		handle->_device_buffer_size= ret;
+		handle->_period_size= __get_period_size(attr, ret, sample_rate, device_rate, device_frame_size);
+		handle->_buffer_size= __to_app_frames(handle->_period_size / device_frame_size, sample_rate, device_rate) * __get_frame_size(channel, type);
+		handle->_sample_rate= sample_rate;
+		handle->_channel= channel;
+		handle->_type= type;
+		handle->_device_rate= device_rate;
+		handle->_device_channel= device_channel;
+		handle->_device_type= device_type;
+		handle->_resampler_quality= AUDIO_IO_RESAMPLER_QUALITY_MEDIUM;
+		if ((device_type != type || device_channel != channel || device_rate != sample_rate) &&
+			__audio_in_create_converter(handle) != AUDIO_IO_ERROR_NONE)
+		{
+			_audio_io_pool_free(handle->_convert_buffer);
+			_audio_io_cache_close(handle->_backend, AUDIO_IO_DIRECTION_IN, device_rate, device_channel, device_type, 0, handle->_stream, ret);
+			_audio_io_handle_free(handle, sizeof(audio_in_s));
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+		}
+		if (attr != NULL)
+		{
+			/* capture has no queue of its own, every read takes one period from the device */
+			attr->period_size = handle->_buffer_size / __get_frame_size(channel, type);
+			attr->period_count = 1;
+			handle->_thread_policy = attr->thread_policy;
+			handle->_memlock.requested = attr->memory_lock;
+		}
+		_audio_io_gain_init(&handle->_gain);
+		_audio_io_stats_init(&handle->_stats, __get_period_us(ret, device_rate, device_channel, device_type));
+		*input = (audio_in_h)handle;
+		return AUDIO_IO_ERROR_NONE;
+	}
+}
+
+int audio_in_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type , audio_in_h* input)
+{
+	return __audio_in_create(sample_rate, channel, type, NULL, input);
+}
+
+int audio_in_create_ex(int sample_rate, audio_channel_e channel, audio_sample_type_e type, audio_io_attr_h attr, audio_in_h* input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	return __audio_in_create(sample_rate, channel, type, (audio_io_attr_s*)attr, input);
+}
+
+int audio_in_destroy(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	if (handle->_recorder)
+		audio_in_stop_recording(input);
+	if(handle->_stream_running)
+		audio_in_unprepare(input);
+	int ret = _audio_io_cache_close(handle->_backend, AUDIO_IO_DIRECTION_IN, handle->_device_rate, handle->_device_channel,
+			handle->_device_type, 0, handle->_stream, handle->_device_buffer_size);
+	if (ret != MM_ERROR_NONE)
+	{
+		return __convert_error_code(ret, (char*)__FUNCTION__);
+	}
+	else
+	{
+		_audio_io_memlock_release(&handle->_memlock);
+		_audio_io_pool_free(handle->_peek_buffer);
+		_audio_io_pool_free(handle->_vector_buffer);
+		_audio_io_gain_destroy(&handle->_gain);
+		_audio_io_process_destroy(handle->_process);
+		_audio_io_converter_destroy(handle->_converter);
+		_audio_io_pool_free(handle->_convert_buffer);
+		_audio_io_handle_free(handle, sizeof(audio_in_s));
+		return AUDIO_IO_ERROR_NONE;
+	}
+}
+
+/* locks the memory the capture path touches, when the handle asked for it */
+static void __audio_in_lock_memory(audio_in_s *handle)
+{
+	audio_io_memlock_s *memlock = &handle->_memlock;
+	_audio_io_memlock_enable(memlock);
+	_audio_io_memlock_add(memlock, handle, sizeof(audio_in_s));
+	_audio_io_memlock_add(memlock, handle->_convert_buffer, handle->_period_size);
+	_audio_io_converter_lock_memory(handle->_converter, memlock);
+	_audio_io_process_lock_memory(handle->_process, memlock);
+	_audio_io_memlock_add(memlock, handle->_peek_buffer, handle->_buffer_size);
+	_audio_io_memlock_add(memlock, handle->_vector_buffer, handle->_buffer_size);
+}
+
+/* starts capturing, and the thread that hands the data to the stream callback */
+static int __audio_in_start(audio_in_s *handle)
+{
+	handle->_thread_error = MM_ERROR_NONE;
+	int ret = handle->_backend->start(handle->_stream, AUDIO_IO_DIRECTION_IN);
+	if (ret != MM_ERROR_NONE)
+	{
+		return __convert_error_code(ret, (char*)__FUNCTION__);
+	}
+	if (handle->_stream_cb != NULL)
+	{
+		ret = __audio_in_start_stream_thread(handle);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			handle->_backend->stop(handle->_stream, AUDIO_IO_DIRECTION_IN);
+			return ret;
+		}
+	}
+	return AUDIO_IO_ERROR_NONE;
+}
+
+/* stops capturing and joins the stream thread. Returns the backend stop result. */
+static int __audio_in_stop(audio_in_s *handle)
+{
+	int stream_running = handle->_stream_running;
+	handle->_stream_running = 0;
+	int ret = handle->_backend->stop(handle->_stream, AUDIO_IO_DIRECTION_IN);
+	if (stream_running)
+		__audio_in_join_stream_thread(handle);
+	return ret;
+}
+
+int audio_in_prepare(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(!handle->_stream_running, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	_audio_io_stats_restart(&handle->_stats);
+	__reset_position(&handle->_position);
+	_audio_io_converter_reset(handle->_converter);
+	_audio_io_process_reset(handle->_process);
+	__audio_in_lock_memory(handle);
+	int ret = __audio_in_start(handle);
+	if (ret != AUDIO_IO_ERROR_NONE)
+	{
+		_audio_io_memlock_release(&handle->_memlock);
+		return ret;
+	}
+	handle->_prepared = true;
+	handle->_paused = false;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_unprepare(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	int ret = __audio_in_stop(handle);
+	_audio_io_memlock_release(&handle->_memlock);
+	handle->_peek_length = 0;
+	handle->_prepared = false;
+	handle->_paused = false;
+	if (ret != MM_ERROR_NONE)
+	{
+		return __convert_error_code(ret, (char*)__FUNCTION__);
+	}
+	else
+		return __convert_thread_error(handle->_thread_error, (char*)__FUNCTION__);
+}
+
+int audio_in_pause(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(handle->_prepared && !handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret = __audio_in_stop(handle);
+	/* the position stops at the last frame read instead of running on with the clock */
+	__atomic_store_n(&handle->_position.timestamp_us, 0, __ATOMIC_RELAXED);
+	handle->_paused = true;
+	if (ret != MM_ERROR_NONE)
+		return __convert_error_code(ret, (char*)__FUNCTION__);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_resume(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	/* the pause is not a late transfer */
+	_audio_io_stats_restart(&handle->_stats);
+	int ret = __audio_in_start(handle);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	handle->_paused = false;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_flush(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	bool running = handle->_prepared && !handle->_paused;
+	int ret;
+	/* restarting the capture drops what the device has recorded but not yet handed over */
+	if (running)
+	{
+		ret = __audio_in_stop(handle);
+		if (ret != MM_ERROR_NONE)
+			return __convert_error_code(ret, (char*)__FUNCTION__);
+	}
+	handle->_peek_length = 0;
+	_audio_io_converter_reset(handle->_converter);
+	_audio_io_process_reset(handle->_process);
+	__atomic_store_n(&handle->_position.timestamp_us, 0, __ATOMIC_RELAXED);
+	if (running)
+		return __audio_in_start(handle);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_read(audio_in_h input, void *buffer, unsigned int length )
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(buffer);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL && handle->_peek_length == 0 && !handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret;
+	int result;
+	ret = __audio_in_read_data(handle, buffer, NULL, length);
+
+	if (ret >0)
+	{
+		AUDIO_IO_LOGI_RATELIMITED("[%s] %d bytes read" ,__FUNCTION__, ret);
+		return ret;
+	}
+
+	switch(ret)
+	{
+		case MM_ERROR_SOUND_INVALID_STATE:
+			result = AUDIO_IO_ERROR_INVALID_OPERATION;
+			LOGE("[%s] (0x%08x) : Not recording started yet.",(char*)__FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+			break;
+		default:
+			result = __convert_error_code(ret, (char*)__FUNCTION__);
+			break;
+	}
+	return result;
+}
+
+int audio_in_get_buffer_size(audio_in_h input, int *size)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(size);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	*size = handle->_buffer_size;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_get_sample_rate(audio_in_h input, int *sample_rate)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(sample_rate);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	*sample_rate = handle->_sample_rate;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+
+int audio_in_get_channel(audio_in_h input, audio_channel_e *channel)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(channel);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	*channel = handle->_channel;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_get_sample_type(audio_in_h input, audio_sample_type_e *type)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(type);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	*type = handle->_type;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_set_stream_cb(audio_in_h input, audio_in_stream_cb callback, void *user_data)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(callback);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(!handle->_stream_running && handle->_recorder == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	handle->_stream_cb = callback;
+	handle->_stream_userdata = user_data;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_unset_stream_cb(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(!handle->_stream_running && handle->_recorder == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	handle->_stream_cb = NULL;
+	handle->_stream_userdata = NULL;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_peek(audio_in_h input, const void **data, unsigned int *length)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(data);
+	AUDIO_IO_NULL_ARG_CHECK(length);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret;
+	if (handle->_peek_length == 0)
+	{
+		if (handle->_peek_buffer == NULL)
+		{
+			handle->_peek_buffer = _audio_io_pool_alloc(handle->_buffer_size);
+			if (handle->_peek_buffer == NULL)
+			{
+				LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+				return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+			}
+			_audio_io_memlock_add(&handle->_memlock, handle->_peek_buffer, handle->_buffer_size);
+		}
+		ret = __audio_in_read_data(handle, handle->_peek_buffer, NULL, handle->_buffer_size);
+		if (ret <= 0)
+		{
+			switch(ret)
+			{
+				case MM_ERROR_SOUND_INVALID_STATE:
+					LOGE("[%s] (0x%08x) : Not recording started yet.",(char*)__FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+					return AUDIO_IO_ERROR_INVALID_OPERATION;
+				default:
+					return __convert_error_code(ret, (char*)__FUNCTION__);
+			}
+		}
+		handle->_peek_length = ret;
+	}
+	*data = handle->_peek_buffer;
+	*length = handle->_peek_length;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_drop(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(handle->_peek_length > 0, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	handle->_peek_length = 0;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_get_stats(audio_in_h input, audio_io_stats_s *stats)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(stats);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	_audio_io_stats_get(&handle->_stats, stats);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_reset_stats(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	_audio_io_stats_reset(&handle->_stats);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_get_position(audio_in_h input, unsigned long long *frames, struct timespec *timestamp)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(frames);
+	AUDIO_IO_NULL_ARG_CHECK(timestamp);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	int frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	unsigned long long now = _audio_io_get_time_us();
+	*frames = __to_app_frames(__atomic_load_n(&handle->_position.frames, __ATOMIC_RELAXED) +
+		__get_device_progress(&handle->_position, now, handle->_device_rate, handle->_device_buffer_size / frame_size),
+		handle->_sample_rate, handle->_device_rate);
+	__us_to_timespec(now, timestamp);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_read_planar(audio_in_h input, void **planes, unsigned int length)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(planes);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL && handle->_peek_length == 0 && !handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret;
+	if (handle->_converter == NULL)
+	{
+		ret = __audio_in_create_converter(handle);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return ret;
+		}
+	}
+	ret = __audio_in_read_data(handle, NULL, planes, length);
+	if (ret > 0)
+	{
+		AUDIO_IO_LOGI_RATELIMITED("[%s] %d bytes per channel read" ,__FUNCTION__, ret);
+		return ret;
+	}
+	switch(ret)
+	{
+		case MM_ERROR_SOUND_INVALID_STATE:
+			LOGE("[%s] (0x%08x) : Not recording started yet.",(char*)__FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+			return AUDIO_IO_ERROR_INVALID_OPERATION;
+		default:
+			return __convert_error_code(ret, (char*)__FUNCTION__);
+	}
+}
+
+int audio_in_set_resampler_quality(audio_in_h input, audio_io_resampler_quality_e quality)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_CHECK_CONDITION(quality >= AUDIO_IO_RESAMPLER_QUALITY_LOW && quality <= AUDIO_IO_RESAMPLER_QUALITY_HIGH, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(!handle->_stream_running, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret;
+	if (handle->_converter && handle->_converter->resampler && quality != handle->_resampler_quality)
+	{
+		ret = _audio_io_converter_set_resampler(handle->_converter, handle->_device_rate, handle->_sample_rate, quality);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return ret;
+		}
+	}
+	handle->_resampler_quality = quality;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_prefill_handle_cache(int sample_rate, audio_channel_e channel, audio_sample_type_e type, unsigned int count)
+{
+	if(__check_parameter(sample_rate, channel, type)!=AUDIO_IO_ERROR_NONE)
+		return AUDIO_IO_ERROR_INVALID_PARAMETER;
+	AUDIO_IO_CHECK_CONDITION(_audio_io_cache_enabled(), AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	const char *path;
+	const audio_io_backend_s *backend = _audio_io_backend_select(NULL, AUDIO_IO_DIRECTION_IN, &path);
+	int ret = _audio_io_cache_prefill(backend, AUDIO_IO_DIRECTION_IN, __get_device_rate(sample_rate), __get_device_channel(channel),
+			__get_device_sample_type(type), 0, path, count);
+	if (ret != MM_ERROR_NONE)
+		return __convert_error_code(ret, (char*)__FUNCTION__);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_readv(audio_in_h input, const struct iovec *iov, int iovcnt)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(iov);
+	AUDIO_IO_CHECK_CONDITION(iovcnt > 0, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL && handle->_peek_length == 0 && !handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int i;
+	for (i = 0; i < iovcnt; i++)
+		AUDIO_IO_CHECK_CONDITION(iov[i].iov_base != NULL || iov[i].iov_len == 0, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	if (handle->_vector_buffer == NULL)
+	{
+		handle->_vector_buffer = _audio_io_pool_alloc(handle->_buffer_size);
+		if (handle->_vector_buffer == NULL)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+		}
+		_audio_io_memlock_add(&handle->_memlock, handle->_vector_buffer, handle->_buffer_size);
+	}
+	int ret = __audio_in_readv_data(handle, iov, iovcnt);
+	if (ret >= 0)
+	{
+		AUDIO_IO_LOGI_RATELIMITED("[%s] %d bytes read into %d segments" ,__FUNCTION__, ret, iovcnt);
+		return ret;
+	}
+	switch(ret)
+	{
+		case MM_ERROR_SOUND_INVALID_STATE:
+			ret = AUDIO_IO_ERROR_INVALID_OPERATION;
+			LOGE("[%s] (0x%08x) : Not recording started yet.",(char*)__FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+			break;
+		default:
+			ret = __convert_error_code(ret, (char*)__FUNCTION__);
+			break;
+	}
+	return ret;
+}
+
+int audio_in_set_volume(audio_in_h input, float gain, unsigned int ramp_ms)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_CHECK_CONDITION(gain >= 0.0f && gain <= AUDIO_IO_MAX_VOLUME, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	AUDIO_IO_CHECK_CONDITION(ramp_ms <= AUDIO_IO_MAX_VOLUME_RAMP_MS, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	audio_in_s  * handle = (audio_in_s  *) input;
+	_audio_io_gain_set(&handle->_gain, gain, (unsigned long long)ramp_ms * handle->_device_rate / 1000);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_get_volume(audio_in_h input, float *gain)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(gain);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	*gain = _audio_io_gain_get(&handle->_gain);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_get_realtime_status(audio_in_h input, audio_io_realtime_status_s *status)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(status);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	_audio_io_realtime_status_get(&handle->_thread_granted, &handle->_memlock, status);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_buffer_alloc(audio_in_h input, unsigned int periods, void **buffer, unsigned int *size)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(buffer);
+	AUDIO_IO_NULL_ARG_CHECK(size);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	return __buffer_alloc(handle->_buffer_size, periods, buffer, size);
+}
+
+int audio_in_set_volume_ramp(audio_in_h input, audio_io_volume_ramp_e ramp)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_CHECK_CONDITION(ramp >= AUDIO_IO_VOLUME_RAMP_LINEAR && ramp <= AUDIO_IO_VOLUME_RAMP_EXPONENTIAL, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	audio_in_s  * handle = (audio_in_s  *) input;
+	_audio_io_gain_set_ramp(&handle->_gain, ramp);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+static int __audio_in_add_process_stage(audio_in_s *handle, int stage, float param,
+		audio_in_process_cb callback, void *user_data)
+{
+	AUDIO_IO_CHECK_CONDITION(!handle->_prepared || handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret;
+	if (handle->_process == NULL)
+	{
+		ret = _audio_io_process_create(&handle->_process, handle->_device_type, _audio_io_get_channel_count(handle->_device_channel),
+				handle->_device_rate);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+		}
+	}
+	ret = _audio_io_process_add(handle->_process, stage, param, callback, user_data);
+	if (ret != AUDIO_IO_ERROR_NONE)
+	{
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_OPERATION(0x%08x) : the processing chain is full" ,__FUNCTION__,AUDIO_IO_ERROR_INVALID_OPERATION );
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_add_process_stage(audio_in_h input, audio_io_process_stage_e stage, float param)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	switch (stage)
+	{
+		case AUDIO_IO_PROCESS_STAGE_DC_BLOCKER:
+		case AUDIO_IO_PROCESS_STAGE_HIGH_PASS:
+			AUDIO_IO_CHECK_CONDITION(param > 0.0f && param < handle->_device_rate / 2, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+			break;
+		case AUDIO_IO_PROCESS_STAGE_AGC:
+			AUDIO_IO_CHECK_CONDITION(param >= -60.0f && param <= 0.0f, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+			break;
+		case AUDIO_IO_PROCESS_STAGE_NOISE_GATE:
+			AUDIO_IO_CHECK_CONDITION(param >= -96.0f && param <= 0.0f, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+			break;
+		default:
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_PARAMETER(0x%08x) : Invalid process stage : %d" ,__FUNCTION__,AUDIO_IO_ERROR_INVALID_PARAMETER,stage );
+			return AUDIO_IO_ERROR_INVALID_PARAMETER;
+	}
+	return __audio_in_add_process_stage(handle, stage, param, NULL, NULL);
+}
+
+int audio_in_add_custom_process_stage(audio_in_h input, audio_in_process_cb callback, void *user_data)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(callback);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	return __audio_in_add_process_stage(handle, AUDIO_IO_PROCESS_STAGE_CUSTOM, 0.0f, callback, user_data);
+}
+
+int audio_in_clear_process_stages(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_CHECK_CONDITION(!handle->_prepared || handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	_audio_io_process_destroy(handle->_process);
+	handle->_process = NULL;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+static int __audio_out_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type, bool mixed,
+		audio_io_attr_s *attr, audio_out_h* output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	if(__check_parameter(sample_rate, channel, type)!=AUDIO_IO_ERROR_NONE)
+		return AUDIO_IO_ERROR_INVALID_PARAMETER;
+	if(sound_type < SOUND_TYPE_SYSTEM || sound_type > SOUND_TYPE_CALL)
+	{
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_PARAMETER(0x%08x) : Invalid sample sound type : %d" ,__FUNCTION__,AUDIO_IO_ERROR_INVALID_PARAMETER,sound_type );
+		return AUDIO_IO_ERROR_INVALID_PARAMETER;
+	}
+	
+	audio_out_s * handle;
+	handle = (audio_out_s*)_audio_io_handle_alloc(sizeof(audio_out_s));
+	if (handle == NULL)
+	{
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	int ret;
+	if (mixed)
+	{
+		/* the mixer sets the device format of the voice */
+		ret = _audio_io_mixer_attach(handle, sound_type);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			_audio_io_handle_free(handle, sizeof(audio_out_s));
+			LOGE("[%s] ERROR :  (0x%08x) : failed to attach to the mixer" ,__FUNCTION__,ret );
+			return ret;
+		}
+	}
+	else
+	{
+		handle->_device_type= __get_device_sample_type(type);
+		handle->_device_channel= __get_device_channel(channel);
+		handle->_device_rate= __get_device_rate(sample_rate);
+		const char *path;
+		handle->_backend = _audio_io_backend_select(attr, AUDIO_IO_DIRECTION_OUT, &path);
+		ret = _audio_io_cache_open(handle->_backend, AUDIO_IO_DIRECTION_OUT, handle->_device_rate, handle->_device_channel, handle->_device_type,
+				sound_type, path, &handle->_stream);
+		if( ret < 0)
+		{
+			_audio_io_handle_free(handle, sizeof(audio_out_s));
+			return __convert_error_code(ret, (char*)__FUNCTION__);
+		}
+		handle->_device_buffer_size= ret;
+		handle->_period_size= __get_period_size(attr, ret, sample_rate, handle->_device_rate,
+				__get_frame_size(handle->_device_channel, handle->_device_type));
+		handle->_period_count= __get_period_count(attr);
+	}
+	int device_frame_size = __get_frame_size(handle->_device_channel, handle->_device_type);
+	handle->_buffer_size= __to_app_frames(handle->_period_size / device_frame_size, sample_rate, handle->_device_rate) * __get_frame_size(channel, type);
+	handle->_sample_rate= sample_rate;
+	handle->_channel= channel;
+	handle->_type= type;
+	handle->_sound_type= sound_type;
+	handle->_resampler_quality= AUDIO_IO_RESAMPLER_QUALITY_MEDIUM;
+	if ((handle->_device_type != type || handle->_device_channel != channel || handle->_device_rate != sample_rate) &&
+		__audio_out_create_converter(handle) != AUDIO_IO_ERROR_NONE)
+	{
+		_audio_io_pool_free(handle->_convert_buffer);
+		if (mixed)
+			_audio_io_mixer_detach(handle);
+		else
+			_audio_io_cache_close(handle->_backend, AUDIO_IO_DIRECTION_OUT, handle->_device_rate, handle->_device_channel, handle->_device_type,
+					sound_type, handle->_stream, handle->_device_buffer_size);
+		_audio_io_handle_free(handle, sizeof(audio_out_s));
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	if (attr != NULL)
+	{
+		attr->period_size = handle->_buffer_size / __get_frame_size(channel, type);
+		attr->period_count = handle->_period_count;
+		handle->_thread_policy = attr->thread_policy;
+		handle->_memlock.requested = attr->memory_lock;
+	}
+	_audio_io_gain_init(&handle->_gain);
+	_audio_io_stats_init(&handle->_stats, __get_period_us(handle->_device_buffer_size, handle->_device_rate, handle->_device_channel, handle->_device_type));
+	*output = (audio_out_h)handle;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type,  audio_out_h* output)
+{
+	return __audio_out_create(sample_rate, channel, type, sound_type, false, NULL, output);
+}
+
+int audio_out_create_ex(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type, audio_io_attr_h attr, audio_out_h* output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	return __audio_out_create(sample_rate, channel, type, sound_type, false, (audio_io_attr_s*)attr, output);
+}
+
+int audio_out_create_mixed(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type, audio_out_h* output)
+{
+	return __audio_out_create(sample_rate, channel, type, sound_type, true, NULL, output);
+}
+
+int audio_out_destroy(audio_out_h output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	if (handle->_player)
+		audio_out_stop_file(output);
+	if(handle->_stream_running || handle->_drain_running || handle->_mix_active)
+		audio_out_unprepare(output);
+	int ret = MM_ERROR_NONE;
+	if (handle->_mixer)
+		_audio_io_mixer_detach(handle);
+	else
+		ret = _audio_io_cache_close(handle->_backend, AUDIO_IO_DIRECTION_OUT, handle->_device_rate, handle->_device_channel, handle->_device_type,
+				handle->_sound_type, handle->_stream, handle->_device_buffer_size);
+	if (ret != MM_ERROR_NONE)
+	{
+		return __convert_error_code(ret, (char*)__FUNCTION__);
+	}
+	else
+	{
+		if (handle->_nonblocking && handle->_ring)
+			audio_out_set_nonblocking(output, false);
+		_audio_io_memlock_release(&handle->_memlock);
+		_audio_io_pool_free(handle->_write_buffer);
+		_audio_io_pool_free(handle->_vector_buffer);
+		_audio_io_gain_destroy(&handle->_gain);
+		_audio_io_converter_destroy(handle->_converter);
+		_audio_io_pool_free(handle->_convert_buffer);
+		_audio_io_handle_free(handle, sizeof(audio_out_s));
+		return AUDIO_IO_ERROR_NONE;
+	}
+}
+
+int audio_out_prepare(audio_out_h output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(!handle->_stream_running && !handle->_drain_running && !handle->_mix_active, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	_audio_io_stats_restart(&handle->_stats);
+	__reset_position(&handle->_position);
+	_audio_io_converter_reset(handle->_converter);
+	__audio_out_lock_memory(handle);
+	int ret = __audio_out_start(handle);
+	if (ret != AUDIO_IO_ERROR_NONE)
+	{
+		_audio_io_memlock_release(&handle->_memlock);
+		return ret;
+	}
+	handle->_prepared = true;
+	handle->_paused = false;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_unprepare(audio_out_h output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	int ret = __audio_out_stop(handle);
+	_audio_io_memlock_release(&handle->_memlock);
+	/* nothing reads the queue any more, so what is left in it is dropped */
+	if (handle->_ring)
+		_audio_io_ring_reset(handle->_ring);
+	handle->_prepared = false;
+	handle->_paused = false;
 	if (ret != MM_ERROR_NONE)
 	{
 		return __convert_error_code(ret, (char*)__FUNCTION__);
 	}
 	else
-	{
-		free(handle);
-		return AUDIO_IO_ERROR_NONE;
-	}
+		return __convert_thread_error(handle->_thread_error, (char*)__FUNCTION__);
 }
 
-int audio_in_prepare(audio_in_h input)
+int audio_out_pause(audio_out_h output)
 {
-	AUDIO_IO_NULL_ARG_CHECK(input);
-	audio_in_s  * handle = (audio_in_s  *) input;
-	int ret = mm_sound_pcm_capture_start(handle->mm_handle);
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(handle->_prepared && !handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret = __audio_out_stop(handle);
+	__audio_out_settle_position(handle);
+	handle->_paused = true;
 	if (ret != MM_ERROR_NONE)
-	{
 		return __convert_error_code(ret, (char*)__FUNCTION__);
-	}
-	else
-		return AUDIO_IO_ERROR_NONE;
+	return AUDIO_IO_ERROR_NONE;
 }
 
-int audio_in_unprepare(audio_in_h input)
+int audio_out_resume(audio_out_h output)
 {
-	AUDIO_IO_NULL_ARG_CHECK(input);
-	audio_in_s  * handle = (audio_in_s  *) input;
-	int ret = mm_sound_pcm_capture_stop(handle->mm_handle);
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	/* the pause is not a late transfer */
+	_audio_io_stats_restart(&handle->_stats);
+	int ret = __audio_out_start(handle);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	handle->_paused = false;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_drain(audio_out_h output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(handle->_prepared && !handle->_paused && handle->_stream_cb == NULL && handle->_player == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret = __audio_out_write_tail(handle);
 	if (ret != MM_ERROR_NONE)
+		return __convert_thread_error(ret, (char*)__FUNCTION__);
+	/* the queue and the device empty at the sample rate, so sleeping for what is pending converges */
+	unsigned int pending_us;
+	while ((pending_us = __audio_out_get_pending_us(handle)) > 0)
 	{
-		return __convert_error_code(ret, (char*)__FUNCTION__);
+		AUDIO_IO_CHECK_CONDITION(handle->_prepared && !handle->_paused, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+		/* a queue whose drain thread stopped on an error never empties */
+		ret = __convert_thread_error(handle->_thread_error, (char*)__FUNCTION__);
+		if (ret != AUDIO_IO_ERROR_NONE)
+			return ret;
+		usleep(pending_us);
 	}
-	else
-		return AUDIO_IO_ERROR_NONE;
+	return AUDIO_IO_ERROR_NONE;
 }
 
-int audio_in_read(audio_in_h input, void *buffer, unsigned int length )
+int audio_out_flush(audio_out_h output)
 {
-	AUDIO_IO_NULL_ARG_CHECK(input);
-	AUDIO_IO_NULL_ARG_CHECK(buffer);
-	audio_in_s  * handle = (audio_in_s  *) input;
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL && handle->_player == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	bool running = handle->_prepared && !handle->_paused;
 	int ret;
-	int result;
-	ret = mm_sound_pcm_capture_read(handle->mm_handle, (void*) buffer, length);
+	/* stopping the device drops what it holds, and leaves the queue without a reader while it is reset */
+	if (running)
+	{
+		ret = __audio_out_stop(handle);
+		if (ret != MM_ERROR_NONE)
+			return __convert_error_code(ret, (char*)__FUNCTION__);
+	}
+	if (handle->_ring)
+		_audio_io_ring_reset(handle->_ring);
+	_audio_io_converter_reset(handle->_converter);
+	__audio_out_settle_position(handle);
+	if (running)
+		return __audio_out_start(handle);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+
 
+int audio_out_write(audio_out_h output, void* buffer, unsigned int length)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_NULL_ARG_CHECK(buffer);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL && handle->_player == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	/* a paused device takes no data, only the non-blocking queue does */
+	AUDIO_IO_CHECK_CONDITION(!handle->_paused || handle->_nonblocking, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret = __convert_thread_error(handle->_thread_error, (char*)__FUNCTION__);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	ret = __audio_out_write_data(handle, buffer, NULL, length);
+	if (handle->_nonblocking)
+	{
+		if (ret == 0 && length > 0)
+			return AUDIO_IO_ERROR_INVALID_OPERATION;
+		return ret;
+	}
 	if (ret >0)
 	{
-		LOGI("[%s] %d bytes read" ,__FUNCTION__, ret);
+		AUDIO_IO_LOGI_RATELIMITED("[%s] %d bytes written" ,__FUNCTION__, ret);
 		return ret;
 	}
-
 	switch(ret)
 	{
 		case MM_ERROR_SOUND_INVALID_STATE:
-			result = AUDIO_IO_ERROR_INVALID_OPERATION;
-			LOGE("[%s] (0x%08x) : Not recording started yet.",(char*)__FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+			ret = AUDIO_IO_ERROR_INVALID_OPERATION;
+			LOGE("[%s] (0x%08x) : Not playing started yet.",(char*)__FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
 			break;
 		default:
-			result = __convert_error_code(ret, (char*)__FUNCTION__);
+			ret = __convert_error_code(ret, (char*)__FUNCTION__);
 			break;
 	}
-	return result;
+	return ret;
 }
 
-int audio_in_get_buffer_size(audio_in_h input, int *size)
+
+int audio_out_get_buffer_size(audio_out_h output, int *size)
 {
-	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(output);
 	AUDIO_IO_NULL_ARG_CHECK(size);
-	audio_in_s  * handle = (audio_in_s  *) input;
+	audio_out_s  * handle = (audio_out_s  *) output;
 	*size = handle->_buffer_size;
 	return AUDIO_IO_ERROR_NONE;
 }
 
-int audio_in_get_sample_rate(audio_in_h input, int *sample_rate)
+
+int audio_out_get_sample_rate(audio_out_h output, int *sample_rate)
 {
-	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(output);
 	AUDIO_IO_NULL_ARG_CHECK(sample_rate);
-	audio_in_s  * handle = (audio_in_s  *) input;
+	audio_out_s  * handle = (audio_out_s  *) output;
 	*sample_rate = handle->_sample_rate;
 	return AUDIO_IO_ERROR_NONE;
 }
 
 
-int audio_in_get_channel(audio_in_h input, audio_channel_e *channel)
+int audio_out_get_channel(audio_out_h output, audio_channel_e *channel)
 {
-	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(output);
 	AUDIO_IO_NULL_ARG_CHECK(channel);
-	audio_in_s  * handle = (audio_in_s  *) input;
+	audio_out_s  * handle = (audio_out_s  *) output;
 	*channel = handle->_channel;
 	return AUDIO_IO_ERROR_NONE;
 }
 
-int audio_in_get_sample_type(audio_in_h input, audio_sample_type_e *type)
+
+int audio_out_get_sample_type(audio_out_h output, audio_sample_type_e *type)
 {
-	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(output);
 	AUDIO_IO_NULL_ARG_CHECK(type);
-	audio_in_s  * handle = (audio_in_s  *) input;
+	audio_out_s  * handle = (audio_out_s  *) output;
 	*type = handle->_type;
 	return AUDIO_IO_ERROR_NONE;
 }
 
-int audio_out_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type,  audio_out_h* output)
+
+int audio_out_get_sound_type(audio_out_h output, sound_type_e *type)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
-	if(__check_parameter(sample_rate, channel, type)!=AUDIO_IO_ERROR_NONE)
-		return AUDIO_IO_ERROR_INVALID_PARAMETER;
-	if(sound_type < SOUND_TYPE_SYSTEM || sound_type > SOUND_TYPE_CALL)
-	{
-		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_PARAMETER(0x%08x) : Invalid sample sound type : %d" ,__FUNCTION__,AUDIO_IO_ERROR_INVALID_PARAMETER,sound_type );
-		return AUDIO_IO_ERROR_INVALID_PARAMETER;
-	}
-	
-	audio_out_s * handle;
-	handle = (audio_out_s*)malloc( sizeof(audio_out_s));
-	if (handle != NULL)
-		memset(handle, 0 , sizeof(audio_out_s));
-	else
+	AUDIO_IO_NULL_ARG_CHECK(type);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	*type = handle->_sound_type;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_set_stream_cb(audio_out_h output, audio_out_stream_cb callback, void *user_data)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_NULL_ARG_CHECK(callback);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(!handle->_stream_running && !handle->_nonblocking && handle->_player == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	handle->_stream_cb = callback;
+	handle->_stream_userdata = user_data;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_unset_stream_cb(audio_out_h output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(!handle->_stream_running && handle->_player == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	handle->_stream_cb = NULL;
+	handle->_stream_userdata = NULL;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_set_nonblocking(audio_out_h output, bool nonblocking)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	/* the drain thread starts and stops with the device, so a running handle keeps its mode */
+	AUDIO_IO_CHECK_CONDITION(!(handle->_prepared && !handle->_paused) && !handle->_drain_running && handle->_stream_cb == NULL && handle->_player == NULL,
+			AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	if (nonblocking == handle->_nonblocking)
+		return AUDIO_IO_ERROR_NONE;
+	if (handle->_mixer)
 	{
-		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
-		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+		/* a mixer voice always queues through its ring, only the blocking behaviour changes */
+		handle->_nonblocking = nonblocking;
+		return AUDIO_IO_ERROR_NONE;
 	}
-	int ret = mm_sound_pcm_play_open(&handle->mm_handle,sample_rate, channel, type, sound_type);
-	if( ret < 0)
+	if (nonblocking)
 	{
-			return __convert_error_code(ret, (char*)__FUNCTION__);
+		int ret = _audio_io_ring_create(&handle->_ring, handle->_period_size * handle->_period_count);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return ret;
+		}
+		sem_init(&handle->_ring_sem, 0, 0);
+		_audio_io_memlock_add(&handle->_memlock, handle->_ring, sizeof(audio_io_ring_s));
+		_audio_io_memlock_add(&handle->_memlock, handle->_ring->buffer, handle->_ring->size);
 	}
 	else
 	{
-		*output = (audio_out_h)handle;
-		handle->_buffer_size= ret;
-		handle->_sample_rate= sample_rate;
-		handle->_channel= channel;
-		handle->_type= type;
-		handle->_sound_type= sound_type;
-		return AUDIO_IO_ERROR_NONE;
+		sem_destroy(&handle->_ring_sem);
+		_audio_io_memlock_remove(&handle->_memlock, handle->_ring->buffer);
+		_audio_io_memlock_remove(&handle->_memlock, handle->_ring);
+		_audio_io_ring_destroy(handle->_ring);
+		handle->_ring = NULL;
 	}
+	handle->_nonblocking = nonblocking;
+	return AUDIO_IO_ERROR_NONE;
 }
 
-int audio_out_destroy(audio_out_h output)
+/* bytes of application data the non-blocking queue takes without blocking */
+static unsigned int __audio_out_get_writable(audio_out_s *handle)
+{
+	unsigned int frames = _audio_io_ring_writable(handle->_ring) / __get_frame_size(handle->_device_channel, handle->_device_type);
+	if (handle->_converter && handle->_converter->resampler)
+		frames = _audio_io_resampler_get_max_input(handle->_converter->resampler, frames);
+	return frames * __get_frame_size(handle->_channel, handle->_type);
+}
+
+int audio_out_get_writable_size(audio_out_h output, unsigned int *size)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_NULL_ARG_CHECK(size);
 	audio_out_s  * handle = (audio_out_s  *) output;
-	int ret = mm_sound_pcm_play_close(handle->mm_handle);
-	if (ret != MM_ERROR_NONE)
+	AUDIO_IO_CHECK_CONDITION(handle->_nonblocking, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret = __convert_thread_error(handle->_thread_error, (char*)__FUNCTION__);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	*size = __audio_out_get_writable(handle);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_acquire_buffer(audio_out_h output, void **buffer, unsigned int *length)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_NULL_ARG_CHECK(buffer);
+	AUDIO_IO_NULL_ARG_CHECK(length);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL && handle->_player == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	if (handle->_write_buffer == NULL)
 	{
-		return __convert_error_code(ret, (char*)__FUNCTION__);
+		handle->_write_buffer = _audio_io_pool_alloc(handle->_buffer_size);
+		if (handle->_write_buffer == NULL)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+		}
+		_audio_io_memlock_add(&handle->_memlock, handle->_write_buffer, handle->_buffer_size);
 	}
-	else
+	/* the drain thread only empties the queue, so what fits now still fits at the commit */
+	unsigned int size = handle->_buffer_size;
+	if (handle->_nonblocking)
 	{
-		free(handle);
-		return AUDIO_IO_ERROR_NONE;
+		int ret = __convert_thread_error(handle->_thread_error, (char*)__FUNCTION__);
+		if (ret != AUDIO_IO_ERROR_NONE)
+			return ret;
+		if (__audio_out_get_writable(handle) < size)
+			size = __audio_out_get_writable(handle);
+		AUDIO_IO_CHECK_CONDITION(size > 0, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
 	}
+	handle->_write_acquired = true;
+	handle->_write_length = size;
+	*buffer = handle->_write_buffer;
+	*length = size;
+	return AUDIO_IO_ERROR_NONE;
 }
 
-int audio_out_prepare(audio_out_h output)
+int audio_out_commit_buffer(audio_out_h output, unsigned int length)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
 	audio_out_s  * handle = (audio_out_s  *) output;
-	int ret = mm_sound_pcm_play_start(handle->mm_handle);
-	if (ret != MM_ERROR_NONE)
+	AUDIO_IO_CHECK_CONDITION(handle->_write_acquired, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	AUDIO_IO_CHECK_CONDITION(length <= handle->_write_length, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	handle->_write_acquired = false;
+	if (length == 0)
+		return 0;
+	return audio_out_write(output, handle->_write_buffer, length);
+}
+
+int audio_out_get_stats(audio_out_h output, audio_io_stats_s *stats)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_NULL_ARG_CHECK(stats);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	_audio_io_stats_get(&handle->_stats, stats);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_reset_stats(audio_out_h output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	_audio_io_stats_reset(&handle->_stats);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_get_latency(audio_out_h output, unsigned int *latency_us)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_NULL_ARG_CHECK(latency_us);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	*latency_us = __audio_out_get_pending_us(handle);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_get_position(audio_out_h output, unsigned long long *frames, struct timespec *timestamp)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_NULL_ARG_CHECK(frames);
+	AUDIO_IO_NULL_ARG_CHECK(timestamp);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	unsigned long long now = _audio_io_get_time_us();
+	*frames = __to_app_frames(__audio_out_get_played_frames(handle, now), handle->_sample_rate, handle->_device_rate);
+	__us_to_timespec(now, timestamp);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_write_planar(audio_out_h output, void **planes, unsigned int length)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_NULL_ARG_CHECK(planes);
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL && handle->_player == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret = __convert_thread_error(handle->_thread_error, (char*)__FUNCTION__);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	if (handle->_converter == NULL)
 	{
-		return __convert_error_code(ret, (char*)__FUNCTION__);
+		ret = __audio_out_create_converter(handle);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return ret;
+		}
+	}
+	ret = __audio_out_write_data(handle, NULL, planes, length);
+	if (handle->_nonblocking)
+	{
+		if (ret == 0 && length > 0)
+			return AUDIO_IO_ERROR_INVALID_OPERATION;
+		return ret;
+	}
+	if (ret > 0)
+	{
+		AUDIO_IO_LOGI_RATELIMITED("[%s] %d bytes per channel written" ,__FUNCTION__, ret);
+		return ret;
+	}
+	switch(ret)
+	{
+		case MM_ERROR_SOUND_INVALID_STATE:
+			LOGE("[%s] (0x%08x) : Not playing started yet.",(char*)__FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+			return AUDIO_IO_ERROR_INVALID_OPERATION;
+		default:
+			return __convert_error_code(ret, (char*)__FUNCTION__);
 	}
-	else
-		return AUDIO_IO_ERROR_NONE;
 }
 
-int audio_out_unprepare(audio_out_h output)
+int audio_out_set_resampler_quality(audio_out_h output, audio_io_resampler_quality_e quality)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_CHECK_CONDITION(quality >= AUDIO_IO_RESAMPLER_QUALITY_LOW && quality <= AUDIO_IO_RESAMPLER_QUALITY_HIGH, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
 	audio_out_s  * handle = (audio_out_s  *) output;
-	int ret = mm_sound_pcm_play_stop(handle->mm_handle);
-	if (ret != MM_ERROR_NONE)
+	AUDIO_IO_CHECK_CONDITION(!handle->_stream_running && !handle->_drain_running, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret;
+	if (handle->_converter && handle->_converter->resampler && quality != handle->_resampler_quality)
 	{
-		return __convert_error_code(ret, (char*)__FUNCTION__);
+		ret = _audio_io_converter_set_resampler(handle->_converter, handle->_sample_rate, handle->_device_rate, quality);
+		if (ret != AUDIO_IO_ERROR_NONE)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return ret;
+		}
 	}
-	else
-		return AUDIO_IO_ERROR_NONE;
+	handle->_resampler_quality = quality;
+	return AUDIO_IO_ERROR_NONE;
 }
 
+int audio_out_set_mix_gain(audio_out_h output, float gain)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_CHECK_CONDITION(gain >= 0.0f && gain <= 1.0f, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	audio_out_s  * handle = (audio_out_s  *) output;
+	AUDIO_IO_CHECK_CONDITION(handle->_mixer != NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	__atomic_store_n(&handle->_mix_gain, (int)(gain * AUDIO_IO_MIX_GAIN_UNITY + 0.5f), __ATOMIC_RELAXED);
+	return AUDIO_IO_ERROR_NONE;
+}
 
+int audio_out_prefill_handle_cache(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type, unsigned int count)
+{
+	if(__check_parameter(sample_rate, channel, type)!=AUDIO_IO_ERROR_NONE)
+		return AUDIO_IO_ERROR_INVALID_PARAMETER;
+	AUDIO_IO_CHECK_CONDITION(sound_type >= SOUND_TYPE_SYSTEM && sound_type <= SOUND_TYPE_CALL, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	AUDIO_IO_CHECK_CONDITION(_audio_io_cache_enabled(), AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	const char *path;
+	const audio_io_backend_s *backend = _audio_io_backend_select(NULL, AUDIO_IO_DIRECTION_OUT, &path);
+	int ret = _audio_io_cache_prefill(backend, AUDIO_IO_DIRECTION_OUT, __get_device_rate(sample_rate), __get_device_channel(channel),
+			__get_device_sample_type(type), sound_type, path, count);
+	if (ret != MM_ERROR_NONE)
+		return __convert_error_code(ret, (char*)__FUNCTION__);
+	return AUDIO_IO_ERROR_NONE;
+}
 
-int audio_out_write(audio_out_h output, void* buffer, unsigned int length)
+int audio_out_writev(audio_out_h output, const struct iovec *iov, int iovcnt)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
-	AUDIO_IO_NULL_ARG_CHECK(buffer);
+	AUDIO_IO_NULL_ARG_CHECK(iov);
+	AUDIO_IO_CHECK_CONDITION(iovcnt > 0, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
 	audio_out_s  * handle = (audio_out_s  *) output;
-	int ret;
-	ret = mm_sound_pcm_play_write(handle->mm_handle, (void*) buffer, length);
-	if (ret >0)
+	AUDIO_IO_CHECK_CONDITION(handle->_stream_cb == NULL && handle->_player == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	AUDIO_IO_CHECK_CONDITION(!handle->_paused || handle->_nonblocking, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	unsigned int length = 0;
+	int i;
+	int ret = __convert_thread_error(handle->_thread_error, (char*)__FUNCTION__);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	for (i = 0; i < iovcnt; i++)
 	{
-		LOGI("[%s] %d bytes written" ,__FUNCTION__, ret);
+		AUDIO_IO_CHECK_CONDITION(iov[i].iov_base != NULL || iov[i].iov_len == 0, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+		length += iov[i].iov_len;
+	}
+	if (handle->_vector_buffer == NULL)
+	{
+		handle->_vector_buffer = _audio_io_pool_alloc(handle->_buffer_size);
+		if (handle->_vector_buffer == NULL)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+		}
+		_audio_io_memlock_add(&handle->_memlock, handle->_vector_buffer, handle->_buffer_size);
+	}
+	ret = __audio_out_writev_data(handle, iov, iovcnt);
+	if (handle->_nonblocking)
+	{
+		if (ret == 0 && length >= (unsigned int)__get_frame_size(handle->_channel, handle->_type))
+			return AUDIO_IO_ERROR_INVALID_OPERATION;
+		return ret;
+	}
+	if (ret >= 0)
+	{
+		AUDIO_IO_LOGI_RATELIMITED("[%s] %d bytes written from %d segments" ,__FUNCTION__, ret, iovcnt);
 		return ret;
 	}
 	switch(ret)
@@ -348,52 +2298,61 @@ int audio_out_write(audio_out_h output, void* buffer, unsigned int length)
 	return ret;
 }
 
-
-int audio_out_get_buffer_size(audio_out_h output, int *size)
+int audio_out_set_volume(audio_out_h output, float gain, unsigned int ramp_ms)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
-	AUDIO_IO_NULL_ARG_CHECK(size);
+	AUDIO_IO_CHECK_CONDITION(gain >= 0.0f && gain <= AUDIO_IO_MAX_VOLUME, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	AUDIO_IO_CHECK_CONDITION(ramp_ms <= AUDIO_IO_MAX_VOLUME_RAMP_MS, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
 	audio_out_s  * handle = (audio_out_s  *) output;
-	*size = handle->_buffer_size;
+	/* unconverted data is scaled into the bounce buffer, which must exist before the gain takes effect */
+	if (handle->_convert_buffer == NULL)
+	{
+		void *buffer = _audio_io_pool_alloc(handle->_period_size);
+		if (buffer == NULL)
+		{
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)" ,__FUNCTION__,AUDIO_IO_ERROR_OUT_OF_MEMORY );
+			return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+		}
+		handle->_convert_buffer = buffer;
+		_audio_io_memlock_add(&handle->_memlock, buffer, handle->_period_size);
+	}
+	_audio_io_gain_set(&handle->_gain, gain, (unsigned long long)ramp_ms * handle->_device_rate / 1000);
 	return AUDIO_IO_ERROR_NONE;
 }
 
-
-int audio_out_get_sample_rate(audio_out_h output, int *sample_rate)
+int audio_out_get_volume(audio_out_h output, float *gain)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
-	AUDIO_IO_NULL_ARG_CHECK(sample_rate);
+	AUDIO_IO_NULL_ARG_CHECK(gain);
 	audio_out_s  * handle = (audio_out_s  *) output;
-	*sample_rate = handle->_sample_rate;
+	*gain = _audio_io_gain_get(&handle->_gain);
 	return AUDIO_IO_ERROR_NONE;
 }
 
-
-int audio_out_get_channel(audio_out_h output, audio_channel_e *channel)
+int audio_out_get_realtime_status(audio_out_h output, audio_io_realtime_status_s *status)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
-	AUDIO_IO_NULL_ARG_CHECK(channel);
+	AUDIO_IO_NULL_ARG_CHECK(status);
 	audio_out_s  * handle = (audio_out_s  *) output;
-	*channel = handle->_channel;
+	/* a mixed output is fed by the mixer thread */
+	_audio_io_realtime_status_get(handle->_mixer ? &handle->_mixer->granted : &handle->_thread_granted, &handle->_memlock, status);
 	return AUDIO_IO_ERROR_NONE;
 }
 
-
-int audio_out_get_sample_type(audio_out_h output, audio_sample_type_e *type)
+int audio_out_buffer_alloc(audio_out_h output, unsigned int periods, void **buffer, unsigned int *size)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
-	AUDIO_IO_NULL_ARG_CHECK(type);
+	AUDIO_IO_NULL_ARG_CHECK(buffer);
+	AUDIO_IO_NULL_ARG_CHECK(size);
 	audio_out_s  * handle = (audio_out_s  *) output;
-	*type = handle->_type;
-	return AUDIO_IO_ERROR_NONE;
+	return __buffer_alloc(handle->_buffer_size, periods, buffer, size);
 }
 
-
-int audio_out_get_sound_type(audio_out_h output, sound_type_e *type)
+int audio_out_set_volume_ramp(audio_out_h output, audio_io_volume_ramp_e ramp)
 {
 	AUDIO_IO_NULL_ARG_CHECK(output);
-	AUDIO_IO_NULL_ARG_CHECK(type);
+	AUDIO_IO_CHECK_CONDITION(ramp >= AUDIO_IO_VOLUME_RAMP_LINEAR && ramp <= AUDIO_IO_VOLUME_RAMP_EXPONENTIAL, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
 	audio_out_s  * handle = (audio_out_s  *) output;
-	*type = handle->_sound_type;
+	_audio_io_gain_set_ramp(&handle->_gain, ramp);
 	return AUDIO_IO_ERROR_NONE;
 }
@@ -0,0 +1,155 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <audio_io_private.h>
+
+int audio_io_attr_create(audio_io_attr_h *attr)
+{
+	audio_io_attr_s *handle;
+
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	handle = (audio_io_attr_s *)malloc(sizeof(audio_io_attr_s));
+	if (handle == NULL) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)", __FUNCTION__, AUDIO_IO_ERROR_OUT_OF_MEMORY);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	memset(handle, 0, sizeof(audio_io_attr_s));
+	handle->latency_class = AUDIO_IO_LATENCY_CLASS_DEFAULT;
+	*attr = (audio_io_attr_h)handle;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_destroy(audio_io_attr_h attr)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	free(attr->backend_path);
+	free(attr);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_set_latency_class(audio_io_attr_h attr, audio_io_latency_class_e latency_class)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	AUDIO_IO_CHECK_CONDITION(latency_class >= AUDIO_IO_LATENCY_CLASS_DEFAULT && latency_class <= AUDIO_IO_LATENCY_CLASS_POWER_SAVING,
+		AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	attr->latency_class = latency_class;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_get_latency_class(audio_io_attr_h attr, audio_io_latency_class_e *latency_class)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	AUDIO_IO_NULL_ARG_CHECK(latency_class);
+	*latency_class = attr->latency_class;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_set_period_size(audio_io_attr_h attr, unsigned int period_size)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	attr->period_size = period_size;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_get_period_size(audio_io_attr_h attr, unsigned int *period_size)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	AUDIO_IO_NULL_ARG_CHECK(period_size);
+	*period_size = attr->period_size;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_set_period_count(audio_io_attr_h attr, unsigned int period_count)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	attr->period_count = period_count;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_get_period_count(audio_io_attr_h attr, unsigned int *period_count)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	AUDIO_IO_NULL_ARG_CHECK(period_count);
+	*period_count = attr->period_count;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_set_backend(audio_io_attr_h attr, audio_io_backend_e backend, const char *path)
+{
+	char *copy = NULL;
+
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	AUDIO_IO_CHECK_CONDITION(backend >= AUDIO_IO_BACKEND_DEFAULT && backend <= AUDIO_IO_BACKEND_LOOPBACK,
+		AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	if (path != NULL) {
+		copy = strdup(path);
+		if (copy == NULL) {
+			LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)", __FUNCTION__, AUDIO_IO_ERROR_OUT_OF_MEMORY);
+			return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+		}
+	}
+	free(attr->backend_path);
+	attr->backend = backend;
+	attr->backend_path = copy;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_get_backend(audio_io_attr_h attr, audio_io_backend_e *backend)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	AUDIO_IO_NULL_ARG_CHECK(backend);
+	*backend = attr->backend;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_set_thread_policy(audio_io_attr_h attr, audio_io_thread_policy_e policy, int priority, unsigned long long cpu_mask)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	AUDIO_IO_CHECK_CONDITION(_audio_io_thread_policy_is_valid(policy, priority), AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	_audio_io_thread_policy_init(&attr->thread_policy, policy, priority, cpu_mask);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_get_thread_policy(audio_io_attr_h attr, audio_io_thread_policy_e *policy, int *priority, unsigned long long *cpu_mask)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	if (!attr->thread_policy.is_set)
+		return audio_io_get_thread_policy(policy, priority, cpu_mask);
+	AUDIO_IO_NULL_ARG_CHECK(policy);
+	AUDIO_IO_NULL_ARG_CHECK(priority);
+	AUDIO_IO_NULL_ARG_CHECK(cpu_mask);
+	*policy = attr->thread_policy.policy;
+	*priority = attr->thread_policy.priority;
+	*cpu_mask = attr->thread_policy.cpu_mask;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_set_memory_lock(audio_io_attr_h attr, bool lock)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	attr->memory_lock = lock;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_attr_get_memory_lock(audio_io_attr_h attr, bool *lock)
+{
+	AUDIO_IO_NULL_ARG_CHECK(attr);
+	AUDIO_IO_NULL_ARG_CHECK(lock);
+	*lock = attr->memory_lock;
+	return AUDIO_IO_ERROR_NONE;
+}
@@ -0,0 +1,206 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <mm.h>
+#include <audio_io_private.h>
+
+#define AUDIO_IO_BACKEND_ENV		"AUDIO_IO_BACKEND"
+#define AUDIO_IO_BACKEND_IN_PATH_ENV	"AUDIO_IO_BACKEND_IN_PATH"
+#define AUDIO_IO_BACKEND_OUT_PATH_ENV	"AUDIO_IO_BACKEND_OUT_PATH"
+
+static const audio_io_backend_s *__default_backend = &_audio_io_backend_mm_sound;
+
+static const audio_io_backend_s *__backends[] = {
+	&_audio_io_backend_mm_sound,
+	&_audio_io_backend_null,
+	&_audio_io_backend_file,
+	&_audio_io_backend_loopback,
+};
+
+__attribute__((constructor))
+static void __audio_io_backend_init(void)
+{
+	const char *env = getenv(AUDIO_IO_BACKEND_ENV);
+	int i;
+
+	if (env == NULL)
+		return;
+	for (i = 0; i < (int)(sizeof(__backends) / sizeof(__backends[0])); i++) {
+		if (strcasecmp(env, __backends[i]->name) == 0) {
+			__default_backend = __backends[i];
+			return;
+		}
+	}
+	AUDIO_IO_LOGW("[%s] Unknown %s value : %s", __FUNCTION__, AUDIO_IO_BACKEND_ENV, env);
+}
+
+/*
+* Returns the backend of a handle created with @attr, which may be NULL, and sets @path to the file
+* or loopback name it uses, or NULL when neither the attribute nor the environment names one.
+*/
+const audio_io_backend_s *_audio_io_backend_select(const audio_io_attr_s *attr, audio_io_direction_e direction, const char **path)
+{
+	if (attr != NULL && attr->backend_path != NULL)
+		*path = attr->backend_path;
+	else
+		*path = getenv(direction == AUDIO_IO_DIRECTION_IN ? AUDIO_IO_BACKEND_IN_PATH_ENV : AUDIO_IO_BACKEND_OUT_PATH_ENV);
+
+	if (attr == NULL || attr->backend == AUDIO_IO_BACKEND_DEFAULT)
+		return __default_backend;
+	return __backends[attr->backend - AUDIO_IO_BACKEND_MM_SOUND];
+}
+
+/* device buffer size in bytes of the backends that have no device of their own */
+int _audio_io_backend_get_buffer_size(int rate, audio_channel_e channel, audio_sample_type_e type)
+{
+	return rate * AUDIO_IO_BACKEND_PERIOD_MS / 1000 * _audio_io_get_channel_count(channel) * _audio_io_get_sample_size(type);
+}
+
+void _audio_io_backend_fill_silence(audio_sample_type_e type, void *buffer, unsigned int length)
+{
+	memset(buffer, type == AUDIO_SAMPLE_TYPE_U8 ? 0x80 : 0, length);
+}
+
+/*
+* mm-sound backend
+*/
+static int __mm_sound_open(void **stream, audio_io_direction_e direction, int rate, audio_channel_e channel, audio_sample_type_e type,
+		sound_type_e sound_type, const char *path)
+{
+	MMSoundPcmHandle_t mm_handle;
+	int ret;
+
+	if (direction == AUDIO_IO_DIRECTION_IN)
+		ret = mm_sound_pcm_capture_open(&mm_handle, rate, channel, type);
+	else
+		ret = mm_sound_pcm_play_open(&mm_handle, rate, channel, type, sound_type);
+	if (ret >= 0)
+		*stream = mm_handle;
+	return ret;
+}
+
+static int __mm_sound_start(void *stream, audio_io_direction_e direction)
+{
+	if (direction == AUDIO_IO_DIRECTION_IN)
+		return mm_sound_pcm_capture_start(stream);
+	return mm_sound_pcm_play_start(stream);
+}
+
+static int __mm_sound_stop(void *stream, audio_io_direction_e direction)
+{
+	if (direction == AUDIO_IO_DIRECTION_IN)
+		return mm_sound_pcm_capture_stop(stream);
+	return mm_sound_pcm_play_stop(stream);
+}
+
+static int __mm_sound_read(void *stream, void *buffer, unsigned int length)
+{
+	return mm_sound_pcm_capture_read(stream, buffer, length);
+}
+
+static int __mm_sound_write(void *stream, void *buffer, unsigned int length)
+{
+	return mm_sound_pcm_play_write(stream, buffer, length);
+}
+
+static int __mm_sound_close(void *stream, audio_io_direction_e direction)
+{
+	if (direction == AUDIO_IO_DIRECTION_IN)
+		return mm_sound_pcm_capture_close(stream);
+	return mm_sound_pcm_play_close(stream);
+}
+
+const audio_io_backend_s _audio_io_backend_mm_sound = {
+	.name = "mm-sound",
+	.cacheable = true,
+	.open = __mm_sound_open,
+	.start = __mm_sound_start,
+	.stop = __mm_sound_stop,
+	.read = __mm_sound_read,
+	.write = __mm_sound_write,
+	.close = __mm_sound_close,
+};
+
+/*
+* Null backend : output is discarded and input is silence, without pacing, so that a handle runs
+* as fast as the library and the application can move the data.
+*/
+typedef struct {
+	audio_sample_type_e type;
+	volatile int started;
+} audio_io_null_stream_s;
+
+static int __null_open(void **stream, audio_io_direction_e direction, int rate, audio_channel_e channel, audio_sample_type_e type,
+		sound_type_e sound_type, const char *path)
+{
+	audio_io_null_stream_s *s;
+
+	s = (audio_io_null_stream_s *)calloc(1, sizeof(audio_io_null_stream_s));
+	if (s == NULL)
+		return MM_ERROR_SOUND_INTERNAL;
+	s->type = type;
+	*stream = s;
+	return _audio_io_backend_get_buffer_size(rate, channel, type);
+}
+
+static int __null_start(void *stream, audio_io_direction_e direction)
+{
+	((audio_io_null_stream_s *)stream)->started = 1;
+	return MM_ERROR_NONE;
+}
+
+static int __null_stop(void *stream, audio_io_direction_e direction)
+{
+	((audio_io_null_stream_s *)stream)->started = 0;
+	return MM_ERROR_NONE;
+}
+
+static int __null_read(void *stream, void *buffer, unsigned int length)
+{
+	audio_io_null_stream_s *s = (audio_io_null_stream_s *)stream;
+
+	if (!s->started)
+		return MM_ERROR_SOUND_INVALID_STATE;
+	_audio_io_backend_fill_silence(s->type, buffer, length);
+	return length;
+}
+
+static int __null_write(void *stream, void *buffer, unsigned int length)
+{
+	if (!((audio_io_null_stream_s *)stream)->started)
+		return MM_ERROR_SOUND_INVALID_STATE;
+	return length;
+}
+
+static int __null_close(void *stream, audio_io_direction_e direction)
+{
+	free(stream);
+	return MM_ERROR_NONE;
+}
+
+const audio_io_backend_s _audio_io_backend_null = {
+	.name = "null",
+	.cacheable = false,
+	.open = __null_open,
+	.start = __null_start,
+	.stop = __null_stop,
+	.read = __null_read,
+	.write = __null_write,
+	.close = __null_close,
+};
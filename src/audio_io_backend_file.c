@@ -0,0 +1,285 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mm.h>
+#include <audio_io_private.h>
+
+/*
+* File backend : output is appended to a canonical 44 byte header WAV file, whose sizes are written
+* on every stop so that the file stays readable while the handle lives. Input reads the data chunk
+* of a PCM or float WAV file in the device format and continues with silence at its end.
+* Neither direction is paced.
+*/
+#define WAV_FORMAT_PCM			0x0001
+#define WAV_FORMAT_IEEE_FLOAT		0x0003
+#define WAV_FORMAT_EXTENSIBLE		0xfffe
+
+typedef struct {
+	FILE *fp;
+	audio_sample_type_e type;
+	int rate;
+	int channels;
+	unsigned long long data_size;	/* bytes written, or left to read; reads stay within the 32-bit chunk size */
+	volatile int started;
+} audio_io_file_stream_s;
+
+static void __put_le16(unsigned char *p, unsigned int v)
+{
+	p[0] = v & 0xff;
+	p[1] = (v >> 8) & 0xff;
+}
+
+static void __put_le32(unsigned char *p, unsigned int v)
+{
+	__put_le16(p, v & 0xffff);
+	__put_le16(p + 2, v >> 16);
+}
+
+static unsigned int __get_le16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static unsigned int __get_le32(const unsigned char *p)
+{
+	return __get_le16(p) | (__get_le16(p + 2) << 16);
+}
+
+/* fills a canonical header for @data_size bytes of @type samples; data beyond 4 GB leaves the sizes at their maximum */
+void _audio_io_wav_fill_header(unsigned char *header, audio_sample_type_e type, int channels, int rate, unsigned long long data_size)
+{
+	int sample_size = _audio_io_get_sample_size(type);
+	unsigned int size = data_size > 0xffffffffULL - (AUDIO_IO_WAV_HEADER_SIZE - 8) ?
+			0xffffffffU - (AUDIO_IO_WAV_HEADER_SIZE - 8) : (unsigned int)data_size;
+
+	memcpy(header, "RIFF", 4);
+	__put_le32(header + 4, AUDIO_IO_WAV_HEADER_SIZE - 8 + size);
+	memcpy(header + 8, "WAVEfmt ", 8);
+	__put_le32(header + 16, 16);
+	__put_le16(header + 20, type == AUDIO_SAMPLE_TYPE_FLOAT32_LE ? WAV_FORMAT_IEEE_FLOAT : WAV_FORMAT_PCM);
+	__put_le16(header + 22, channels);
+	__put_le32(header + 24, rate);
+	__put_le32(header + 28, rate * channels * sample_size);
+	__put_le16(header + 32, channels * sample_size);
+	__put_le16(header + 34, sample_size * 8);
+	memcpy(header + 36, "data", 4);
+	__put_le32(header + 40, size);
+}
+
+/*
+* Finds the data chunk of a WAV file read through @read, and checks that it holds PCM or IEEE float
+* samples of @type, @channels and @rate; an extensible file is taken by its subformat.
+* Returns an mm-sound error that tells what does not match.
+*/
+int _audio_io_wav_parse(audio_io_wav_read_cb read, void *source, const char *path, audio_sample_type_e type, int channels, int rate,
+		unsigned long long *data_offset, unsigned int *data_size)
+{
+	unsigned char chunk[12];
+	unsigned char fmt[26];
+	unsigned long long pos;
+	unsigned int length;
+	unsigned int size;
+	unsigned int tag;
+	bool has_format = false;
+
+	if (read(source, 0, chunk, 12) != 12 || memcmp(chunk, "RIFF", 4) != 0 || memcmp(chunk + 8, "WAVE", 4) != 0) {
+		LOGE("[%s] %s is not a WAV file", __FUNCTION__, path);
+		return MM_ERROR_SOUND_DEVICE_INVALID_FORMAT;
+	}
+
+	/* chunks are padded to an even size */
+	for (pos = 12; read(source, pos, chunk, 8) == 8; pos += 8ULL + size + (size & 1)) {
+		size = __get_le32(chunk + 4);
+		if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+			length = size < sizeof(fmt) ? size : sizeof(fmt);
+			if ((unsigned int)read(source, pos + 8, fmt, length) != length)
+				break;
+			tag = __get_le16(fmt);
+			if (tag == WAV_FORMAT_EXTENSIBLE && length >= 26)
+				tag = __get_le16(fmt + 24);
+			if ((tag != WAV_FORMAT_PCM && tag != WAV_FORMAT_IEEE_FLOAT) || (tag == WAV_FORMAT_IEEE_FLOAT) != (type == AUDIO_SAMPLE_TYPE_FLOAT32_LE)) {
+				LOGE("[%s] %s holds samples of format %u", __FUNCTION__, path, tag);
+				return MM_ERROR_SOUND_DEVICE_INVALID_FORMAT;
+			}
+			if ((int)__get_le16(fmt + 2) != channels) {
+				LOGE("[%s] %s has %u channels, not %d", __FUNCTION__, path, __get_le16(fmt + 2), channels);
+				return MM_ERROR_SOUND_DEVICE_INVALID_CHANNEL;
+			}
+			if ((int)__get_le32(fmt + 4) != rate) {
+				LOGE("[%s] %s is sampled at %u Hz, not %d Hz", __FUNCTION__, path, __get_le32(fmt + 4), rate);
+				return MM_ERROR_SOUND_DEVICE_INVALID_SAMPLERATE;
+			}
+			if ((int)__get_le16(fmt + 14) != _audio_io_get_sample_size(type) * 8) {
+				LOGE("[%s] %s has %u bit samples", __FUNCTION__, path, __get_le16(fmt + 14));
+				return MM_ERROR_SOUND_DEVICE_INVALID_FORMAT;
+			}
+			has_format = true;
+		} else if (memcmp(chunk, "data", 4) == 0 && has_format) {
+			*data_offset = pos + 8;
+			*data_size = size;
+			return MM_ERROR_NONE;
+		}
+	}
+	LOGE("[%s] %s has no sample data", __FUNCTION__, path);
+	return MM_ERROR_SOUND_DEVICE_INVALID_FORMAT;
+}
+
+/* writes the header for the data written so far and returns to the end of the file */
+static int __write_header(audio_io_file_stream_s *s)
+{
+	unsigned char header[AUDIO_IO_WAV_HEADER_SIZE];
+
+	_audio_io_wav_fill_header(header, s->type, s->channels, s->rate, s->data_size);
+	if (fseek(s->fp, 0, SEEK_SET) != 0 || fwrite(header, 1, AUDIO_IO_WAV_HEADER_SIZE, s->fp) != AUDIO_IO_WAV_HEADER_SIZE ||
+		fseek(s->fp, 0, SEEK_END) != 0 || fflush(s->fp) != 0)
+		return MM_ERROR_SOUND_INTERNAL;
+	return MM_ERROR_NONE;
+}
+
+static int __read_at(void *source, unsigned long long offset, void *buffer, unsigned int length)
+{
+	FILE *fp = (FILE *)source;
+
+	if (fseeko(fp, offset, SEEK_SET) != 0)
+		return 0;
+	return fread(buffer, 1, length, fp);
+}
+
+/* checks the format chunk and leaves the file at the start of the data chunk */
+static int __read_header(audio_io_file_stream_s *s, const char *path)
+{
+	unsigned long long data_offset;
+	unsigned int data_size;
+	int ret;
+
+	ret = _audio_io_wav_parse(__read_at, s->fp, path, s->type, s->channels, s->rate, &data_offset, &data_size);
+	if (ret != MM_ERROR_NONE)
+		return ret;
+	if (fseeko(s->fp, data_offset, SEEK_SET) != 0)
+		return MM_ERROR_SOUND_DEVICE_INVALID_FORMAT;
+	s->data_size = data_size;
+	return MM_ERROR_NONE;
+}
+
+static int __file_open(void **stream, audio_io_direction_e direction, int rate, audio_channel_e channel, audio_sample_type_e type,
+		sound_type_e sound_type, const char *path)
+{
+	audio_io_file_stream_s *s;
+	int ret;
+
+	if (path == NULL) {
+		LOGE("[%s] no file was given to the file backend", __FUNCTION__);
+		return MM_ERROR_SOUND_DEVICE_NOT_OPENED;
+	}
+	s = (audio_io_file_stream_s *)calloc(1, sizeof(audio_io_file_stream_s));
+	if (s == NULL)
+		return MM_ERROR_SOUND_INTERNAL;
+	s->type = type;
+	s->rate = rate;
+	s->channels = _audio_io_get_channel_count(channel);
+
+	s->fp = fopen(path, direction == AUDIO_IO_DIRECTION_IN ? "rb" : "wb");
+	if (s->fp == NULL) {
+		LOGE("[%s] failed to open %s", __FUNCTION__, path);
+		free(s);
+		return MM_ERROR_SOUND_DEVICE_NOT_OPENED;
+	}
+	if (direction == AUDIO_IO_DIRECTION_IN)
+		ret = __read_header(s, path);
+	else
+		ret = __write_header(s);
+	if (ret != MM_ERROR_NONE) {
+		fclose(s->fp);
+		free(s);
+		return ret;
+	}
+	*stream = s;
+	return _audio_io_backend_get_buffer_size(rate, channel, type);
+}
+
+static int __file_start(void *stream, audio_io_direction_e direction)
+{
+	((audio_io_file_stream_s *)stream)->started = 1;
+	return MM_ERROR_NONE;
+}
+
+static int __file_stop(void *stream, audio_io_direction_e direction)
+{
+	audio_io_file_stream_s *s = (audio_io_file_stream_s *)stream;
+
+	s->started = 0;
+	if (direction == AUDIO_IO_DIRECTION_OUT)
+		return __write_header(s);
+	return MM_ERROR_NONE;
+}
+
+static int __file_read(void *stream, void *buffer, unsigned int length)
+{
+	audio_io_file_stream_s *s = (audio_io_file_stream_s *)stream;
+	unsigned int n = length < s->data_size ? length : (unsigned int)s->data_size;
+
+	if (!s->started)
+		return MM_ERROR_SOUND_INVALID_STATE;
+	if (n > 0) {
+		n = fread(buffer, 1, n, s->fp);
+		/* a truncated data chunk ends the file */
+		s->data_size = n > 0 ? s->data_size - n : 0;
+	}
+	if (n < length)
+		_audio_io_backend_fill_silence(s->type, (char *)buffer + n, length - n);
+	return length;
+}
+
+static int __file_write(void *stream, void *buffer, unsigned int length)
+{
+	audio_io_file_stream_s *s = (audio_io_file_stream_s *)stream;
+
+	if (!s->started)
+		return MM_ERROR_SOUND_INVALID_STATE;
+	if (buffer == NULL)
+		return MM_ERROR_SOUND_INVALID_POINTER;
+	if (fwrite(buffer, 1, length, s->fp) != length)
+		return MM_ERROR_SOUND_INTERNAL;
+	s->data_size += length;
+	return length;
+}
+
+static int __file_close(void *stream, audio_io_direction_e direction)
+{
+	audio_io_file_stream_s *s = (audio_io_file_stream_s *)stream;
+	int ret = MM_ERROR_NONE;
+
+	if (direction == AUDIO_IO_DIRECTION_OUT)
+		ret = __write_header(s);
+	if (fclose(s->fp) != 0 && ret == MM_ERROR_NONE)
+		ret = MM_ERROR_SOUND_INTERNAL;
+	free(s);
+	return ret;
+}
+
+const audio_io_backend_s _audio_io_backend_file = {
+	.name = "file",
+	.cacheable = false,
+	.open = __file_open,
+	.start = __file_start,
+	.stop = __file_stop,
+	.read = __file_read,
+	.write = __file_write,
+	.close = __file_close,
+};
@@ -0,0 +1,267 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <mm.h>
+#include <audio_io_private.h>
+
+/*
+* Loopback backend : an output stream and an input stream opened with the same name share a ring
+* of AUDIO_IO_RING_PERIODS device buffers. The writer blocks while the ring is full and the reader
+* is capturing, and drops its data while nobody captures. The reader waits up to the duration of the
+* data it asked for and fills what did not arrive by then with silence, so that capture keeps the
+* device rate when nothing plays.
+* Loopbacks are looked up by name under a process-wide lock; data moves under the loopback's own lock.
+*/
+#define AUDIO_IO_LOOPBACK_DEFAULT_NAME	"default"
+
+typedef struct _audio_io_loopback_s{
+	char *name;
+	int rate;
+	audio_channel_e channel;
+	audio_sample_type_e type;
+	bool has_writer;
+	bool has_reader;
+	bool writer_started;
+	bool reader_started;
+	audio_io_ring_s *ring;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	struct _audio_io_loopback_s *next;
+} audio_io_loopback_s;
+
+typedef struct {
+	audio_io_loopback_s *loopback;
+	audio_io_direction_e direction;
+} audio_io_loopback_stream_s;
+
+static pthread_mutex_t __lock = PTHREAD_MUTEX_INITIALIZER;
+static audio_io_loopback_s *__loopbacks;
+
+static void __free_loopback(audio_io_loopback_s *lb)
+{
+	pthread_cond_destroy(&lb->cond);
+	pthread_mutex_destroy(&lb->lock);
+	_audio_io_ring_destroy(lb->ring);
+	free(lb->name);
+	free(lb);
+}
+
+/* creates a loopback with the format of its first stream, called with the lock held */
+static audio_io_loopback_s *__create_loopback(const char *name, int rate, audio_channel_e channel, audio_sample_type_e type)
+{
+	audio_io_loopback_s *lb;
+	pthread_condattr_t attr;
+
+	lb = (audio_io_loopback_s *)calloc(1, sizeof(audio_io_loopback_s));
+	if (lb == NULL)
+		return NULL;
+	lb->name = strdup(name);
+	if (lb->name == NULL ||
+		_audio_io_ring_create(&lb->ring, _audio_io_backend_get_buffer_size(rate, channel, type) * AUDIO_IO_RING_PERIODS) != AUDIO_IO_ERROR_NONE) {
+		free(lb->name);
+		free(lb);
+		return NULL;
+	}
+	lb->rate = rate;
+	lb->channel = channel;
+	lb->type = type;
+	pthread_mutex_init(&lb->lock, NULL);
+	/* the reader waits on a monotonic deadline */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&lb->cond, &attr);
+	pthread_condattr_destroy(&attr);
+	lb->next = __loopbacks;
+	__loopbacks = lb;
+	return lb;
+}
+
+static int __loopback_open(void **stream, audio_io_direction_e direction, int rate, audio_channel_e channel, audio_sample_type_e type,
+		sound_type_e sound_type, const char *path)
+{
+	const char *name = path != NULL ? path : AUDIO_IO_LOOPBACK_DEFAULT_NAME;
+	audio_io_loopback_stream_s *s;
+	audio_io_loopback_s *lb;
+
+	s = (audio_io_loopback_stream_s *)malloc(sizeof(audio_io_loopback_stream_s));
+	if (s == NULL)
+		return MM_ERROR_SOUND_INTERNAL;
+
+	pthread_mutex_lock(&__lock);
+	for (lb = __loopbacks; lb != NULL; lb = lb->next) {
+		if (strcmp(lb->name, name) == 0)
+			break;
+	}
+	if (lb == NULL) {
+		lb = __create_loopback(name, rate, channel, type);
+		if (lb == NULL) {
+			pthread_mutex_unlock(&__lock);
+			free(s);
+			return MM_ERROR_SOUND_INTERNAL;
+		}
+	} else if (lb->rate != rate || lb->channel != channel || lb->type != type) {
+		pthread_mutex_unlock(&__lock);
+		free(s);
+		LOGE("[%s] loopback %s has another format", __FUNCTION__, name);
+		return MM_ERROR_SOUND_DEVICE_INVALID_FORMAT;
+	}
+	if (direction == AUDIO_IO_DIRECTION_IN ? lb->has_reader : lb->has_writer) {
+		pthread_mutex_unlock(&__lock);
+		free(s);
+		LOGE("[%s] loopback %s already has an %s stream", __FUNCTION__, name, direction == AUDIO_IO_DIRECTION_IN ? "input" : "output");
+		return MM_ERROR_SOUND_DEVICE_NOT_OPENED;
+	}
+	/* the flags change under both locks, so that either one is enough to read them */
+	pthread_mutex_lock(&lb->lock);
+	if (direction == AUDIO_IO_DIRECTION_IN)
+		lb->has_reader = true;
+	else
+		lb->has_writer = true;
+	pthread_mutex_unlock(&lb->lock);
+	pthread_mutex_unlock(&__lock);
+
+	s->loopback = lb;
+	s->direction = direction;
+	*stream = s;
+	return _audio_io_backend_get_buffer_size(rate, channel, type);
+}
+
+static int __loopback_set_started(void *stream, audio_io_direction_e direction, bool started)
+{
+	audio_io_loopback_s *lb = ((audio_io_loopback_stream_s *)stream)->loopback;
+
+	pthread_mutex_lock(&lb->lock);
+	if (direction == AUDIO_IO_DIRECTION_IN) {
+		/* capture starts with what is played from now on */
+		if (started && !lb->reader_started)
+			_audio_io_ring_reset(lb->ring);
+		lb->reader_started = started;
+	} else {
+		lb->writer_started = started;
+	}
+	pthread_cond_broadcast(&lb->cond);
+	pthread_mutex_unlock(&lb->lock);
+	return MM_ERROR_NONE;
+}
+
+static int __loopback_start(void *stream, audio_io_direction_e direction)
+{
+	return __loopback_set_started(stream, direction, true);
+}
+
+static int __loopback_stop(void *stream, audio_io_direction_e direction)
+{
+	return __loopback_set_started(stream, direction, false);
+}
+
+static int __loopback_read(void *stream, void *buffer, unsigned int length)
+{
+	audio_io_loopback_s *lb = ((audio_io_loopback_stream_s *)stream)->loopback;
+	int frame_size = _audio_io_get_channel_count(lb->channel) * _audio_io_get_sample_size(lb->type);
+	unsigned long long deadline = _audio_io_get_time_us() + (unsigned long long)(length / frame_size) * 1000000ULL / lb->rate;
+	unsigned int done = 0;
+	struct timespec ts;
+
+	ts.tv_sec = deadline / 1000000ULL;
+	ts.tv_nsec = (deadline % 1000000ULL) * 1000;
+
+	pthread_mutex_lock(&lb->lock);
+	while (lb->reader_started) {
+		done += _audio_io_ring_read(lb->ring, (char *)buffer + done, length - done);
+		pthread_cond_broadcast(&lb->cond);
+		if (done == length || pthread_cond_timedwait(&lb->cond, &lb->lock, &ts) == ETIMEDOUT)
+			break;
+	}
+	if (!lb->reader_started) {
+		pthread_mutex_unlock(&lb->lock);
+		return MM_ERROR_SOUND_INVALID_STATE;
+	}
+	/* take what arrived while timing out */
+	done += _audio_io_ring_read(lb->ring, (char *)buffer + done, length - done);
+	pthread_cond_broadcast(&lb->cond);
+	pthread_mutex_unlock(&lb->lock);
+
+	if (done < length)
+		_audio_io_backend_fill_silence(lb->type, (char *)buffer + done, length - done);
+	return length;
+}
+
+static int __loopback_write(void *stream, void *buffer, unsigned int length)
+{
+	audio_io_loopback_s *lb = ((audio_io_loopback_stream_s *)stream)->loopback;
+	unsigned int done = 0;
+
+	if (buffer == NULL)
+		return MM_ERROR_SOUND_INVALID_POINTER;
+
+	pthread_mutex_lock(&lb->lock);
+	while (lb->writer_started && lb->reader_started) {
+		done += _audio_io_ring_write(lb->ring, (char *)buffer + done, length - done);
+		pthread_cond_broadcast(&lb->cond);
+		if (done == length)
+			break;
+		pthread_cond_wait(&lb->cond, &lb->lock);
+	}
+	if (!lb->writer_started) {
+		pthread_mutex_unlock(&lb->lock);
+		return done > 0 ? (int)done : MM_ERROR_SOUND_INVALID_STATE;
+	}
+	pthread_mutex_unlock(&lb->lock);
+	/* the rest is dropped when capture stops, like a device nobody listens to */
+	return length;
+}
+
+static int __loopback_close(void *stream, audio_io_direction_e direction)
+{
+	audio_io_loopback_s *lb = ((audio_io_loopback_stream_s *)stream)->loopback;
+	audio_io_loopback_s **p;
+
+	pthread_mutex_lock(&__lock);
+	pthread_mutex_lock(&lb->lock);
+	if (direction == AUDIO_IO_DIRECTION_IN) {
+		lb->has_reader = false;
+		lb->reader_started = false;
+	} else {
+		lb->has_writer = false;
+		lb->writer_started = false;
+	}
+	pthread_cond_broadcast(&lb->cond);
+	pthread_mutex_unlock(&lb->lock);
+	if (!lb->has_reader && !lb->has_writer) {
+		for (p = &__loopbacks; *p != lb; p = &(*p)->next)
+			;
+		*p = lb->next;
+		__free_loopback(lb);
+	}
+	pthread_mutex_unlock(&__lock);
+	free(stream);
+	return MM_ERROR_NONE;
+}
+
+const audio_io_backend_s _audio_io_backend_loopback = {
+	.name = "loopback",
+	.cacheable = false,
+	.open = __loopback_open,
+	.start = __loopback_start,
+	.stop = __loopback_stop,
+	.read = __loopback_read,
+	.write = __loopback_write,
+	.close = __loopback_close,
+};
@@ -0,0 +1,336 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <string.h>
+#include <time.h>
+#include <mm.h>
+#include <audio_io_private.h>
+
+/*
+* Warm handle cache : destroyed handles leave their stopped mm-sound stream here, and a later create
+* with the same device format takes it back instead of opening a new one. Streams of backends that
+* are not cacheable are opened and closed directly.
+*
+* Entries are keyed by backend, direction and device format (plus the sound type for output). When the cache
+* is full the entry idle for the longest time is closed to make room. A reaper thread closes entries
+* that stay idle longer than the timeout; it only runs while the cache holds entries.
+* Streams are always closed outside the cache lock, since closing can take as long as opening.
+*/
+typedef struct {
+	const audio_io_backend_s *backend;
+	audio_io_direction_e direction;
+	int rate;
+	audio_channel_e channel;
+	audio_sample_type_e type;
+	sound_type_e sound_type;
+	void *stream;
+	int buffer_size;
+	unsigned long long idle_since_us;
+} audio_io_cache_entry_s;
+
+static struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	bool cond_ready;
+	unsigned int max_handles;
+	unsigned long long idle_timeout_us;
+	audio_io_cache_entry_s entries[AUDIO_IO_HANDLE_CACHE_MAX];
+	unsigned int count;
+	bool reaper_running;
+	unsigned long long hits;
+	unsigned long long misses;
+	unsigned long long evictions;
+} __cache = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void __close_entries(audio_io_cache_entry_s *entries, unsigned int count)
+{
+	unsigned int i;
+	for (i = 0; i < count; i++)
+		entries[i].backend->close(entries[i].stream, entries[i].direction);
+}
+
+/* the reaper waits on a monotonic deadline, so the condition variable needs a matching clock */
+static void __init_cond(void)
+{
+	pthread_condattr_t attr;
+
+	if (__cache.cond_ready)
+		return;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&__cache.cond, &attr);
+	pthread_condattr_destroy(&attr);
+	__cache.cond_ready = true;
+}
+
+/* moves entry @index out of the cache into @out, called with the lock held */
+static void __remove_entry(unsigned int index, audio_io_cache_entry_s *out)
+{
+	*out = __cache.entries[index];
+	__cache.entries[index] = __cache.entries[--__cache.count];
+}
+
+static unsigned int __find_oldest(void)
+{
+	unsigned int oldest = 0;
+	unsigned int i;
+	for (i = 1; i < __cache.count; i++) {
+		if (__cache.entries[i].idle_since_us < __cache.entries[oldest].idle_since_us)
+			oldest = i;
+	}
+	return oldest;
+}
+
+/* moves the entries idle for longer than the timeout into @expired and returns their number, called with the lock held */
+static unsigned int __collect_expired(unsigned long long now, audio_io_cache_entry_s *expired)
+{
+	unsigned int n = 0;
+	unsigned int i = 0;
+
+	if (__cache.idle_timeout_us == 0)
+		return 0;
+	while (i < __cache.count) {
+		if (now - __cache.entries[i].idle_since_us >= __cache.idle_timeout_us) {
+			__remove_entry(i, &expired[n++]);
+			__cache.evictions++;
+		} else {
+			i++;
+		}
+	}
+	return n;
+}
+
+static void *__reaper_thread(void *data)
+{
+	audio_io_cache_entry_s expired[AUDIO_IO_HANDLE_CACHE_MAX];
+	unsigned long long deadline;
+	struct timespec ts;
+	unsigned int n;
+
+	pthread_mutex_lock(&__cache.lock);
+	while (__cache.count > 0 && __cache.idle_timeout_us > 0) {
+		deadline = __cache.entries[__find_oldest()].idle_since_us + __cache.idle_timeout_us;
+		ts.tv_sec = deadline / 1000000ULL;
+		ts.tv_nsec = (deadline % 1000000ULL) * 1000;
+		pthread_cond_timedwait(&__cache.cond, &__cache.lock, &ts);
+
+		n = __collect_expired(_audio_io_get_time_us(), expired);
+		if (n > 0) {
+			pthread_mutex_unlock(&__cache.lock);
+			__close_entries(expired, n);
+			pthread_mutex_lock(&__cache.lock);
+		}
+	}
+	__cache.reaper_running = false;
+	pthread_mutex_unlock(&__cache.lock);
+	return NULL;
+}
+
+/* makes sure a reaper watches the cache, called with the lock held */
+static void __start_reaper(void)
+{
+	pthread_attr_t attr;
+	pthread_t thread;
+
+	if (__cache.idle_timeout_us == 0)
+		return;
+	if (__cache.reaper_running) {
+		/* the oldest entry may have changed */
+		pthread_cond_signal(&__cache.cond);
+		return;
+	}
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	if (pthread_create(&thread, &attr, __reaper_thread, NULL) == 0)
+		__cache.reaper_running = true;
+	else
+		AUDIO_IO_LOGW("[%s] failed to create the cache reaper thread, idle handles are kept until reused", __FUNCTION__);
+	pthread_attr_destroy(&attr);
+}
+
+/*
+* Adds a stopped stream to the cache, closing the oldest entry if the cache is full.
+* Returns false when the cache is disabled and the caller keeps ownership of the stream.
+*/
+static bool __put(const audio_io_backend_s *backend, audio_io_direction_e direction, int rate, audio_channel_e channel,
+		audio_sample_type_e type, sound_type_e sound_type, void *stream, int buffer_size)
+{
+	audio_io_cache_entry_s evicted;
+	audio_io_cache_entry_s *entry;
+	bool has_evicted = false;
+
+	if (!backend->cacheable)
+		return false;
+	pthread_mutex_lock(&__cache.lock);
+	if (__cache.max_handles == 0) {
+		pthread_mutex_unlock(&__cache.lock);
+		return false;
+	}
+	if (__cache.count == __cache.max_handles) {
+		__remove_entry(__find_oldest(), &evicted);
+		__cache.evictions++;
+		has_evicted = true;
+	}
+	entry = &__cache.entries[__cache.count++];
+	entry->backend = backend;
+	entry->direction = direction;
+	entry->rate = rate;
+	entry->channel = channel;
+	entry->type = type;
+	entry->sound_type = direction == AUDIO_IO_DIRECTION_OUT ? sound_type : 0;
+	entry->stream = stream;
+	entry->buffer_size = buffer_size;
+	entry->idle_since_us = _audio_io_get_time_us();
+	__start_reaper();
+	pthread_mutex_unlock(&__cache.lock);
+
+	if (has_evicted)
+		__close_entries(&evicted, 1);
+	return true;
+}
+
+bool _audio_io_cache_enabled(void)
+{
+	return __atomic_load_n(&__cache.max_handles, __ATOMIC_RELAXED) > 0;
+}
+
+/*
+* Opens a device stream, from the cache when an idle stream with the same format is there.
+* Returns the device buffer size or a negative mm-sound error code, like the backend open functions.
+*/
+int _audio_io_cache_open(const audio_io_backend_s *backend, audio_io_direction_e direction, int rate, audio_channel_e channel,
+		audio_sample_type_e type, sound_type_e sound_type, const char *path, void **stream)
+{
+	audio_io_cache_entry_s *entry;
+	int found = -1;
+	int ret;
+	unsigned int i;
+
+	if (!backend->cacheable)
+		return backend->open(stream, direction, rate, channel, type, sound_type, path);
+
+	pthread_mutex_lock(&__cache.lock);
+	if (__cache.max_handles > 0) {
+		/* reuse the stream idle the longest, which is the next one the reaper would close */
+		for (i = 0; i < __cache.count; i++) {
+			entry = &__cache.entries[i];
+			if (entry->backend == backend && entry->direction == direction && entry->rate == rate && entry->channel == channel && entry->type == type &&
+				(direction == AUDIO_IO_DIRECTION_IN || entry->sound_type == sound_type) &&
+				(found < 0 || entry->idle_since_us < __cache.entries[found].idle_since_us))
+				found = i;
+		}
+		if (found >= 0) {
+			entry = &__cache.entries[found];
+			*stream = entry->stream;
+			ret = entry->buffer_size;
+			*entry = __cache.entries[--__cache.count];
+			__cache.hits++;
+			pthread_mutex_unlock(&__cache.lock);
+			return ret;
+		}
+		__cache.misses++;
+	}
+	pthread_mutex_unlock(&__cache.lock);
+
+	return backend->open(stream, direction, rate, channel, type, sound_type, path);
+}
+
+/*
+* Stops a device stream and hands it to the cache, or closes it when the cache is disabled.
+* Returns MM_ERROR_NONE or the backend close error.
+*/
+int _audio_io_cache_close(const audio_io_backend_s *backend, audio_io_direction_e direction, int rate, audio_channel_e channel,
+		audio_sample_type_e type, sound_type_e sound_type, void *stream, int buffer_size)
+{
+	/* the stream may never have been started; stopping it anyway is harmless */
+	backend->stop(stream, direction);
+
+	if (__put(backend, direction, rate, channel, type, sound_type, stream, buffer_size))
+		return MM_ERROR_NONE;
+	return backend->close(stream, direction);
+}
+
+/*
+* Opens up to @count streams of the given device format into the cache, stopping when it is full.
+* Does nothing for backends that are not cacheable. Returns MM_ERROR_NONE or the first open error.
+*/
+int _audio_io_cache_prefill(const audio_io_backend_s *backend, audio_io_direction_e direction, int rate, audio_channel_e channel,
+		audio_sample_type_e type, sound_type_e sound_type, const char *path, unsigned int count)
+{
+	void *stream;
+	unsigned int room;
+	unsigned int i;
+	int ret;
+
+	if (!backend->cacheable)
+		return MM_ERROR_NONE;
+	pthread_mutex_lock(&__cache.lock);
+	room = __cache.max_handles - __cache.count;
+	pthread_mutex_unlock(&__cache.lock);
+	if (count > room)
+		count = room;
+
+	for (i = 0; i < count; i++) {
+		ret = backend->open(&stream, direction, rate, channel, type, sound_type, path);
+		if (ret < 0)
+			return ret;
+		if (!__put(backend, direction, rate, channel, type, sound_type, stream, ret)) {
+			backend->close(stream, direction);
+			break;
+		}
+	}
+	return MM_ERROR_NONE;
+}
+
+int audio_io_set_handle_cache(unsigned int max_handles, unsigned int idle_timeout_ms)
+{
+	audio_io_cache_entry_s evicted[AUDIO_IO_HANDLE_CACHE_MAX];
+	unsigned int n = 0;
+
+	AUDIO_IO_CHECK_CONDITION(max_handles <= AUDIO_IO_HANDLE_CACHE_MAX, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+
+	pthread_mutex_lock(&__cache.lock);
+	__init_cond();
+	__cache.max_handles = max_handles;
+	__cache.idle_timeout_us = (unsigned long long)idle_timeout_ms * 1000ULL;
+	while (__cache.count > max_handles) {
+		__remove_entry(__find_oldest(), &evicted[n++]);
+		__cache.evictions++;
+	}
+	if (__cache.count > 0)
+		__start_reaper();
+	else if (__cache.reaper_running)
+		pthread_cond_signal(&__cache.cond);
+	pthread_mutex_unlock(&__cache.lock);
+
+	__close_entries(evicted, n);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_get_handle_cache_stats(audio_io_handle_cache_stats_s *stats)
+{
+	AUDIO_IO_NULL_ARG_CHECK(stats);
+
+	pthread_mutex_lock(&__cache.lock);
+	stats->hits = __cache.hits;
+	stats->misses = __cache.misses;
+	stats->evictions = __cache.evictions;
+	stats->idle_handles = __cache.count;
+	pthread_mutex_unlock(&__cache.lock);
+	return AUDIO_IO_ERROR_NONE;
+}
@@ -0,0 +1,274 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <string.h>
+#include <audio_io_private.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIO_IO_HAVE_NEON
+#endif
+
+/*
+* Speaker positions of the interleaved channels for each channel count,
+* following the default WAVE_FORMAT_EXTENSIBLE channel masks.
+*/
+enum {
+	SPK_FL, SPK_FR, SPK_FC, SPK_LFE, SPK_BL, SPK_BR, SPK_BC, SPK_SL, SPK_SR,
+};
+
+static const int __layouts[AUDIO_IO_MAX_CHANNELS + 1][AUDIO_IO_MAX_CHANNELS] = {
+	[1] = { SPK_FC },
+	[2] = { SPK_FL, SPK_FR },
+	[3] = { SPK_FL, SPK_FR, SPK_FC },
+	[4] = { SPK_FL, SPK_FR, SPK_BL, SPK_BR },
+	[5] = { SPK_FL, SPK_FR, SPK_FC, SPK_BL, SPK_BR },
+	[6] = { SPK_FL, SPK_FR, SPK_FC, SPK_LFE, SPK_BL, SPK_BR },
+	[7] = { SPK_FL, SPK_FR, SPK_FC, SPK_LFE, SPK_BC, SPK_SL, SPK_SR },
+	[8] = { SPK_FL, SPK_FR, SPK_FC, SPK_LFE, SPK_BL, SPK_BR, SPK_SL, SPK_SR },
+};
+
+#define M_SQRT1_2_F	0.70710678f
+
+/* contribution of a speaker to the left and right stereo downmix (ITU-R BS.775, LFE dropped) */
+static void __get_stereo_gain(int speaker, float *left, float *right)
+{
+	*left = *right = 0.0f;
+	switch (speaker) {
+	case SPK_FL:
+		*left = 1.0f;
+		break;
+	case SPK_FR:
+		*right = 1.0f;
+		break;
+	case SPK_FC:
+		*left = *right = M_SQRT1_2_F;
+		break;
+	case SPK_BL:
+	case SPK_SL:
+		*left = M_SQRT1_2_F;
+		break;
+	case SPK_BR:
+	case SPK_SR:
+		*right = M_SQRT1_2_F;
+		break;
+	case SPK_BC:
+		*left = *right = 0.5f;
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+* Fills the dst_channels x src_channels mixing matrix (row major).
+* Downmixes are normalized so that a full scale signal on every input channel cannot clip.
+* Upmixes from stereo (or mono) place the signal on the front pair and leave the other channels silent.
+*/
+void _audio_io_channel_get_matrix(int src_channels, int dst_channels, float *matrix)
+{
+	float left, right, sum_left = 0.0f, sum_right = 0.0f;
+	int i, j;
+
+	memset(matrix, 0, sizeof(float) * src_channels * dst_channels);
+
+	if (src_channels == dst_channels) {
+		for (i = 0; i < src_channels; i++)
+			matrix[i * src_channels + i] = 1.0f;
+		return;
+	}
+
+	if (src_channels <= 2) {
+		/* upmix : mono feeds both front channels, stereo feeds front left and right */
+		for (j = 0; j < dst_channels && j < 2; j++)
+			matrix[j * src_channels + (src_channels == 1 ? 0 : j)] = 1.0f;
+		if (dst_channels == 1)
+			matrix[0] = matrix[1] = 0.5f;
+		return;
+	}
+
+	for (i = 0; i < src_channels; i++) {
+		__get_stereo_gain(__layouts[src_channels][i], &left, &right);
+		sum_left += left;
+		sum_right += right;
+		if (dst_channels == 1) {
+			matrix[i] = (left + right) * 0.5f;
+		} else {
+			matrix[i] = left;
+			matrix[src_channels + i] = right;
+		}
+	}
+	for (i = 0; i < src_channels; i++) {
+		if (dst_channels == 1) {
+			matrix[i] /= (sum_left + sum_right) * 0.5f;
+		} else {
+			matrix[i] /= sum_left;
+			matrix[src_channels + i] /= sum_right;
+		}
+	}
+}
+
+void _audio_io_deinterleave_f32(const float *src, float **planes, int channels, unsigned int frames)
+{
+	unsigned int i = 0;
+	int c;
+
+#if defined(__SSE__)
+	if (channels == 2) {
+		for (; i + 4 <= frames; i += 4) {
+			__m128 a = _mm_loadu_ps(src + i * 2);
+			__m128 b = _mm_loadu_ps(src + i * 2 + 4);
+			_mm_storeu_ps(planes[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(planes[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		}
+	} else if (channels == 4 || channels == 8) {
+		for (; i + 4 <= frames; i += 4) {
+			for (c = 0; c < channels; c += 4) {
+				__m128 r0 = _mm_loadu_ps(src + (i + 0) * channels + c);
+				__m128 r1 = _mm_loadu_ps(src + (i + 1) * channels + c);
+				__m128 r2 = _mm_loadu_ps(src + (i + 2) * channels + c);
+				__m128 r3 = _mm_loadu_ps(src + (i + 3) * channels + c);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(planes[c + 0] + i, r0);
+				_mm_storeu_ps(planes[c + 1] + i, r1);
+				_mm_storeu_ps(planes[c + 2] + i, r2);
+				_mm_storeu_ps(planes[c + 3] + i, r3);
+			}
+		}
+	}
+#elif defined(AUDIO_IO_HAVE_NEON)
+	if (channels == 2) {
+		for (; i + 4 <= frames; i += 4) {
+			float32x4x2_t v = vld2q_f32(src + i * 2);
+			vst1q_f32(planes[0] + i, v.val[0]);
+			vst1q_f32(planes[1] + i, v.val[1]);
+		}
+	} else if (channels == 4) {
+		for (; i + 4 <= frames; i += 4) {
+			float32x4x4_t v = vld4q_f32(src + i * 4);
+			for (c = 0; c < 4; c++)
+				vst1q_f32(planes[c] + i, v.val[c]);
+		}
+	}
+#endif
+	for (; i < frames; i++)
+		for (c = 0; c < channels; c++)
+			planes[c][i] = src[i * channels + c];
+}
+
+void _audio_io_interleave_f32(float **planes, float *dst, int channels, unsigned int frames)
+{
+	unsigned int i = 0;
+	int c;
+
+#if defined(__SSE__)
+	if (channels == 2) {
+		for (; i + 4 <= frames; i += 4) {
+			__m128 l = _mm_loadu_ps(planes[0] + i);
+			__m128 r = _mm_loadu_ps(planes[1] + i);
+			_mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(l, r));
+			_mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(l, r));
+		}
+	} else if (channels == 4 || channels == 8) {
+		for (; i + 4 <= frames; i += 4) {
+			for (c = 0; c < channels; c += 4) {
+				__m128 r0 = _mm_loadu_ps(planes[c + 0] + i);
+				__m128 r1 = _mm_loadu_ps(planes[c + 1] + i);
+				__m128 r2 = _mm_loadu_ps(planes[c + 2] + i);
+				__m128 r3 = _mm_loadu_ps(planes[c + 3] + i);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(dst + (i + 0) * channels + c, r0);
+				_mm_storeu_ps(dst + (i + 1) * channels + c, r1);
+				_mm_storeu_ps(dst + (i + 2) * channels + c, r2);
+				_mm_storeu_ps(dst + (i + 3) * channels + c, r3);
+			}
+		}
+	}
+#elif defined(AUDIO_IO_HAVE_NEON)
+	if (channels == 2) {
+		for (; i + 4 <= frames; i += 4) {
+			float32x4x2_t v;
+			v.val[0] = vld1q_f32(planes[0] + i);
+			v.val[1] = vld1q_f32(planes[1] + i);
+			vst2q_f32(dst + i * 2, v);
+		}
+	} else if (channels == 4) {
+		for (; i + 4 <= frames; i += 4) {
+			float32x4x4_t v;
+			for (c = 0; c < 4; c++)
+				v.val[c] = vld1q_f32(planes[c] + i);
+			vst4q_f32(dst + i * 4, v);
+		}
+	}
+#endif
+	for (; i < frames; i++)
+		for (c = 0; c < channels; c++)
+			dst[i * channels + c] = planes[c][i];
+}
+
+/* dst[j] = sum(matrix[j][k] * src[k]) for every frame, skipping silent matrix entries */
+void _audio_io_mix_planes(float **src, int src_channels, float **dst, int dst_channels, const float *matrix, unsigned int frames)
+{
+	unsigned int i;
+	int j, k;
+
+	for (j = 0; j < dst_channels; j++) {
+		const float *row = matrix + j * src_channels;
+		float *out = dst[j];
+		int first = 1;
+
+		for (k = 0; k < src_channels; k++) {
+			const float *in = src[k];
+			float g = row[k];
+			if (g == 0.0f)
+				continue;
+			i = 0;
+#if defined(__SSE__)
+			{
+				__m128 vg = _mm_set1_ps(g);
+				if (first) {
+					for (; i + 4 <= frames; i += 4)
+						_mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), vg));
+				} else {
+					for (; i + 4 <= frames; i += 4)
+						_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), vg)));
+				}
+			}
+#elif defined(AUDIO_IO_HAVE_NEON)
+			if (first) {
+				for (; i + 4 <= frames; i += 4)
+					vst1q_f32(out + i, vmulq_n_f32(vld1q_f32(in + i), g));
+			} else {
+				for (; i + 4 <= frames; i += 4)
+					vst1q_f32(out + i, vmlaq_n_f32(vld1q_f32(out + i), vld1q_f32(in + i), g));
+			}
+#endif
+			if (first) {
+				for (; i < frames; i++)
+					out[i] = in[i] * g;
+			} else {
+				for (; i < frames; i++)
+					out[i] += in[i] * g;
+			}
+			first = 0;
+		}
+		if (first)
+			memset(out, 0, sizeof(float) * frames);
+	}
+}
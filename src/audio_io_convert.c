@@ -0,0 +1,739 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <audio_io_private.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUDIO_IO_HAVE_AVX2_DISPATCH
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIO_IO_HAVE_NEON
+#endif
+
+#define S16_SCALE	32768.0f
+#define S24_SCALE	8388608.0f
+#define S32_SCALE	2147483648.0f
+#define U8_SCALE	128.0f
+
+/* largest float below 1.0, so that x * 2^31 still fits in an int32 */
+#define F32_MAX_BELOW_ONE	0.99999994f
+
+#define CONVERT_CHUNK	256
+
+typedef struct {
+	void (*s16_to_f32)(const short *src, float *dst, unsigned int n);
+	void (*f32_to_s16)(const float *src, short *dst, unsigned int n);
+	void (*s32_to_f32)(const int *src, float *dst, unsigned int n);
+	void (*f32_to_s32)(const float *src, int *dst, unsigned int n);
+} audio_io_convert_ops_s;
+
+/*
+* Scalar kernels, also used for the tails of the SIMD kernels
+*/
+static inline short __f32_to_s16_sample(float x)
+{
+	long v = lrintf(x * S16_SCALE);
+	return v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+}
+
+static inline int __f32_to_s32_sample(float x)
+{
+	if (x >= 1.0f)
+		return 0x7fffffff;
+	if (x <= -1.0f)
+		return (int)0x80000000;
+	return (int)lrint((double)x * S32_SCALE);
+}
+
+static void __s16_to_f32_c(const short *src, float *dst, unsigned int n)
+{
+	unsigned int i;
+	for (i = 0; i < n; i++)
+		dst[i] = src[i] * (1.0f / S16_SCALE);
+}
+
+static void __f32_to_s16_c(const float *src, short *dst, unsigned int n)
+{
+	unsigned int i;
+	for (i = 0; i < n; i++)
+		dst[i] = __f32_to_s16_sample(src[i]);
+}
+
+static void __s32_to_f32_c(const int *src, float *dst, unsigned int n)
+{
+	unsigned int i;
+	for (i = 0; i < n; i++)
+		dst[i] = src[i] * (1.0f / S32_SCALE);
+}
+
+static void __f32_to_s32_c(const float *src, int *dst, unsigned int n)
+{
+	unsigned int i;
+	for (i = 0; i < n; i++)
+		dst[i] = __f32_to_s32_sample(src[i]);
+}
+
+static void __u8_to_f32(const unsigned char *src, float *dst, unsigned int n)
+{
+	unsigned int i;
+	for (i = 0; i < n; i++)
+		dst[i] = ((int)src[i] - 128) * (1.0f / U8_SCALE);
+}
+
+static void __f32_to_u8(const float *src, unsigned char *dst, unsigned int n)
+{
+	unsigned int i;
+	long v;
+	for (i = 0; i < n; i++) {
+		v = lrintf(src[i] * U8_SCALE) + 128;
+		dst[i] = v > 255 ? 255 : (v < 0 ? 0 : v);
+	}
+}
+
+static void __s24_to_f32(const unsigned char *src, float *dst, unsigned int n)
+{
+	unsigned int i;
+	int v;
+	for (i = 0; i < n; i++, src += 3) {
+		v = (int)(((unsigned int)src[0] << 8) | ((unsigned int)src[1] << 16) | ((unsigned int)src[2] << 24)) >> 8;
+		dst[i] = v * (1.0f / S24_SCALE);
+	}
+}
+
+static void __f32_to_s24(const float *src, unsigned char *dst, unsigned int n)
+{
+	unsigned int i;
+	long v;
+	for (i = 0; i < n; i++, dst += 3) {
+		v = lrintf(src[i] * S24_SCALE);
+		v = v > 8388607 ? 8388607 : (v < -8388608 ? -8388608 : v);
+		dst[0] = v;
+		dst[1] = v >> 8;
+		dst[2] = v >> 16;
+	}
+}
+
+static void __s24_to_s16(const unsigned char *src, short *dst, unsigned int n)
+{
+	unsigned int i;
+	for (i = 0; i < n; i++, src += 3)
+		dst[i] = (short)(src[1] | (src[2] << 8));
+}
+
+static void __s16_to_s24(const short *src, unsigned char *dst, unsigned int n)
+{
+	unsigned int i;
+	for (i = 0; i < n; i++, dst += 3) {
+		dst[0] = 0;
+		dst[1] = src[i];
+		dst[2] = src[i] >> 8;
+	}
+}
+
+/*
+* SSE2 kernels
+*/
+#if defined(__SSE2__)
+static void __s16_to_f32_sse2(const short *src, float *dst, unsigned int n)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / S16_SCALE);
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+	__s16_to_f32_c(src + i, dst + i, n - i);
+}
+
+static void __f32_to_s16_sse2(const float *src, short *dst, unsigned int n)
+{
+	const __m128 scale = _mm_set1_ps(S16_SCALE);
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		/* cvtps rounds to nearest and packs saturates, so no explicit clamp is needed */
+		__m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), scale));
+		__m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+	__f32_to_s16_c(src + i, dst + i, n - i);
+}
+
+static void __s32_to_f32_sse2(const int *src, float *dst, unsigned int n)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / S32_SCALE);
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(src + i))), scale));
+	__s32_to_f32_c(src + i, dst + i, n - i);
+}
+
+static void __f32_to_s32_sse2(const float *src, int *dst, unsigned int n)
+{
+	const __m128 scale = _mm_set1_ps(S32_SCALE);
+	const __m128 max = _mm_set1_ps(F32_MAX_BELOW_ONE);
+	const __m128 min = _mm_set1_ps(-1.0f);
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m128 v = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i), max), min);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_cvtps_epi32(_mm_mul_ps(v, scale)));
+	}
+	__f32_to_s32_c(src + i, dst + i, n - i);
+}
+
+static void __s32_to_s16(const int *src, short *dst, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m128i lo = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)(src + i)), 16);
+		__m128i hi = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)(src + i + 4)), 16);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+	for (; i < n; i++)
+		dst[i] = src[i] >> 16;
+}
+
+static void __s16_to_s32(const short *src, int *dst, unsigned int n)
+{
+	const __m128i zero = _mm_setzero_si128();
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(zero, v));
+		_mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(zero, v));
+	}
+	for (; i < n; i++)
+		dst[i] = (int)src[i] << 16;
+}
+
+/*
+* NEON kernels
+*/
+#elif defined(AUDIO_IO_HAVE_NEON)
+static void __s16_to_f32_neon(const short *src, float *dst, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int16x8_t v = vld1q_s16(src + i);
+		vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), 1.0f / S16_SCALE));
+		vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), 1.0f / S16_SCALE));
+	}
+	__s16_to_f32_c(src + i, dst + i, n - i);
+}
+
+static inline int32x4_t __f32_round_s32_neon(float32x4_t v)
+{
+	/* round half away from zero; vcvtq saturates on overflow */
+	uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x80000000));
+	float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+	return vcvtq_s32_f32(vaddq_f32(v, half));
+}
+
+static void __f32_to_s16_neon(const float *src, short *dst, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int32x4_t lo = __f32_round_s32_neon(vmulq_n_f32(vld1q_f32(src + i), S16_SCALE));
+		int32x4_t hi = __f32_round_s32_neon(vmulq_n_f32(vld1q_f32(src + i + 4), S16_SCALE));
+		vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+	}
+	__f32_to_s16_c(src + i, dst + i, n - i);
+}
+
+static void __s32_to_f32_neon(const int *src, float *dst, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4)
+		vst1q_f32(dst + i, vcvtq_n_f32_s32(vld1q_s32(src + i), 31));
+	__s32_to_f32_c(src + i, dst + i, n - i);
+}
+
+static void __f32_to_s32_neon(const float *src, int *dst, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4)
+		vst1q_s32(dst + i, vcvtq_n_s32_f32(vld1q_f32(src + i), 31));
+	__f32_to_s32_c(src + i, dst + i, n - i);
+}
+
+static void __s32_to_s16(const int *src, short *dst, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+		vst1q_s16(dst + i, vcombine_s16(vshrn_n_s32(vld1q_s32(src + i), 16), vshrn_n_s32(vld1q_s32(src + i + 4), 16)));
+	for (; i < n; i++)
+		dst[i] = src[i] >> 16;
+}
+
+static void __s16_to_s32(const short *src, int *dst, unsigned int n)
+{
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int16x8_t v = vld1q_s16(src + i);
+		vst1q_s32(dst + i, vshll_n_s16(vget_low_s16(v), 16));
+		vst1q_s32(dst + i + 4, vshll_n_s16(vget_high_s16(v), 16));
+	}
+	for (; i < n; i++)
+		dst[i] = (int)src[i] << 16;
+}
+
+#else
+static void __s32_to_s16(const int *src, short *dst, unsigned int n)
+{
+	unsigned int i;
+	for (i = 0; i < n; i++)
+		dst[i] = src[i] >> 16;
+}
+
+static void __s16_to_s32(const short *src, int *dst, unsigned int n)
+{
+	unsigned int i;
+	for (i = 0; i < n; i++)
+		dst[i] = (int)src[i] << 16;
+}
+#endif
+
+/*
+* AVX2 kernels, selected at run time on CPUs that support them
+*/
+#ifdef AUDIO_IO_HAVE_AVX2_DISPATCH
+__attribute__((target("avx2")))
+static void __s16_to_f32_avx2(const short *src, float *dst, unsigned int n)
+{
+	const __m256 scale = _mm256_set1_ps(1.0f / S16_SCALE);
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i)));
+		_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+	}
+	__s16_to_f32_c(src + i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void __f32_to_s16_avx2(const float *src, short *dst, unsigned int n)
+{
+	const __m256 scale = _mm256_set1_ps(S16_SCALE);
+	unsigned int i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m256i lo = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale));
+		__m256i hi = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale));
+		/* packs works per 128-bit lane, so restore the sample order afterwards */
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8);
+		_mm256_storeu_si256((__m256i *)(dst + i), packed);
+	}
+	__f32_to_s16_c(src + i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void __s32_to_f32_avx2(const int *src, float *dst, unsigned int n)
+{
+	const __m256 scale = _mm256_set1_ps(1.0f / S32_SCALE);
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)(src + i))), scale));
+	__s32_to_f32_c(src + i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void __f32_to_s32_avx2(const float *src, int *dst, unsigned int n)
+{
+	const __m256 scale = _mm256_set1_ps(S32_SCALE);
+	const __m256 max = _mm256_set1_ps(F32_MAX_BELOW_ONE);
+	const __m256 min = _mm256_set1_ps(-1.0f);
+	unsigned int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 v = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(src + i), max), min);
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtps_epi32(_mm256_mul_ps(v, scale)));
+	}
+	__f32_to_s32_c(src + i, dst + i, n - i);
+}
+#endif
+
+#if defined(__SSE2__)
+static audio_io_convert_ops_s __ops = {
+	__s16_to_f32_sse2, __f32_to_s16_sse2, __s32_to_f32_sse2, __f32_to_s32_sse2,
+};
+#elif defined(AUDIO_IO_HAVE_NEON)
+static audio_io_convert_ops_s __ops = {
+	__s16_to_f32_neon, __f32_to_s16_neon, __s32_to_f32_neon, __f32_to_s32_neon,
+};
+#else
+static audio_io_convert_ops_s __ops = {
+	__s16_to_f32_c, __f32_to_s16_c, __s32_to_f32_c, __f32_to_s32_c,
+};
+#endif
+
+#ifdef AUDIO_IO_HAVE_AVX2_DISPATCH
+__attribute__((constructor))
+static void __audio_io_convert_init(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		__ops.s16_to_f32 = __s16_to_f32_avx2;
+		__ops.f32_to_s16 = __f32_to_s16_avx2;
+		__ops.s32_to_f32 = __s32_to_f32_avx2;
+		__ops.f32_to_s32 = __f32_to_s32_avx2;
+	}
+}
+#endif
+
+void _audio_io_convert_to_float(const void *src, audio_sample_type_e type, float *dst, unsigned int samples)
+{
+	switch (type) {
+	case AUDIO_SAMPLE_TYPE_U8:
+		__u8_to_f32(src, dst, samples);
+		break;
+	case AUDIO_SAMPLE_TYPE_S16_LE:
+		__ops.s16_to_f32(src, dst, samples);
+		break;
+	case AUDIO_SAMPLE_TYPE_S24_LE:
+		__s24_to_f32(src, dst, samples);
+		break;
+	case AUDIO_SAMPLE_TYPE_S32_LE:
+		__ops.s32_to_f32(src, dst, samples);
+		break;
+	case AUDIO_SAMPLE_TYPE_FLOAT32_LE:
+		memcpy(dst, src, samples * sizeof(float));
+		break;
+	}
+}
+
+void _audio_io_convert_from_float(const float *src, audio_sample_type_e type, void *dst, unsigned int samples)
+{
+	switch (type) {
+	case AUDIO_SAMPLE_TYPE_U8:
+		__f32_to_u8(src, dst, samples);
+		break;
+	case AUDIO_SAMPLE_TYPE_S16_LE:
+		__ops.f32_to_s16(src, dst, samples);
+		break;
+	case AUDIO_SAMPLE_TYPE_S24_LE:
+		__f32_to_s24(src, dst, samples);
+		break;
+	case AUDIO_SAMPLE_TYPE_S32_LE:
+		__ops.f32_to_s32(src, dst, samples);
+		break;
+	case AUDIO_SAMPLE_TYPE_FLOAT32_LE:
+		memcpy(dst, src, samples * sizeof(float));
+		break;
+	}
+}
+
+void _audio_io_convert(const void *src, audio_sample_type_e src_type, void *dst, audio_sample_type_e dst_type, unsigned int samples)
+{
+	float tmp[CONVERT_CHUNK] __attribute__((aligned(AUDIO_IO_CACHE_LINE_SIZE)));
+	int src_size = _audio_io_get_sample_size(src_type);
+	int dst_size = _audio_io_get_sample_size(dst_type);
+	unsigned int n;
+
+	if (src_type == dst_type) {
+		memcpy(dst, src, samples * src_size);
+		return;
+	}
+
+	/* integer to integer conversions that do not need the float intermediate */
+	if (src_type == AUDIO_SAMPLE_TYPE_S32_LE && dst_type == AUDIO_SAMPLE_TYPE_S16_LE) {
+		__s32_to_s16(src, dst, samples);
+		return;
+	}
+	if (src_type == AUDIO_SAMPLE_TYPE_S16_LE && dst_type == AUDIO_SAMPLE_TYPE_S32_LE) {
+		__s16_to_s32(src, dst, samples);
+		return;
+	}
+	if (src_type == AUDIO_SAMPLE_TYPE_S24_LE && dst_type == AUDIO_SAMPLE_TYPE_S16_LE) {
+		__s24_to_s16(src, dst, samples);
+		return;
+	}
+	if (src_type == AUDIO_SAMPLE_TYPE_S16_LE && dst_type == AUDIO_SAMPLE_TYPE_S24_LE) {
+		__s16_to_s24(src, dst, samples);
+		return;
+	}
+	if (src_type == AUDIO_SAMPLE_TYPE_FLOAT32_LE) {
+		_audio_io_convert_from_float(src, dst_type, dst, samples);
+		return;
+	}
+	if (dst_type == AUDIO_SAMPLE_TYPE_FLOAT32_LE) {
+		_audio_io_convert_to_float(src, src_type, dst, samples);
+		return;
+	}
+
+	while (samples > 0) {
+		n = samples < CONVERT_CHUNK ? samples : CONVERT_CHUNK;
+		_audio_io_convert_to_float(src, src_type, tmp, n);
+		_audio_io_convert_from_float(tmp, dst_type, dst, n);
+		src = (const unsigned char *)src + n * src_size;
+		dst = (unsigned char *)dst + n * dst_size;
+		samples -= n;
+	}
+}
+
+/*
+* Converter : sample type, channel layout and sample rate conversion between the application and the device.
+* Channel and rate conversion run on planar float data; sample-type-only conversions skip the float stage.
+* Without a resampler every input frame gives one output frame, so the one-shot process calls are used.
+* With a resampler the output count varies, so data is pushed in and pulled out; output that does not fit
+* the caller's buffer stays pending in the converter until the next pull.
+*/
+int _audio_io_converter_create(audio_io_converter_s **converter, audio_sample_type_e src_type, int src_channels,
+		audio_sample_type_e dst_type, int dst_channels, unsigned int max_frames)
+{
+	audio_io_converter_s *conv;
+	unsigned int stride = (max_frames + 15) & ~15U;
+	int max_channels = src_channels > dst_channels ? src_channels : dst_channels;
+	float *p;
+	int i;
+
+	conv = (audio_io_converter_s *)malloc(sizeof(audio_io_converter_s));
+	if (conv == NULL)
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	memset(conv, 0, sizeof(audio_io_converter_s));
+
+	if (posix_memalign((void **)&conv->buffer, AUDIO_IO_CACHE_LINE_SIZE,
+			sizeof(float) * stride * (max_channels + src_channels + dst_channels)) != 0) {
+		free(conv);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+
+	conv->src_type = src_type;
+	conv->src_channels = src_channels;
+	conv->dst_type = dst_type;
+	conv->dst_channels = dst_channels;
+	conv->max_frames = max_frames;
+	_audio_io_channel_get_matrix(src_channels, dst_channels, conv->matrix);
+
+	p = conv->buffer;
+	conv->interleaved = p;
+	p += stride * max_channels;
+	for (i = 0; i < src_channels; i++, p += stride)
+		conv->src_planes[i] = p;
+	if (src_channels == dst_channels) {
+		for (i = 0; i < dst_channels; i++)
+			conv->dst_planes[i] = conv->src_planes[i];
+	} else {
+		for (i = 0; i < dst_channels; i++, p += stride)
+			conv->dst_planes[i] = p;
+	}
+
+	*converter = conv;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int _audio_io_converter_set_resampler(audio_io_converter_s *conv, int src_rate, int dst_rate, audio_io_resampler_quality_e quality)
+{
+	audio_io_resampler_s *resampler;
+	unsigned int stride;
+	float *buffer;
+	int ret;
+	int i;
+
+	ret = _audio_io_resampler_create(&resampler, conv->dst_channels, src_rate, dst_rate, quality, conv->max_frames);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+
+	/* pending output planes followed by the interleave scratch for them */
+	stride = (_audio_io_resampler_get_max_output(resampler, conv->max_frames) + 15) & ~15U;
+	if (posix_memalign((void **)&buffer, AUDIO_IO_CACHE_LINE_SIZE, sizeof(float) * stride * conv->dst_channels * 2) != 0) {
+		_audio_io_resampler_destroy(resampler);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+
+	_audio_io_resampler_destroy(conv->resampler);
+	free(conv->out_buffer);
+	conv->resampler = resampler;
+	conv->out_buffer = buffer;
+	for (i = 0; i < conv->dst_channels; i++)
+		conv->out_planes[i] = buffer + stride * i;
+	conv->out_interleaved = buffer + stride * conv->dst_channels;
+	conv->out_offset = 0;
+	conv->out_pending = 0;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+void _audio_io_converter_reset(audio_io_converter_s *conv)
+{
+	if (conv == NULL || conv->resampler == NULL)
+		return;
+	_audio_io_resampler_reset(conv->resampler);
+	conv->out_offset = 0;
+	conv->out_pending = 0;
+}
+
+void _audio_io_converter_destroy(audio_io_converter_s *converter)
+{
+	if (converter == NULL)
+		return;
+	_audio_io_resampler_destroy(converter->resampler);
+	free(converter->out_buffer);
+	free(converter->buffer);
+	free(converter);
+}
+
+void _audio_io_converter_lock_memory(audio_io_converter_s *conv, audio_io_memlock_s *memlock)
+{
+	unsigned int stride;
+	int max_channels;
+
+	if (conv == NULL)
+		return;
+	stride = (conv->max_frames + 15) & ~15U;
+	max_channels = conv->src_channels > conv->dst_channels ? conv->src_channels : conv->dst_channels;
+	_audio_io_memlock_add(memlock, conv, sizeof(audio_io_converter_s));
+	_audio_io_memlock_add(memlock, conv->buffer, sizeof(float) * stride * (max_channels + conv->src_channels + conv->dst_channels));
+	if (conv->resampler == NULL)
+		return;
+	stride = (_audio_io_resampler_get_max_output(conv->resampler, conv->max_frames) + 15) & ~15U;
+	_audio_io_memlock_add(memlock, conv->out_buffer, sizeof(float) * stride * conv->dst_channels * 2);
+	_audio_io_resampler_lock_memory(conv->resampler, memlock);
+}
+
+static void __converter_load_planar(audio_io_converter_s *conv, void **src_planes, unsigned int offset, unsigned int frames)
+{
+	int size = _audio_io_get_sample_size(conv->src_type);
+	int i;
+
+	for (i = 0; i < conv->src_channels; i++)
+		_audio_io_convert_to_float((const char *)src_planes[i] + offset * size, conv->src_type, conv->src_planes[i], frames);
+	if (conv->src_channels != conv->dst_channels)
+		_audio_io_mix_planes(conv->src_planes, conv->src_channels, conv->dst_planes, conv->dst_channels, conv->matrix, frames);
+}
+
+static void __converter_load_interleaved(audio_io_converter_s *conv, const void *src, unsigned int frames)
+{
+	if (conv->src_channels == 1) {
+		_audio_io_convert_to_float(src, conv->src_type, conv->src_planes[0], frames);
+	} else {
+		_audio_io_convert_to_float(src, conv->src_type, conv->interleaved, frames * conv->src_channels);
+		_audio_io_deinterleave_f32(conv->interleaved, conv->src_planes, conv->src_channels, frames);
+	}
+	if (conv->src_channels != conv->dst_channels)
+		_audio_io_mix_planes(conv->src_planes, conv->src_channels, conv->dst_planes, conv->dst_channels, conv->matrix, frames);
+}
+
+static void __converter_store_planar(audio_io_converter_s *conv, float **planes, void **dst_planes, unsigned int offset, unsigned int frames)
+{
+	int size = _audio_io_get_sample_size(conv->dst_type);
+	int i;
+
+	for (i = 0; i < conv->dst_channels; i++)
+		_audio_io_convert_from_float(planes[i], conv->dst_type, (char *)dst_planes[i] + offset * size, frames);
+}
+
+static void __converter_store_interleaved(audio_io_converter_s *conv, float **planes, float *scratch, void *dst, unsigned int frames)
+{
+	if (conv->dst_channels == 1) {
+		_audio_io_convert_from_float(planes[0], conv->dst_type, dst, frames);
+	} else {
+		_audio_io_interleave_f32(planes, scratch, conv->dst_channels, frames);
+		_audio_io_convert_from_float(scratch, conv->dst_type, dst, frames * conv->dst_channels);
+	}
+}
+
+void _audio_io_converter_process(audio_io_converter_s *conv, const void *src, void *dst, unsigned int frames)
+{
+	if (conv->src_channels == conv->dst_channels) {
+		_audio_io_convert(src, conv->src_type, dst, conv->dst_type, frames * conv->src_channels);
+		return;
+	}
+	__converter_load_interleaved(conv, src, frames);
+	__converter_store_interleaved(conv, conv->dst_planes, conv->interleaved, dst, frames);
+}
+
+void _audio_io_converter_process_from_planar(audio_io_converter_s *conv, void **src_planes, unsigned int offset,
+		void *dst, unsigned int frames)
+{
+	__converter_load_planar(conv, src_planes, offset, frames);
+	__converter_store_interleaved(conv, conv->dst_planes, conv->interleaved, dst, frames);
+}
+
+void _audio_io_converter_process_to_planar(audio_io_converter_s *conv, const void *src, void **dst_planes,
+		unsigned int offset, unsigned int frames)
+{
+	__converter_load_interleaved(conv, src, frames);
+	__converter_store_planar(conv, conv->dst_planes, dst_planes, offset, frames);
+}
+
+/* resamples @frames already in dst_planes and appends the result to the pending output */
+static unsigned int __converter_resample(audio_io_converter_s *conv, unsigned int frames)
+{
+	float *out[AUDIO_IO_MAX_CHANNELS];
+	unsigned int produced;
+	int i;
+
+	/* compact the pending output so the new samples land right after it */
+	if (conv->out_offset > 0) {
+		for (i = 0; i < conv->dst_channels; i++)
+			memmove(conv->out_planes[i], conv->out_planes[i] + conv->out_offset, sizeof(float) * conv->out_pending);
+		conv->out_offset = 0;
+	}
+	for (i = 0; i < conv->dst_channels; i++)
+		out[i] = conv->out_planes[i] + conv->out_pending;
+	produced = _audio_io_resampler_process(conv->resampler, conv->dst_planes, frames, out);
+	conv->out_pending += produced;
+	return produced;
+}
+
+unsigned int _audio_io_converter_push(audio_io_converter_s *conv, const void *src, void **src_planes, unsigned int offset, unsigned int frames)
+{
+	if (src_planes)
+		__converter_load_planar(conv, src_planes, offset, frames);
+	else
+		__converter_load_interleaved(conv, src, frames);
+	return __converter_resample(conv, frames);
+}
+
+/* Pushes @frames of silence, which moves the input still held back by the resampler filter to the output. */
+unsigned int _audio_io_converter_push_silence(audio_io_converter_s *conv, unsigned int frames)
+{
+	int i;
+
+	for (i = 0; i < conv->dst_channels; i++)
+		memset(conv->dst_planes[i], 0, sizeof(float) * frames);
+	return __converter_resample(conv, frames);
+}
+
+/* Moves up to @frames of pending output to interleaved @dst (or to @dst_planes from @offset). Returns the frames moved. */
+unsigned int _audio_io_converter_pull(audio_io_converter_s *conv, void *dst, void **dst_planes, unsigned int offset, unsigned int frames)
+{
+	float *planes[AUDIO_IO_MAX_CHANNELS];
+	int i;
+
+	if (frames > conv->out_pending)
+		frames = conv->out_pending;
+	if (frames == 0)
+		return 0;
+
+	for (i = 0; i < conv->dst_channels; i++)
+		planes[i] = conv->out_planes[i] + conv->out_offset;
+	if (dst_planes)
+		__converter_store_planar(conv, planes, dst_planes, offset, frames);
+	else
+		__converter_store_interleaved(conv, planes, conv->out_interleaved, dst, frames);
+	conv->out_offset += frames;
+	conv->out_pending -= frames;
+	if (conv->out_pending == 0)
+		conv->out_offset = 0;
+	return frames;
+}
@@ -0,0 +1,224 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <string.h>
+#include <mm.h>
+#include <audio_io_private.h>
+
+/*
+* Full-duplex handle : one thread reads a capture period, hands it to the callback with a period to
+* play, and writes that period. The blocking capture read paces the loop, so the output is written at
+* the capture clock and both directions advance by the same number of frames every period.
+* The output starts one period ahead with silence, which covers the time the first read takes.
+*/
+static void __us_to_timespec(unsigned long long us, struct timespec *ts)
+{
+	ts->tv_sec = us / 1000000ULL;
+	ts->tv_nsec = (us % 1000000ULL) * 1000;
+}
+
+static void *__duplex_thread(void *data)
+{
+	audio_io_duplex_s *duplex = (audio_io_duplex_s *)data;
+	audio_in_s *input = duplex->input;
+	audio_out_s *output = duplex->output;
+	unsigned int frames = duplex->period_size / (_audio_io_get_channel_count(input->_channel) * _audio_io_get_sample_size(input->_type));
+	unsigned long long period_us = (unsigned long long)frames * 1000000ULL / input->_sample_rate;
+	audio_io_duplex_timing_s timing;
+	unsigned int latency_us;
+	int ret;
+
+	/* the thread serves both directions, which report the same policy */
+	_audio_io_thread_apply(&input->_thread_policy, &input->_thread_granted);
+	output->_thread_granted = input->_thread_granted;
+
+	memset(&timing, 0, sizeof(audio_io_duplex_timing_s));
+	_audio_io_backend_fill_silence(output->_type, duplex->output_buffer, duplex->period_size);
+	ret = _audio_io_out_write_period(output, duplex->output_buffer, duplex->period_size);
+	while (duplex->running && ret > 0) {
+		ret = _audio_io_in_read_period(input, duplex->input_buffer, duplex->period_size);
+		if (ret <= 0)
+			break;
+		/* a short read leaves the rest of the period silent rather than shifting the two clocks */
+		if ((unsigned int)ret < duplex->period_size)
+			_audio_io_backend_fill_silence(input->_type, (char *)duplex->input_buffer + ret, duplex->period_size - ret);
+
+		/* the read completed with the last frame of the period, the output plays after what it holds */
+		__us_to_timespec(__atomic_load_n(&input->_position.timestamp_us, __ATOMIC_ACQUIRE) - period_us, &timing.capture_time);
+		audio_out_get_latency((audio_out_h)output, &latency_us);
+		__us_to_timespec(_audio_io_get_time_us() + latency_us, &timing.playback_time);
+
+		duplex->callback((audio_io_duplex_h)duplex, duplex->input_buffer, duplex->output_buffer, duplex->period_size,
+				&timing, duplex->user_data);
+		if (!duplex->running)
+			break;
+		ret = _audio_io_out_write_period(output, duplex->output_buffer, duplex->period_size);
+		timing.frames += frames;
+	}
+	if (duplex->running)
+		LOGE("[%s] duplex stream stopped (0x%08x)", __FUNCTION__, ret);
+	return NULL;
+}
+
+int audio_io_duplex_create(int sample_rate, audio_channel_e channel, audio_sample_type_e type, sound_type_e sound_type,
+		audio_io_attr_h attr, audio_io_duplex_h *duplex)
+{
+	AUDIO_IO_NULL_ARG_CHECK(duplex);
+	audio_io_duplex_s *handle;
+	audio_out_h output;
+	audio_in_h input;
+	int ret;
+
+	handle = (audio_io_duplex_s *)_audio_io_handle_alloc(sizeof(audio_io_duplex_s));
+	if (handle == NULL) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)", __FUNCTION__, AUDIO_IO_ERROR_OUT_OF_MEMORY);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	/* the output is created first, so that the attribute reports the capture period the handle runs with */
+	if (attr != NULL)
+		ret = audio_out_create_ex(sample_rate, channel, type, sound_type, attr, &output);
+	else
+		ret = audio_out_create(sample_rate, channel, type, sound_type, &output);
+	if (ret != AUDIO_IO_ERROR_NONE) {
+		_audio_io_handle_free(handle, sizeof(audio_io_duplex_s));
+		return ret;
+	}
+	if (attr != NULL)
+		ret = audio_in_create_ex(sample_rate, channel, type, attr, &input);
+	else
+		ret = audio_in_create(sample_rate, channel, type, &input);
+	if (ret != AUDIO_IO_ERROR_NONE) {
+		audio_out_destroy(output);
+		_audio_io_handle_free(handle, sizeof(audio_io_duplex_s));
+		return ret;
+	}
+
+	handle->input = (audio_in_s *)input;
+	handle->output = (audio_out_s *)output;
+	handle->period_size = handle->input->_buffer_size;
+	handle->input_buffer = _audio_io_pool_alloc(handle->period_size);
+	handle->output_buffer = _audio_io_pool_alloc(handle->period_size);
+	if (handle->input_buffer == NULL || handle->output_buffer == NULL) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)", __FUNCTION__, AUDIO_IO_ERROR_OUT_OF_MEMORY);
+		audio_io_duplex_destroy((audio_io_duplex_h)handle);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	*duplex = (audio_io_duplex_h)handle;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_duplex_destroy(audio_io_duplex_h duplex)
+{
+	AUDIO_IO_NULL_ARG_CHECK(duplex);
+	audio_io_duplex_s *handle = (audio_io_duplex_s *)duplex;
+	int ret;
+
+	audio_io_duplex_unprepare(duplex);
+	/* a direction that failed to close is kept, so that destroy can be called again */
+	if (handle->input != NULL) {
+		ret = audio_in_destroy((audio_in_h)handle->input);
+		if (ret != AUDIO_IO_ERROR_NONE)
+			return ret;
+		handle->input = NULL;
+	}
+	ret = audio_out_destroy((audio_out_h)handle->output);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	_audio_io_pool_free(handle->input_buffer);
+	_audio_io_pool_free(handle->output_buffer);
+	_audio_io_handle_free(handle, sizeof(audio_io_duplex_s));
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_duplex_set_cb(audio_io_duplex_h duplex, audio_io_duplex_cb callback, void *user_data)
+{
+	AUDIO_IO_NULL_ARG_CHECK(duplex);
+	AUDIO_IO_NULL_ARG_CHECK(callback);
+	audio_io_duplex_s *handle = (audio_io_duplex_s *)duplex;
+	AUDIO_IO_CHECK_CONDITION(!handle->prepared, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	handle->callback = callback;
+	handle->user_data = user_data;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_duplex_prepare(audio_io_duplex_h duplex)
+{
+	AUDIO_IO_NULL_ARG_CHECK(duplex);
+	audio_io_duplex_s *handle = (audio_io_duplex_s *)duplex;
+	AUDIO_IO_CHECK_CONDITION(!handle->prepared && handle->callback != NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int ret;
+
+	ret = audio_out_prepare((audio_out_h)handle->output);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	ret = audio_in_prepare((audio_in_h)handle->input);
+	if (ret != AUDIO_IO_ERROR_NONE) {
+		audio_out_unprepare((audio_out_h)handle->output);
+		return ret;
+	}
+	/* the period buffers are locked along with the input, and unlocked when it stops */
+	_audio_io_memlock_add(&handle->input->_memlock, handle, sizeof(audio_io_duplex_s));
+	_audio_io_memlock_add(&handle->input->_memlock, handle->input_buffer, handle->period_size);
+	_audio_io_memlock_add(&handle->input->_memlock, handle->output_buffer, handle->period_size);
+
+	handle->running = 1;
+	if (pthread_create(&handle->thread, NULL, __duplex_thread, handle) != 0) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_OPERATION(0x%08x) : failed to create duplex thread", __FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+		handle->running = 0;
+		audio_in_unprepare((audio_in_h)handle->input);
+		audio_out_unprepare((audio_out_h)handle->output);
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	handle->prepared = true;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_duplex_unprepare(audio_io_duplex_h duplex)
+{
+	AUDIO_IO_NULL_ARG_CHECK(duplex);
+	audio_io_duplex_s *handle = (audio_io_duplex_s *)duplex;
+	int in_ret;
+	int out_ret;
+
+	if (!handle->prepared)
+		return AUDIO_IO_ERROR_NONE;
+	/* stopping the devices wakes the thread from a blocking read or write */
+	handle->running = 0;
+	in_ret = audio_in_unprepare((audio_in_h)handle->input);
+	out_ret = audio_out_unprepare((audio_out_h)handle->output);
+	pthread_join(handle->thread, NULL);
+	handle->prepared = false;
+	return in_ret != AUDIO_IO_ERROR_NONE ? in_ret : out_ret;
+}
+
+int audio_io_duplex_get_buffer_size(audio_io_duplex_h duplex, int *size)
+{
+	AUDIO_IO_NULL_ARG_CHECK(duplex);
+	AUDIO_IO_NULL_ARG_CHECK(size);
+	*size = ((audio_io_duplex_s *)duplex)->period_size;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_duplex_get_handles(audio_io_duplex_h duplex, audio_in_h *input, audio_out_h *output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(duplex);
+	audio_io_duplex_s *handle = (audio_io_duplex_s *)duplex;
+	if (input != NULL)
+		*input = (audio_in_h)handle->input;
+	if (output != NULL)
+		*output = (audio_out_h)handle->output;
+	return AUDIO_IO_ERROR_NONE;
+}
@@ -0,0 +1,337 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <audio_io_private.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIO_IO_HAVE_NEON
+#endif
+
+/*
+* Per-stream gain applied to device format data (U8 or S16) on its way to or from the device.
+*
+* The gain is interpolated linearly from frame to frame. An exponential ramp is followed in segments of
+* GAIN_SEGMENT_FRAMES frames, each interpolated linearly, and runs between GAIN_EXP_FLOOR and the end
+* points when one of them is silence. Samples are scaled in float and saturated when packed back.
+*/
+#define GAIN_SEGMENT_FRAMES	64
+#define GAIN_EXP_FLOOR		0.001f
+
+/* frame offset of each lane within a block, for 1, 2, 4 and 8 channels */
+static const float __lane_frames[4][16] = {
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+	{ 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7 },
+	{ 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1 },
+};
+
+static int __lane_index(int channels)
+{
+	switch (channels) {
+	case 1:
+		return 0;
+	case 2:
+		return 1;
+	case 4:
+		return 2;
+	case 8:
+		return 3;
+	default:
+		return -1;
+	}
+}
+
+/*
+* Scalar kernels, also used for the tails of the SIMD kernels. Frame f is scaled by gain + f * step.
+*/
+static void __scale_s16_c(const short *src, short *dst, int channels, unsigned int frames, float gain, float step)
+{
+	unsigned int f;
+	int c;
+	long v;
+	float g;
+	for (f = 0; f < frames; f++) {
+		g = gain + f * step;
+		for (c = 0; c < channels; c++, src++, dst++) {
+			v = lrintf(*src * g);
+			*dst = v > 32767 ? 32767 : (v < -32768 ? -32768 : v);
+		}
+	}
+}
+
+static void __scale_u8_c(const unsigned char *src, unsigned char *dst, int channels, unsigned int frames, float gain, float step)
+{
+	unsigned int f;
+	int c;
+	long v;
+	float g;
+	for (f = 0; f < frames; f++) {
+		g = gain + f * step;
+		for (c = 0; c < channels; c++, src++, dst++) {
+			v = lrintf(((int)*src - 128) * g) + 128;
+			*dst = v > 255 ? 255 : (v < 0 ? 0 : v);
+		}
+	}
+}
+
+#if defined(__SSE2__)
+static inline __m128 __s16_to_ps(__m128i v, int high)
+{
+	return _mm_cvtepi32_ps(_mm_srai_epi32(high ? _mm_unpackhi_epi16(v, v) : _mm_unpacklo_epi16(v, v), 16));
+}
+
+/* 8 samples per iteration; cvtps rounds to nearest and packs saturates */
+static unsigned int __scale_s16_sse2(const short *src, short *dst, int channels, unsigned int frames, float gain, float step)
+{
+	const float *lanes = __lane_frames[__lane_index(channels)];
+	const __m128 ramp_lo = _mm_mul_ps(_mm_loadu_ps(lanes), _mm_set1_ps(step));
+	const __m128 ramp_hi = _mm_mul_ps(_mm_loadu_ps(lanes + 4), _mm_set1_ps(step));
+	unsigned int block = 8 / channels;
+	unsigned int f = 0;
+	for (; f + block <= frames; f += block, src += 8, dst += 8) {
+		__m128 g = _mm_set1_ps(gain + f * step);
+		__m128i v = _mm_loadu_si128((const __m128i *)src);
+		__m128i lo = _mm_cvtps_epi32(_mm_mul_ps(__s16_to_ps(v, 0), _mm_add_ps(g, ramp_lo)));
+		__m128i hi = _mm_cvtps_epi32(_mm_mul_ps(__s16_to_ps(v, 1), _mm_add_ps(g, ramp_hi)));
+		_mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(lo, hi));
+	}
+	return f;
+}
+
+/* 16 samples per iteration, centered on 0 in 16 bits and packed back with unsigned saturation */
+static unsigned int __scale_u8_sse2(const unsigned char *src, unsigned char *dst, int channels, unsigned int frames, float gain, float step)
+{
+	const float *lanes = __lane_frames[__lane_index(channels)];
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(128);
+	__m128 ramp[4];
+	unsigned int block = 16 / channels;
+	unsigned int f = 0;
+	int k;
+	for (k = 0; k < 4; k++)
+		ramp[k] = _mm_mul_ps(_mm_loadu_ps(lanes + 4 * k), _mm_set1_ps(step));
+	for (; f + block <= frames; f += block, src += 16, dst += 16) {
+		__m128 g = _mm_set1_ps(gain + f * step);
+		__m128i v = _mm_loadu_si128((const __m128i *)src);
+		__m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), bias);
+		__m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(v, zero), bias);
+		lo = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(__s16_to_ps(lo, 0), _mm_add_ps(g, ramp[0]))),
+				_mm_cvtps_epi32(_mm_mul_ps(__s16_to_ps(lo, 1), _mm_add_ps(g, ramp[1]))));
+		hi = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(__s16_to_ps(hi, 0), _mm_add_ps(g, ramp[2]))),
+				_mm_cvtps_epi32(_mm_mul_ps(__s16_to_ps(hi, 1), _mm_add_ps(g, ramp[3]))));
+		_mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(_mm_add_epi16(lo, bias), _mm_add_epi16(hi, bias)));
+	}
+	return f;
+}
+#elif defined(AUDIO_IO_HAVE_NEON)
+static inline int32x4_t __round_s32_neon(float32x4_t v)
+{
+	/* round half away from zero; vcvtq saturates on overflow */
+	uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x80000000));
+	float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+	return vcvtq_s32_f32(vaddq_f32(v, half));
+}
+
+static inline int16x8_t __scale_s16x8_neon(int16x8_t v, float32x4_t g_lo, float32x4_t g_hi)
+{
+	int32x4_t lo = __round_s32_neon(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), g_lo));
+	int32x4_t hi = __round_s32_neon(vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), g_hi));
+	return vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+}
+
+static unsigned int __scale_s16_neon(const short *src, short *dst, int channels, unsigned int frames, float gain, float step)
+{
+	const float *lanes = __lane_frames[__lane_index(channels)];
+	const float32x4_t ramp_lo = vmulq_n_f32(vld1q_f32(lanes), step);
+	const float32x4_t ramp_hi = vmulq_n_f32(vld1q_f32(lanes + 4), step);
+	unsigned int block = 8 / channels;
+	unsigned int f = 0;
+	for (; f + block <= frames; f += block, src += 8, dst += 8) {
+		float32x4_t g = vdupq_n_f32(gain + f * step);
+		vst1q_s16(dst, __scale_s16x8_neon(vld1q_s16(src), vaddq_f32(g, ramp_lo), vaddq_f32(g, ramp_hi)));
+	}
+	return f;
+}
+
+static unsigned int __scale_u8_neon(const unsigned char *src, unsigned char *dst, int channels, unsigned int frames, float gain, float step)
+{
+	const float *lanes = __lane_frames[__lane_index(channels)];
+	const int16x8_t bias = vdupq_n_s16(128);
+	float32x4_t ramp[4];
+	unsigned int block = 16 / channels;
+	unsigned int f = 0;
+	int k;
+	for (k = 0; k < 4; k++)
+		ramp[k] = vmulq_n_f32(vld1q_f32(lanes + 4 * k), step);
+	for (; f + block <= frames; f += block, src += 16, dst += 16) {
+		float32x4_t g = vdupq_n_f32(gain + f * step);
+		uint8x16_t v = vld1q_u8(src);
+		int16x8_t lo = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(v))), bias);
+		int16x8_t hi = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(v))), bias);
+		lo = vaddq_s16(__scale_s16x8_neon(lo, vaddq_f32(g, ramp[0]), vaddq_f32(g, ramp[1])), bias);
+		hi = vaddq_s16(__scale_s16x8_neon(hi, vaddq_f32(g, ramp[2]), vaddq_f32(g, ramp[3])), bias);
+		vst1q_u8(dst, vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+	}
+	return f;
+}
+#endif
+
+static void __scale(audio_sample_type_e type, int channels, const void *src, void *dst, unsigned int frames, float gain, float step)
+{
+	unsigned int f = 0;
+
+	if (gain == 1.0f && step == 0.0f) {
+		if (src != dst)
+			memcpy(dst, src, frames * channels * _audio_io_get_sample_size(type));
+		return;
+	}
+	if (type == AUDIO_SAMPLE_TYPE_U8) {
+#if defined(__SSE2__)
+		if (__lane_index(channels) >= 0)
+			f = __scale_u8_sse2(src, dst, channels, frames, gain, step);
+#elif defined(AUDIO_IO_HAVE_NEON)
+		if (__lane_index(channels) >= 0)
+			f = __scale_u8_neon(src, dst, channels, frames, gain, step);
+#endif
+		__scale_u8_c((const unsigned char *)src + f * channels, (unsigned char *)dst + f * channels, channels,
+				frames - f, gain + f * step, step);
+	} else {
+#if defined(__SSE2__)
+		if (__lane_index(channels) >= 0)
+			f = __scale_s16_sse2(src, dst, channels, frames, gain, step);
+#elif defined(AUDIO_IO_HAVE_NEON)
+		if (__lane_index(channels) >= 0)
+			f = __scale_s16_neon(src, dst, channels, frames, gain, step);
+#endif
+		__scale_s16_c((const short *)src + f * channels, (short *)dst + f * channels, channels,
+				frames - f, gain + f * step, step);
+	}
+}
+
+void _audio_io_gain_init(audio_io_gain_s *gain)
+{
+	pthread_mutex_init(&gain->lock, NULL);
+	gain->target = 1.0f;
+	gain->ramp_frames = 0;
+	gain->ramp = AUDIO_IO_VOLUME_RAMP_LINEAR;
+	gain->changed = 0;
+	gain->current = 1.0f;
+	gain->end = 1.0f;
+	gain->factor = 1.0f;
+	gain->remaining = 0;
+	gain->exponential = false;
+}
+
+void _audio_io_gain_destroy(audio_io_gain_s *gain)
+{
+	pthread_mutex_destroy(&gain->lock);
+}
+
+void _audio_io_gain_set(audio_io_gain_s *gain, float target, unsigned int ramp_frames)
+{
+	pthread_mutex_lock(&gain->lock);
+	gain->target = target;
+	gain->ramp_frames = ramp_frames;
+	__atomic_store_n(&gain->changed, 1, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&gain->lock);
+}
+
+float _audio_io_gain_get(audio_io_gain_s *gain)
+{
+	float target;
+	pthread_mutex_lock(&gain->lock);
+	target = gain->target;
+	pthread_mutex_unlock(&gain->lock);
+	return target;
+}
+
+void _audio_io_gain_set_ramp(audio_io_gain_s *gain, audio_io_volume_ramp_e ramp)
+{
+	pthread_mutex_lock(&gain->lock);
+	gain->ramp = ramp;
+	pthread_mutex_unlock(&gain->lock);
+}
+
+/* true when the stream passes through unchanged, so the caller may skip the gain stage */
+bool _audio_io_gain_is_unity(audio_io_gain_s *gain)
+{
+	return !__atomic_load_n(&gain->changed, __ATOMIC_ACQUIRE) && gain->remaining == 0 && gain->current == 1.0f;
+}
+
+/* takes the latest request of _audio_io_gain_set() into the transfer side state */
+static void __update(audio_io_gain_s *gain)
+{
+	float target, from, to;
+	unsigned int frames;
+	audio_io_volume_ramp_e ramp;
+
+	pthread_mutex_lock(&gain->lock);
+	__atomic_store_n(&gain->changed, 0, __ATOMIC_RELAXED);
+	target = gain->target;
+	frames = gain->ramp_frames;
+	ramp = gain->ramp;
+	pthread_mutex_unlock(&gain->lock);
+
+	gain->end = target;
+	gain->remaining = frames;
+	gain->exponential = ramp == AUDIO_IO_VOLUME_RAMP_EXPONENTIAL;
+	if (frames == 0) {
+		gain->current = target;
+	} else if (gain->exponential) {
+		from = gain->current > GAIN_EXP_FLOOR ? gain->current : GAIN_EXP_FLOOR;
+		to = target > GAIN_EXP_FLOOR ? target : GAIN_EXP_FLOOR;
+		gain->current = from;
+		gain->factor = powf(to / from, 1.0f / frames);
+	}
+}
+
+void _audio_io_gain_apply(audio_io_gain_s *gain, audio_sample_type_e type, int channels, const void *src, void *dst, unsigned int frames)
+{
+	int frame_size = channels * _audio_io_get_sample_size(type);
+	unsigned int done = 0;
+	unsigned int n;
+	float end;
+
+	if (__atomic_load_n(&gain->changed, __ATOMIC_ACQUIRE))
+		__update(gain);
+
+	while (gain->remaining > 0 && done < frames) {
+		n = frames - done < gain->remaining ? frames - done : gain->remaining;
+		if (gain->exponential && n > GAIN_SEGMENT_FRAMES)
+			n = GAIN_SEGMENT_FRAMES;
+		gain->remaining -= n;
+		if (gain->remaining == 0)
+			end = gain->end;
+		else if (gain->exponential)
+			end = gain->current * powf(gain->factor, n);
+		else
+			end = gain->current + (gain->end - gain->current) * n / (gain->remaining + n);
+		__scale(type, channels, (const char *)src + done * frame_size, (char *)dst + done * frame_size, n,
+				gain->current, (end - gain->current) / n);
+		gain->current = end;
+		done += n;
+	}
+	if (done < frames)
+		__scale(type, channels, (const char *)src + done * frame_size, (char *)dst + done * frame_size, frames - done,
+				gain->current, 0.0f);
+}
@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <audio_io_private.h>
+
+#define AUDIO_IO_LOG_LEVEL_ENV	"AUDIO_IO_LOG_LEVEL"
+
+int _audio_io_log_level = AUDIO_IO_LOG_LEVEL_WARNING;
+
+static const char *__log_level_names[] = {
+	"error",
+	"warning",
+	"info",
+	"debug",
+};
+
+__attribute__((constructor))
+static void __audio_io_log_init(void)
+{
+	const char *env = getenv(AUDIO_IO_LOG_LEVEL_ENV);
+	int i;
+
+	if (env == NULL)
+		return;
+	for (i = 0; i < (int)(sizeof(__log_level_names) / sizeof(__log_level_names[0])); i++) {
+		if (strcasecmp(env, __log_level_names[i]) == 0) {
+			_audio_io_log_level = AUDIO_IO_LOG_LEVEL_ERROR + i;
+			return;
+		}
+	}
+	LOGW("[%s] Unknown %s value : %s", __FUNCTION__, AUDIO_IO_LOG_LEVEL_ENV, env);
+}
+
+int _audio_io_log_ratelimit(unsigned long long *last_us, unsigned int *suppressed, unsigned int *reported)
+{
+	unsigned long long now = _audio_io_get_time_us();
+	unsigned long long last = __atomic_load_n(last_us, __ATOMIC_RELAXED);
+
+	if (last != 0 && now - last < AUDIO_IO_LOG_RATELIMIT_US) {
+		__atomic_fetch_add(suppressed, 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+	if (!__atomic_compare_exchange_n(last_us, &last, now, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		__atomic_fetch_add(suppressed, 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+	*reported = __atomic_exchange_n(suppressed, 0, __ATOMIC_RELAXED);
+	return 1;
+}
+
+int audio_io_set_log_level(audio_io_log_level_e level)
+{
+	AUDIO_IO_CHECK_CONDITION(level >= AUDIO_IO_LOG_LEVEL_ERROR && level <= AUDIO_IO_LOG_LEVEL_DEBUG, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	__atomic_store_n(&_audio_io_log_level, level, __ATOMIC_RELAXED);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_get_log_level(audio_io_log_level_e *level)
+{
+	AUDIO_IO_NULL_ARG_CHECK(level);
+	*level = __atomic_load_n(&_audio_io_log_level, __ATOMIC_RELAXED);
+	return AUDIO_IO_ERROR_NONE;
+}
@@ -0,0 +1,370 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <mm.h>
+#include <audio_io_private.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIO_IO_HAVE_NEON
+#endif
+
+/*
+* Shared mixer : one mm-sound stream per sound type, fed by any number of audio_out voices.
+*
+* Every voice converts its data to the mixer format (S16_LE stereo at AUDIO_IO_MIXER_RATE) and queues
+* it in its own ring. The mixer thread takes one period from each prepared voice, accumulates it with
+* the voice gain into 32-bit sums, saturates back to 16-bit and writes the result to the device.
+* A voice that has not queued a full period contributes what it has, the rest is silence.
+*/
+#define MIXER_FRAME_SIZE	4
+
+static audio_io_mixer_s *__mixers[SOUND_TYPE_CALL + 1];
+static pthread_mutex_t __mixers_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* acc[i] += (src[i] * gain) >> AUDIO_IO_MIX_GAIN_SHIFT */
+static void __mix_s16(int *acc, const short *src, int gain, unsigned int n)
+{
+	unsigned int i = 0;
+
+	if (gain == AUDIO_IO_MIX_GAIN_UNITY) {
+#if defined(__SSE2__)
+		for (; i + 8 <= n; i += 8) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+			_mm_storeu_si128((__m128i *)(acc + i), _mm_add_epi32(_mm_loadu_si128((__m128i *)(acc + i)), lo));
+			_mm_storeu_si128((__m128i *)(acc + i + 4), _mm_add_epi32(_mm_loadu_si128((__m128i *)(acc + i + 4)), hi));
+		}
+#elif defined(AUDIO_IO_HAVE_NEON)
+		for (; i + 8 <= n; i += 8) {
+			int16x8_t v = vld1q_s16(src + i);
+			vst1q_s32(acc + i, vaddw_s16(vld1q_s32(acc + i), vget_low_s16(v)));
+			vst1q_s32(acc + i + 4, vaddw_s16(vld1q_s32(acc + i + 4), vget_high_s16(v)));
+		}
+#endif
+		for (; i < n; i++)
+			acc[i] += src[i];
+		return;
+	}
+
+#if defined(__SSE2__)
+	{
+		const __m128i g = _mm_set1_epi16((short)gain);
+		for (; i + 8 <= n; i += 8) {
+			/* full 32-bit products from the low and high halves of the 16x16 multiply */
+			__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			__m128i pl = _mm_mullo_epi16(v, g);
+			__m128i ph = _mm_mulhi_epi16(v, g);
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(pl, ph), AUDIO_IO_MIX_GAIN_SHIFT);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(pl, ph), AUDIO_IO_MIX_GAIN_SHIFT);
+			_mm_storeu_si128((__m128i *)(acc + i), _mm_add_epi32(_mm_loadu_si128((__m128i *)(acc + i)), lo));
+			_mm_storeu_si128((__m128i *)(acc + i + 4), _mm_add_epi32(_mm_loadu_si128((__m128i *)(acc + i + 4)), hi));
+		}
+	}
+#elif defined(AUDIO_IO_HAVE_NEON)
+	for (; i + 8 <= n; i += 8) {
+		int16x8_t v = vld1q_s16(src + i);
+		int32x4_t lo = vshrq_n_s32(vmull_n_s16(vget_low_s16(v), (short)gain), AUDIO_IO_MIX_GAIN_SHIFT);
+		int32x4_t hi = vshrq_n_s32(vmull_n_s16(vget_high_s16(v), (short)gain), AUDIO_IO_MIX_GAIN_SHIFT);
+		vst1q_s32(acc + i, vaddq_s32(vld1q_s32(acc + i), lo));
+		vst1q_s32(acc + i + 4, vaddq_s32(vld1q_s32(acc + i + 4), hi));
+	}
+#endif
+	for (; i < n; i++)
+		acc[i] += (src[i] * gain) >> AUDIO_IO_MIX_GAIN_SHIFT;
+}
+
+static void __saturate_s16(const int *acc, short *dst, unsigned int n)
+{
+	unsigned int i = 0;
+
+#if defined(__SSE2__)
+	for (; i + 8 <= n; i += 8)
+		_mm_storeu_si128((__m128i *)(dst + i),
+			_mm_packs_epi32(_mm_loadu_si128((const __m128i *)(acc + i)), _mm_loadu_si128((const __m128i *)(acc + i + 4))));
+#elif defined(AUDIO_IO_HAVE_NEON)
+	for (; i + 8 <= n; i += 8)
+		vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vld1q_s32(acc + i)), vqmovn_s32(vld1q_s32(acc + i + 4))));
+#endif
+	for (; i < n; i++)
+		dst[i] = acc[i] > 32767 ? 32767 : (acc[i] < -32768 ? -32768 : acc[i]);
+}
+
+static void __wake_writer(audio_out_s *voice)
+{
+	int value = 0;
+	sem_getvalue(&voice->_ring_sem, &value);
+	if (value == 0)
+		sem_post(&voice->_ring_sem);
+}
+
+/* mixes up to one period of @voice into the accumulator, called with the mixer lock held */
+static void __mix_voice(audio_io_mixer_s *mixer, audio_out_s *voice)
+{
+	int gain = __atomic_load_n(&voice->_mix_gain, __ATOMIC_RELAXED);
+	unsigned int remaining = mixer->period_size;
+	unsigned int offset = 0;
+	unsigned int length;
+	void *region;
+
+	while (remaining > 0) {
+		length = _audio_io_ring_get_read_region(voice->_ring, &region);
+		if (length == 0)
+			break;
+		if (length > remaining)
+			length = remaining;
+		length -= length % MIXER_FRAME_SIZE;
+		if (length == 0)
+			break;
+		if (gain != 0)
+			__mix_s16(mixer->accum + offset / 2, (const short *)region, gain, length / 2);
+		_audio_io_ring_consume(voice->_ring, length);
+		offset += length;
+		remaining -= length;
+	}
+	if (offset > 0) {
+		_audio_io_position_update(&voice->_position, offset, MIXER_FRAME_SIZE);
+		__wake_writer(voice);
+	}
+}
+
+static void *__mixer_thread(void *data)
+{
+	audio_io_mixer_s *mixer = (audio_io_mixer_s *)data;
+	int samples = mixer->period_size / 2;
+	int ret;
+	int i;
+
+	/* the mixer is shared, so it follows the process policy */
+	_audio_io_thread_apply(NULL, &mixer->granted);
+	while (mixer->running) {
+		pthread_mutex_lock(&mixer->lock);
+		while (mixer->running && mixer->voice_count == 0)
+			pthread_cond_wait(&mixer->cond, &mixer->lock);
+		if (!mixer->running) {
+			pthread_mutex_unlock(&mixer->lock);
+			break;
+		}
+		memset(mixer->accum, 0, sizeof(int) * samples);
+		for (i = 0; i < mixer->voice_count; i++)
+			__mix_voice(mixer, mixer->voices[i]);
+		pthread_mutex_unlock(&mixer->lock);
+
+		__saturate_s16(mixer->accum, mixer->output, samples);
+		ret = mixer->backend->write(mixer->stream, mixer->output, mixer->period_size);
+		if (ret < 0 && mixer->running)
+			LOGE("[%s] %s write failed : core fw error(0x%x)", __FUNCTION__, mixer->backend->name, ret);
+	}
+	return NULL;
+}
+
+static void __mixer_free(audio_io_mixer_s *mixer)
+{
+	pthread_cond_destroy(&mixer->cond);
+	pthread_mutex_destroy(&mixer->lock);
+	free(mixer->accum);
+	free(mixer->output);
+	free(mixer);
+}
+
+static audio_io_mixer_s *__mixer_create(sound_type_e sound_type)
+{
+	audio_io_mixer_s *mixer;
+	const char *path;
+	int ret;
+
+	mixer = (audio_io_mixer_s *)malloc(sizeof(audio_io_mixer_s));
+	if (mixer == NULL)
+		return NULL;
+	memset(mixer, 0, sizeof(audio_io_mixer_s));
+	pthread_mutex_init(&mixer->lock, NULL);
+	pthread_cond_init(&mixer->cond, NULL);
+	mixer->sound_type = sound_type;
+
+	mixer->backend = _audio_io_backend_select(NULL, AUDIO_IO_DIRECTION_OUT, &path);
+	ret = mixer->backend->open(&mixer->stream, AUDIO_IO_DIRECTION_OUT, AUDIO_IO_MIXER_RATE, AUDIO_CHANNEL_STEREO, AUDIO_SAMPLE_TYPE_S16_LE,
+			sound_type, path);
+	if (ret < 0) {
+		LOGE("[%s] %s open failed : core fw error(0x%x)", __FUNCTION__, mixer->backend->name, ret);
+		__mixer_free(mixer);
+		return NULL;
+	}
+	mixer->period_size = ret;
+
+	if (posix_memalign((void **)&mixer->accum, AUDIO_IO_CACHE_LINE_SIZE, sizeof(int) * (ret / 2)) != 0 ||
+		posix_memalign((void **)&mixer->output, AUDIO_IO_CACHE_LINE_SIZE, ret) != 0) {
+		mixer->backend->close(mixer->stream, AUDIO_IO_DIRECTION_OUT);
+		__mixer_free(mixer);
+		return NULL;
+	}
+
+	ret = mixer->backend->start(mixer->stream, AUDIO_IO_DIRECTION_OUT);
+	if (ret != MM_ERROR_NONE) {
+		LOGE("[%s] %s start failed : core fw error(0x%x)", __FUNCTION__, mixer->backend->name, ret);
+		mixer->backend->close(mixer->stream, AUDIO_IO_DIRECTION_OUT);
+		__mixer_free(mixer);
+		return NULL;
+	}
+
+	mixer->running = 1;
+	if (pthread_create(&mixer->thread, NULL, __mixer_thread, mixer) != 0) {
+		LOGE("[%s] failed to create mixer thread", __FUNCTION__);
+		mixer->backend->stop(mixer->stream, AUDIO_IO_DIRECTION_OUT);
+		mixer->backend->close(mixer->stream, AUDIO_IO_DIRECTION_OUT);
+		__mixer_free(mixer);
+		return NULL;
+	}
+	return mixer;
+}
+
+static void __mixer_destroy(audio_io_mixer_s *mixer)
+{
+	pthread_mutex_lock(&mixer->lock);
+	mixer->running = 0;
+	pthread_cond_signal(&mixer->cond);
+	pthread_mutex_unlock(&mixer->lock);
+	/* stopping first releases a write blocked in the backend */
+	mixer->backend->stop(mixer->stream, AUDIO_IO_DIRECTION_OUT);
+	pthread_join(mixer->thread, NULL);
+	mixer->backend->close(mixer->stream, AUDIO_IO_DIRECTION_OUT);
+	__mixer_free(mixer);
+}
+
+/*
+* Connects @voice to the mixer of @sound_type, creating it on first use, and sets the voice up to
+* produce mixer format data into its ring.
+*/
+int _audio_io_mixer_attach(audio_out_s *voice, sound_type_e sound_type)
+{
+	audio_io_mixer_s *mixer;
+	int ret;
+
+	pthread_mutex_lock(&__mixers_lock);
+	mixer = __mixers[sound_type];
+	if (mixer == NULL) {
+		mixer = __mixer_create(sound_type);
+		if (mixer == NULL) {
+			pthread_mutex_unlock(&__mixers_lock);
+			return AUDIO_IO_ERROR_DEVICE_NOT_OPENED;
+		}
+		__mixers[sound_type] = mixer;
+	}
+
+	ret = _audio_io_ring_create(&voice->_ring, mixer->period_size * AUDIO_IO_RING_PERIODS);
+	if (ret != AUDIO_IO_ERROR_NONE) {
+		if (mixer->refcount == 0) {
+			__mixers[sound_type] = NULL;
+			__mixer_destroy(mixer);
+		}
+		pthread_mutex_unlock(&__mixers_lock);
+		return ret;
+	}
+	sem_init(&voice->_ring_sem, 0, 0);
+	mixer->refcount++;
+	pthread_mutex_unlock(&__mixers_lock);
+
+	voice->_mixer = mixer;
+	voice->_mix_gain = AUDIO_IO_MIX_GAIN_UNITY;
+	voice->_device_rate = AUDIO_IO_MIXER_RATE;
+	voice->_device_channel = AUDIO_CHANNEL_STEREO;
+	voice->_device_type = AUDIO_SAMPLE_TYPE_S16_LE;
+	voice->_device_buffer_size = mixer->period_size;
+	voice->_period_size = mixer->period_size;
+	voice->_period_count = AUDIO_IO_RING_PERIODS;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+void _audio_io_mixer_detach(audio_out_s *voice)
+{
+	audio_io_mixer_s *mixer = voice->_mixer;
+
+	_audio_io_mixer_stop_voice(voice);
+
+	pthread_mutex_lock(&__mixers_lock);
+	if (--mixer->refcount == 0) {
+		__mixers[mixer->sound_type] = NULL;
+		__mixer_destroy(mixer);
+	}
+	pthread_mutex_unlock(&__mixers_lock);
+
+	sem_destroy(&voice->_ring_sem);
+	_audio_io_ring_destroy(voice->_ring);
+	voice->_ring = NULL;
+	voice->_mixer = NULL;
+}
+
+int _audio_io_mixer_start_voice(audio_out_s *voice)
+{
+	audio_io_mixer_s *mixer = voice->_mixer;
+
+	pthread_mutex_lock(&mixer->lock);
+	if (mixer->voice_count == AUDIO_IO_MIXER_MAX_VOICES) {
+		pthread_mutex_unlock(&mixer->lock);
+		LOGE("[%s] too many voices on the mixer (%d)", __FUNCTION__, AUDIO_IO_MIXER_MAX_VOICES);
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	mixer->voices[mixer->voice_count++] = voice;
+	voice->_mix_active = 1;
+	pthread_cond_signal(&mixer->cond);
+	pthread_mutex_unlock(&mixer->lock);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+void _audio_io_mixer_stop_voice(audio_out_s *voice)
+{
+	audio_io_mixer_s *mixer = voice->_mixer;
+	int i;
+
+	pthread_mutex_lock(&mixer->lock);
+	for (i = 0; i < mixer->voice_count; i++) {
+		if (mixer->voices[i] == voice) {
+			mixer->voices[i] = mixer->voices[--mixer->voice_count];
+			break;
+		}
+	}
+	voice->_mix_active = 0;
+	pthread_mutex_unlock(&mixer->lock);
+
+	/* release a writer blocked on a full ring */
+	sem_post(&voice->_ring_sem);
+}
+
+/*
+* Queues mixer format data for @voice. In non-blocking mode this queues what fits, even while the voice
+* is stopped. Otherwise it blocks until everything is queued, and returns MM_ERROR_SOUND_INVALID_STATE
+* when the voice is not playing. Returns the number of bytes queued.
+*/
+int _audio_io_mixer_write(audio_out_s *voice, const void *buffer, unsigned int length)
+{
+	unsigned int done = 0;
+
+	length -= length % MIXER_FRAME_SIZE;
+	if (voice->_nonblocking)
+		return _audio_io_ring_write(voice->_ring, buffer, length);
+	while (voice->_mix_active) {
+		done += _audio_io_ring_write(voice->_ring, (const char *)buffer + done, length - done);
+		if (done == length)
+			return done;
+		sem_wait(&voice->_ring_sem);
+	}
+	return done > 0 ? (int)done : MM_ERROR_SOUND_INVALID_STATE;
+}
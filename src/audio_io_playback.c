@@ -0,0 +1,241 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <mm.h>
+#include <audio_io_private.h>
+
+/*
+* File playback : the file is mapped and the stream thread of the handle writes it period by period
+* straight from the mapping, so that the samples are only copied where the device path converts them.
+* The kernel is asked to read AUDIO_IO_PLAYBACK_READAHEAD ahead of the playback, and to drop what was
+* played a window behind it, so that a long file holds a few windows of memory at most.
+*/
+static int __read_at(void *source, unsigned long long offset, void *buffer, unsigned int length)
+{
+	audio_io_player_s *player = (audio_io_player_s *)source;
+
+	if (offset >= player->map_size)
+		return 0;
+	if (length > player->map_size - offset)
+		length = player->map_size - offset;
+	memcpy(buffer, (const unsigned char *)player->map + offset, length);
+	return length;
+}
+
+/* finds the samples of a WAV file and checks that they are in the format of the handle */
+static int __parse_wav(audio_io_player_s *player, audio_out_s *handle, const char *path)
+{
+	unsigned long long data_offset;
+	unsigned int data_size;
+	int ret;
+
+	ret = _audio_io_wav_parse(__read_at, player, path, handle->_type, _audio_io_get_channel_count(handle->_channel),
+			handle->_sample_rate, &data_offset, &data_size);
+	if (ret != MM_ERROR_NONE)
+		return _audio_io_convert_error_code(ret, __FUNCTION__);
+	/* a file written while recording may not hold its final size, the data then runs to the end */
+	player->data = (const unsigned char *)player->map + data_offset;
+	player->length = player->map_size - data_offset;
+	if (data_size < player->length)
+		player->length = data_size;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+static void __player_release(audio_io_player_s *player)
+{
+	if (player->map != NULL)
+		munmap(player->map, player->map_size);
+	free(player);
+}
+
+/* keeps a window of the file read ahead of the playback, and drops the pages a window behind it */
+static void __player_advise(audio_io_player_s *player)
+{
+	size_t page_mask = (size_t)sysconf(_SC_PAGESIZE) - 1;
+	size_t start = player->data - (const unsigned char *)player->map;
+	size_t position = start + player->offset;
+	size_t end = start + player->length;
+	size_t ahead;
+	size_t behind;
+
+	if (player->advised < end && player->advised < position + AUDIO_IO_PLAYBACK_READAHEAD) {
+		ahead = position + 2 * AUDIO_IO_PLAYBACK_READAHEAD;
+		if (ahead > end)
+			ahead = end;
+		madvise((char *)player->map + (player->advised & ~page_mask), ahead - (player->advised & ~page_mask), MADV_WILLNEED);
+		player->advised = ahead;
+
+		if (position > AUDIO_IO_PLAYBACK_READAHEAD) {
+			behind = (position - AUDIO_IO_PLAYBACK_READAHEAD) & ~page_mask;
+			if (behind > player->released) {
+				madvise((char *)player->map + player->released, behind - player->released, MADV_DONTNEED);
+				player->released = behind;
+			}
+		}
+	}
+}
+
+static void *__player_thread(void *data)
+{
+	audio_out_s *handle = (audio_out_s *)data;
+	audio_io_player_s *player = handle->_player;
+	unsigned int length;
+	int result = AUDIO_IO_ERROR_NONE;
+	int ret = MM_ERROR_NONE;
+
+	_audio_io_thread_apply(&handle->_thread_policy, &handle->_thread_granted);
+	while (handle->_stream_running && player->offset < player->length) {
+		__player_advise(player);
+		length = player->length - player->offset < (size_t)handle->_buffer_size ? player->length - player->offset : (size_t)handle->_buffer_size;
+		ret = _audio_io_out_write_period(handle, player->data + player->offset, length);
+		if (ret <= 0)
+			break;
+		player->offset += ret;
+	}
+	if (player->offset >= player->length && handle->_stream_running)
+		ret = _audio_io_out_finish_stream(handle);
+	/* a stopped playback ends without the callback, which must not race with the stop */
+	if (!handle->_stream_running)
+		return NULL;
+
+	player->finished = true;
+	if (player->offset < player->length || ret != MM_ERROR_NONE) {
+		if (ret < 0 && ret != MM_ERROR_SOUND_INVALID_STATE)
+			result = _audio_io_convert_error_code(ret, __FUNCTION__);
+		/* a device that took nothing, or a failure without a counterpart */
+		if (result == AUDIO_IO_ERROR_NONE)
+			result = AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	if (player->callback != NULL)
+		player->callback((audio_out_h)handle, result, player->user_data);
+	return NULL;
+}
+
+/* called when the handle starts or resumes; a file played to its end is not played again */
+int _audio_io_player_start(audio_out_s *handle)
+{
+	if (handle->_player->finished)
+		return AUDIO_IO_ERROR_NONE;
+	handle->_stream_running = 1;
+	if (pthread_create(&handle->_stream_thread, NULL, __player_thread, handle) != 0) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_OPERATION(0x%08x) : failed to create playback thread", __FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+		handle->_stream_running = 0;
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_play_file(audio_out_h output, const char *path, audio_io_container_e container, audio_out_playback_cb callback, void *user_data)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	AUDIO_IO_NULL_ARG_CHECK(path);
+	AUDIO_IO_CHECK_CONDITION(container == AUDIO_IO_CONTAINER_WAV || container == AUDIO_IO_CONTAINER_RAW, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	audio_out_s *handle = (audio_out_s *)output;
+	AUDIO_IO_CHECK_CONDITION(!handle->_prepared && handle->_stream_cb == NULL && handle->_player == NULL && !handle->_nonblocking,
+			AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int frame_size = _audio_io_get_channel_count(handle->_channel) * _audio_io_get_sample_size(handle->_type);
+	audio_io_player_s *player;
+	struct stat st;
+	int ret;
+	int fd;
+
+	player = (audio_io_player_s *)calloc(1, sizeof(audio_io_player_s));
+	if (player == NULL) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)", __FUNCTION__, AUDIO_IO_ERROR_OUT_OF_MEMORY);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	player->callback = callback;
+	player->user_data = user_data;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		LOGE("[%s] AUDIO_IO_ERROR_PERMISSION_DENIED(0x%08x) : failed to open %s : %s", __FUNCTION__, AUDIO_IO_ERROR_PERMISSION_DENIED,
+				path, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		__player_release(player);
+		return AUDIO_IO_ERROR_PERMISSION_DENIED;
+	}
+	if (st.st_size <= 0 || (unsigned long long)st.st_size > SIZE_MAX) {
+		LOGE("[%s] AUDIO_IO_ERROR_INVALID_PARAMETER(0x%08x) : %s is empty or too large", __FUNCTION__, AUDIO_IO_ERROR_INVALID_PARAMETER, path);
+		close(fd);
+		__player_release(player);
+		return AUDIO_IO_ERROR_INVALID_PARAMETER;
+	}
+	/* the mapping outlives the descriptor */
+	player->map_size = st.st_size;
+	player->map = mmap(NULL, player->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (player->map == MAP_FAILED) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x) : failed to map %s : %s", __FUNCTION__, AUDIO_IO_ERROR_OUT_OF_MEMORY,
+				path, strerror(errno));
+		player->map = NULL;
+		__player_release(player);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+
+	if (container == AUDIO_IO_CONTAINER_WAV) {
+		ret = __parse_wav(player, handle, path);
+		if (ret != AUDIO_IO_ERROR_NONE) {
+			__player_release(player);
+			return ret;
+		}
+	} else {
+		player->data = (const unsigned char *)player->map;
+		player->length = player->map_size;
+	}
+	player->length -= player->length % frame_size;
+	if (player->length == 0) {
+		LOGE("[%s] AUDIO_IO_ERROR_INVALID_PARAMETER(0x%08x) : %s holds no samples", __FUNCTION__, AUDIO_IO_ERROR_INVALID_PARAMETER, path);
+		__player_release(player);
+		return AUDIO_IO_ERROR_INVALID_PARAMETER;
+	}
+	player->advised = player->data - (const unsigned char *)player->map;
+	madvise(player->map, player->map_size, MADV_SEQUENTIAL);
+
+	/* the stream thread of the handle is the playback loop */
+	handle->_player = player;
+	ret = audio_out_prepare(output);
+	if (ret != AUDIO_IO_ERROR_NONE) {
+		handle->_player = NULL;
+		__player_release(player);
+		return ret;
+	}
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_out_stop_file(audio_out_h output)
+{
+	AUDIO_IO_NULL_ARG_CHECK(output);
+	audio_out_s *handle = (audio_out_s *)output;
+	AUDIO_IO_CHECK_CONDITION(handle->_player != NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	audio_io_player_s *player = handle->_player;
+	int ret;
+
+	/* joins the stream thread, after which nothing reads the mapping */
+	ret = audio_out_unprepare(output);
+	handle->_player = NULL;
+	__player_release(player);
+	return ret;
+}
@@ -0,0 +1,222 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <audio_io_private.h>
+
+/*
+* Buffer pool : period buffers of the handles and of the application are cache line aligned blocks
+* rounded up to a power of two size class. Released blocks are kept on a list per class, up to
+* AUDIO_IO_POOL_MAX_FREE of them, so that handles created and destroyed in a loop reuse them.
+* Each block starts with a header of one cache line, which keeps the data aligned. Blocks in use are
+* linked in a list, which tells the buffers of the pool from others without reading memory before them.
+*
+* Handle arena : handles are carved from chunks of AUDIO_IO_ARENA_SLOTS cache line padded slots, one
+* arena per handle size, so that two handles never share a cache line. Chunks stay with the process.
+* Handles of a chunk share pages, which the memory lock of a handle counts, so that unpreparing one
+* handle leaves the pages of its neighbours locked.
+*/
+#define AUDIO_IO_POOL_HEADER_SIZE	AUDIO_IO_CACHE_LINE_SIZE
+#define AUDIO_IO_ARENAS			4
+
+typedef struct _audio_io_pool_block_s{
+	int size_class;			/* -1 for a buffer too large to be pooled */
+	struct _audio_io_pool_block_s *prev;	/* in the list of blocks in use */
+	struct _audio_io_pool_block_s *next;	/* in the list of blocks in use, or of free blocks */
+} audio_io_pool_block_s;
+
+typedef struct {
+	size_t slot_size;		/* 0 for an unused arena */
+	void *free_slots;		/* linked through the first word of each slot */
+} audio_io_arena_s;
+
+static pthread_mutex_t __lock = PTHREAD_MUTEX_INITIALIZER;
+static audio_io_pool_block_s *__used_blocks;
+static audio_io_pool_block_s *__free_blocks[AUDIO_IO_POOL_CLASSES];
+static int __free_count[AUDIO_IO_POOL_CLASSES];
+static audio_io_arena_s __arenas[AUDIO_IO_ARENAS];
+
+static int __size_class(size_t size)
+{
+	int c;
+
+	for (c = 0; c < AUDIO_IO_POOL_CLASSES; c++) {
+		if (size <= ((size_t)1 << (AUDIO_IO_POOL_MIN_SHIFT + c)))
+			return c;
+	}
+	return -1;
+}
+
+static audio_io_pool_block_s *__get_block(const void *buffer)
+{
+	return (audio_io_pool_block_s *)((char *)buffer - AUDIO_IO_POOL_HEADER_SIZE);
+}
+
+void *_audio_io_pool_alloc(size_t size)
+{
+	audio_io_pool_block_s *block = NULL;
+	int c = __size_class(size);
+	void *mem;
+
+	if (c >= 0) {
+		pthread_mutex_lock(&__lock);
+		block = __free_blocks[c];
+		if (block != NULL) {
+			__free_blocks[c] = block->next;
+			__free_count[c]--;
+		}
+		pthread_mutex_unlock(&__lock);
+		size = (size_t)1 << (AUDIO_IO_POOL_MIN_SHIFT + c);
+	}
+	if (block == NULL) {
+		if (size > SIZE_MAX - AUDIO_IO_POOL_HEADER_SIZE ||
+			posix_memalign(&mem, AUDIO_IO_CACHE_LINE_SIZE, AUDIO_IO_POOL_HEADER_SIZE + size) != 0)
+			return NULL;
+		block = (audio_io_pool_block_s *)mem;
+		block->size_class = c;
+	}
+	pthread_mutex_lock(&__lock);
+	block->prev = NULL;
+	block->next = __used_blocks;
+	if (__used_blocks != NULL)
+		__used_blocks->prev = block;
+	__used_blocks = block;
+	pthread_mutex_unlock(&__lock);
+	return (char *)block + AUDIO_IO_POOL_HEADER_SIZE;
+}
+
+/* tells a live buffer of the pool; a buffer released twice or allocated elsewhere is refused without being read */
+bool _audio_io_pool_owns(const void *buffer)
+{
+	audio_io_pool_block_s *block;
+
+	if (buffer == NULL || ((uintptr_t)buffer & (AUDIO_IO_CACHE_LINE_SIZE - 1)) != 0)
+		return false;
+	pthread_mutex_lock(&__lock);
+	for (block = __used_blocks; block != NULL; block = block->next) {
+		if ((char *)block + AUDIO_IO_POOL_HEADER_SIZE == buffer)
+			break;
+	}
+	pthread_mutex_unlock(&__lock);
+	return block != NULL;
+}
+
+void _audio_io_pool_free(void *buffer)
+{
+	audio_io_pool_block_s *block;
+	int c;
+
+	if (buffer == NULL)
+		return;
+	block = __get_block(buffer);
+	c = block->size_class;
+	pthread_mutex_lock(&__lock);
+	if (block->prev != NULL)
+		block->prev->next = block->next;
+	else
+		__used_blocks = block->next;
+	if (block->next != NULL)
+		block->next->prev = block->prev;
+	if (c >= 0 && __free_count[c] < AUDIO_IO_POOL_MAX_FREE) {
+		block->next = __free_blocks[c];
+		__free_blocks[c] = block;
+		__free_count[c]++;
+		pthread_mutex_unlock(&__lock);
+		return;
+	}
+	pthread_mutex_unlock(&__lock);
+	free(block);
+}
+
+static size_t __slot_size(size_t size)
+{
+	return (size + AUDIO_IO_CACHE_LINE_SIZE - 1) & ~(size_t)(AUDIO_IO_CACHE_LINE_SIZE - 1);
+}
+
+/* returns the arena of @slot_size, claiming an unused one when @claim is set, called with the lock held */
+static audio_io_arena_s *__find_arena(size_t slot_size, bool claim)
+{
+	audio_io_arena_s *unused = NULL;
+	int i;
+
+	for (i = 0; i < AUDIO_IO_ARENAS; i++) {
+		if (__arenas[i].slot_size == slot_size)
+			return &__arenas[i];
+		if (__arenas[i].slot_size == 0 && unused == NULL)
+			unused = &__arenas[i];
+	}
+	if (claim && unused != NULL)
+		unused->slot_size = slot_size;
+	return claim ? unused : NULL;
+}
+
+/* returns a zeroed, cache line aligned handle of @size bytes */
+void *_audio_io_handle_alloc(size_t size)
+{
+	size_t slot_size = __slot_size(size);
+	audio_io_arena_s *arena;
+	void *slot = NULL;
+	char *chunk;
+	int i;
+
+	pthread_mutex_lock(&__lock);
+	arena = __find_arena(slot_size, true);
+	if (arena != NULL) {
+		if (arena->free_slots == NULL && posix_memalign((void **)&chunk, AUDIO_IO_CACHE_LINE_SIZE, slot_size * AUDIO_IO_ARENA_SLOTS) == 0) {
+			for (i = AUDIO_IO_ARENA_SLOTS - 1; i >= 0; i--) {
+				*(void **)(chunk + i * slot_size) = arena->free_slots;
+				arena->free_slots = chunk + i * slot_size;
+			}
+		}
+		slot = arena->free_slots;
+		if (slot != NULL)
+			arena->free_slots = *(void **)slot;
+	}
+	pthread_mutex_unlock(&__lock);
+
+	/* every arena serves another size, the handle is allocated on its own */
+	if (arena == NULL && posix_memalign(&slot, AUDIO_IO_CACHE_LINE_SIZE, slot_size) != 0)
+		return NULL;
+	if (slot != NULL)
+		memset(slot, 0, size);
+	return slot;
+}
+
+void _audio_io_handle_free(void *handle, size_t size)
+{
+	audio_io_arena_s *arena;
+
+	if (handle == NULL)
+		return;
+	pthread_mutex_lock(&__lock);
+	arena = __find_arena(__slot_size(size), false);
+	if (arena != NULL) {
+		*(void **)handle = arena->free_slots;
+		arena->free_slots = handle;
+	}
+	pthread_mutex_unlock(&__lock);
+	if (arena == NULL)
+		free(handle);
+}
+
+int audio_io_buffer_free(void *buffer)
+{
+	AUDIO_IO_CHECK_CONDITION(_audio_io_pool_owns(buffer), AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	_audio_io_pool_free(buffer);
+	return AUDIO_IO_ERROR_NONE;
+}
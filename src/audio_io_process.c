@@ -0,0 +1,388 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <audio_io_private.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIO_IO_HAVE_NEON
+#endif
+
+/*
+* Capture processing chain, run in place on device format data (U8 or S16) right after it is read.
+*
+* The data is converted to interleaved float one chunk at a time, passed through the stages in the order
+* they were added and converted back with saturation. The filters are recursive in time, so they run per
+* channel; the level detection and gain stages work on blocks of PROCESS_BLOCK_FRAMES frames with SIMD
+* kernels, the gain moving linearly across each block.
+*/
+#define PROCESS_CHUNK_FRAMES	1024
+#define PROCESS_BLOCK_FRAMES	64
+
+/* AGC limits and time constants */
+#define AGC_MAX_GAIN		31.62f	/* +30 dB */
+#define AGC_MIN_GAIN		0.1f	/* -20 dB */
+#define AGC_NOISE_FLOOR		0.00316f	/* -50 dBFS, below which the gain holds */
+#define AGC_ATTACK_S		0.005f
+#define AGC_DECAY_S		0.5f
+#define AGC_ENVELOPE_S		0.3f
+
+/* noise gate hysteresis and time constants */
+#define GATE_HYSTERESIS		0.5f	/* closes 6 dB below the threshold */
+#define GATE_HOLD_S		0.05f
+#define GATE_RELEASE_S		0.05f
+
+static float __db_to_linear(float db)
+{
+	return powf(10.0f, db / 20.0f);
+}
+
+/* per block smoothing factor of a one pole follower with time constant @seconds */
+static float __block_coef(float seconds, int sample_rate)
+{
+	return expf(-(float)PROCESS_BLOCK_FRAMES / (seconds * sample_rate));
+}
+
+static float __peak_c(const float *x, unsigned int n)
+{
+	float peak = 0.0f;
+	unsigned int i;
+	for (i = 0; i < n; i++)
+		peak = fabsf(x[i]) > peak ? fabsf(x[i]) : peak;
+	return peak;
+}
+
+static void __ramp_c(float *x, int channels, unsigned int frames, float gain, float step)
+{
+	unsigned int f;
+	int c;
+	for (f = 0; f < frames; f++, gain += step)
+		for (c = 0; c < channels; c++)
+			*x++ *= gain;
+}
+
+#if defined(__SSE2__)
+static float __peak(const float *x, unsigned int n)
+{
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 acc = _mm_setzero_ps();
+	float lanes[4];
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4)
+		acc = _mm_max_ps(acc, _mm_and_ps(_mm_loadu_ps(x + i), abs_mask));
+	_mm_storeu_ps(lanes, acc);
+	lanes[0] = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+	lanes[2] = lanes[2] > lanes[3] ? lanes[2] : lanes[3];
+	lanes[0] = lanes[0] > lanes[2] ? lanes[0] : lanes[2];
+	n = n - i;
+	lanes[1] = __peak_c(x + i, n);
+	return lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+}
+
+/* frame @f is scaled by gain + f * step; vectorized when 4 samples hold whole frames */
+static void __ramp(float *x, int channels, unsigned int frames, float gain, float step)
+{
+	static const float lane_frames[3][4] = { { 0, 1, 2, 3 }, { 0, 0, 1, 1 }, { 0, 0, 0, 0 } };
+	unsigned int block, f = 0;
+	__m128 ramp;
+	if (channels == 1 || channels == 2 || channels == 4) {
+		ramp = _mm_mul_ps(_mm_loadu_ps(lane_frames[channels >> 1]), _mm_set1_ps(step));
+		block = 4 / channels;
+		for (; f + block <= frames; f += block, x += 4)
+			_mm_storeu_ps(x, _mm_mul_ps(_mm_loadu_ps(x), _mm_add_ps(_mm_set1_ps(gain + f * step), ramp)));
+	}
+	__ramp_c(x, channels, frames - f, gain + f * step, step);
+}
+#elif defined(AUDIO_IO_HAVE_NEON)
+static float __peak(const float *x, unsigned int n)
+{
+	float32x4_t acc = vdupq_n_f32(0.0f);
+	float32x2_t m;
+	float peak, tail;
+	unsigned int i = 0;
+	for (; i + 4 <= n; i += 4)
+		acc = vmaxq_f32(acc, vabsq_f32(vld1q_f32(x + i)));
+	m = vpmax_f32(vget_low_f32(acc), vget_high_f32(acc));
+	peak = vget_lane_f32(vpmax_f32(m, m), 0);
+	tail = __peak_c(x + i, n - i);
+	return peak > tail ? peak : tail;
+}
+
+static void __ramp(float *x, int channels, unsigned int frames, float gain, float step)
+{
+	static const float lane_frames[3][4] = { { 0, 1, 2, 3 }, { 0, 0, 1, 1 }, { 0, 0, 0, 0 } };
+	unsigned int block, f = 0;
+	float32x4_t ramp;
+	if (channels == 1 || channels == 2 || channels == 4) {
+		ramp = vmulq_n_f32(vld1q_f32(lane_frames[channels >> 1]), step);
+		block = 4 / channels;
+		for (; f + block <= frames; f += block, x += 4)
+			vst1q_f32(x, vmulq_f32(vld1q_f32(x), vaddq_f32(vdupq_n_f32(gain + f * step), ramp)));
+	}
+	__ramp_c(x, channels, frames - f, gain + f * step, step);
+}
+#else
+#define __peak		__peak_c
+#define __ramp		__ramp_c
+#endif
+
+/* y[n] = x[n] - x[n-1] + R * y[n-1] */
+static void __dc_blocker(audio_io_process_stage_s *stage, float *x, int channels, unsigned int frames)
+{
+	float r = stage->coef[0];
+	float x1, y1, v;
+	unsigned int f;
+	int c;
+	for (c = 0; c < channels; c++) {
+		x1 = stage->z1[c];
+		y1 = stage->z2[c];
+		for (f = 0; f < frames; f++) {
+			v = x[f * channels + c];
+			y1 = v - x1 + r * y1;
+			x1 = v;
+			x[f * channels + c] = y1;
+		}
+		stage->z1[c] = x1;
+		stage->z2[c] = y1;
+	}
+}
+
+/* second order section, transposed direct form II */
+static void __biquad(audio_io_process_stage_s *stage, float *x, int channels, unsigned int frames)
+{
+	float b0 = stage->coef[0], b1 = stage->coef[1], b2 = stage->coef[2];
+	float a1 = stage->coef[3], a2 = stage->coef[4];
+	float z1, z2, v, y;
+	unsigned int f;
+	int c;
+	for (c = 0; c < channels; c++) {
+		z1 = stage->z1[c];
+		z2 = stage->z2[c];
+		for (f = 0; f < frames; f++) {
+			v = x[f * channels + c];
+			y = b0 * v + z1;
+			z1 = b1 * v - a1 * y + z2;
+			z2 = b2 * v - a2 * y;
+			x[f * channels + c] = y;
+		}
+		stage->z1[c] = z1;
+		stage->z2[c] = z2;
+	}
+}
+
+/*
+* The peak envelope is followed with an instant attack. The gain bringing it to the target level is
+* approached quickly when it has to fall and slowly when it may rise, and holds in silence.
+*/
+static void __agc(audio_io_process_stage_s *stage, float *x, int channels, unsigned int frames)
+{
+	float target = stage->coef[0];
+	float envelope_coef = stage->coef[1], attack_coef = stage->coef[2], decay_coef = stage->coef[3];
+	float peak, wanted, gain;
+	unsigned int n;
+
+	while (frames > 0) {
+		n = frames < PROCESS_BLOCK_FRAMES ? frames : PROCESS_BLOCK_FRAMES;
+		peak = __peak(x, n * channels);
+		stage->envelope = peak > stage->envelope ? peak : stage->envelope * envelope_coef;
+		gain = stage->gain;
+		if (stage->envelope > AGC_NOISE_FLOOR) {
+			wanted = target / stage->envelope;
+			wanted = wanted > AGC_MAX_GAIN ? AGC_MAX_GAIN : (wanted < AGC_MIN_GAIN ? AGC_MIN_GAIN : wanted);
+			if (wanted < gain)
+				gain = wanted + (gain - wanted) * attack_coef;
+			else
+				gain = wanted + (gain - wanted) * decay_coef;
+		}
+		__ramp(x, channels, n, stage->gain, (gain - stage->gain) / n);
+		stage->gain = gain;
+		x += n * channels;
+		frames -= n;
+	}
+}
+
+/*
+* Opens as soon as a block peaks over the threshold, and closes after the level has stayed 6 dB below it
+* for the hold time, fading out over the release time.
+*/
+static void __noise_gate(audio_io_process_stage_s *stage, float *x, int channels, unsigned int frames)
+{
+	float threshold = stage->coef[0];
+	float release_coef = stage->coef[1];
+	unsigned int hold_blocks = (unsigned int)stage->coef[2];
+	float peak, gain;
+	unsigned int n;
+
+	while (frames > 0) {
+		n = frames < PROCESS_BLOCK_FRAMES ? frames : PROCESS_BLOCK_FRAMES;
+		peak = __peak(x, n * channels);
+		if (peak >= threshold)
+			stage->hold = hold_blocks;
+		else if (peak < threshold * GATE_HYSTERESIS && stage->hold > 0)
+			stage->hold--;
+		gain = stage->hold > 0 ? 1.0f : stage->gain * release_coef;
+		if (stage->gain != 1.0f || gain != 1.0f)
+			__ramp(x, channels, n, stage->gain, (gain - stage->gain) / n);
+		stage->gain = gain;
+		x += n * channels;
+		frames -= n;
+	}
+}
+
+static void __reset_stage(audio_io_process_stage_s *stage)
+{
+	memset(stage->z1, 0, sizeof(stage->z1));
+	memset(stage->z2, 0, sizeof(stage->z2));
+	stage->envelope = 0.0f;
+	stage->hold = 0;
+	/* the AGC starts flat, the gate starts closed */
+	stage->gain = stage->type == AUDIO_IO_PROCESS_STAGE_NOISE_GATE ? 0.0f : 1.0f;
+}
+
+int _audio_io_process_create(audio_io_process_chain_s **chain, audio_sample_type_e type, int channels, int sample_rate)
+{
+	audio_io_process_chain_s *c;
+
+	c = (audio_io_process_chain_s *)malloc(sizeof(audio_io_process_chain_s));
+	if (c == NULL)
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	memset(c, 0, sizeof(audio_io_process_chain_s));
+	if (posix_memalign((void **)&c->buffer, AUDIO_IO_CACHE_LINE_SIZE, sizeof(float) * PROCESS_CHUNK_FRAMES * channels) != 0) {
+		free(c);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	c->type = type;
+	c->channels = channels;
+	c->sample_rate = sample_rate;
+	*chain = c;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+void _audio_io_process_destroy(audio_io_process_chain_s *chain)
+{
+	if (chain == NULL)
+		return;
+	free(chain->buffer);
+	free(chain);
+}
+
+void _audio_io_process_lock_memory(audio_io_process_chain_s *chain, audio_io_memlock_s *memlock)
+{
+	if (chain == NULL)
+		return;
+	_audio_io_memlock_add(memlock, chain, sizeof(audio_io_process_chain_s));
+	_audio_io_memlock_add(memlock, chain->buffer, sizeof(float) * PROCESS_CHUNK_FRAMES * chain->channels);
+}
+
+int _audio_io_process_add(audio_io_process_chain_s *chain, int type, float param,
+		audio_in_process_cb callback, void *user_data)
+{
+	audio_io_process_stage_s *stage;
+	float rate = chain->sample_rate;
+	float w0, alpha, a0;
+
+	if (chain->stage_count == AUDIO_IO_MAX_PROCESS_STAGES)
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	stage = &chain->stages[chain->stage_count];
+	memset(stage, 0, sizeof(audio_io_process_stage_s));
+	stage->type = type;
+	stage->callback = callback;
+	stage->user_data = user_data;
+
+	switch (type) {
+	case AUDIO_IO_PROCESS_STAGE_DC_BLOCKER:
+		stage->coef[0] = expf(-2.0f * (float)M_PI * param / rate);
+		break;
+	case AUDIO_IO_PROCESS_STAGE_HIGH_PASS:
+		/* Butterworth response, Q = 1/sqrt(2) */
+		w0 = 2.0f * (float)M_PI * param / rate;
+		alpha = sinf(w0) / (2.0f * (float)M_SQRT1_2);
+		a0 = 1.0f + alpha;
+		stage->coef[0] = (1.0f + cosf(w0)) / 2.0f / a0;
+		stage->coef[1] = -(1.0f + cosf(w0)) / a0;
+		stage->coef[2] = stage->coef[0];
+		stage->coef[3] = -2.0f * cosf(w0) / a0;
+		stage->coef[4] = (1.0f - alpha) / a0;
+		break;
+	case AUDIO_IO_PROCESS_STAGE_AGC:
+		stage->coef[0] = __db_to_linear(param);
+		stage->coef[1] = __block_coef(AGC_ENVELOPE_S, chain->sample_rate);
+		stage->coef[2] = __block_coef(AGC_ATTACK_S, chain->sample_rate);
+		stage->coef[3] = __block_coef(AGC_DECAY_S, chain->sample_rate);
+		break;
+	case AUDIO_IO_PROCESS_STAGE_NOISE_GATE:
+		stage->coef[0] = __db_to_linear(param);
+		stage->coef[1] = __block_coef(GATE_RELEASE_S, chain->sample_rate);
+		stage->coef[2] = ceilf(GATE_HOLD_S * rate / PROCESS_BLOCK_FRAMES);
+		break;
+	case AUDIO_IO_PROCESS_STAGE_CUSTOM:
+		break;
+	}
+	__reset_stage(stage);
+	chain->stage_count++;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+void _audio_io_process_reset(audio_io_process_chain_s *chain)
+{
+	int i;
+	if (chain == NULL)
+		return;
+	for (i = 0; i < chain->stage_count; i++)
+		__reset_stage(&chain->stages[i]);
+}
+
+void _audio_io_process_run(audio_io_process_chain_s *chain, audio_in_h input, void *data, unsigned int frames)
+{
+	int frame_size = chain->channels * _audio_io_get_sample_size(chain->type);
+	audio_io_process_stage_s *stage;
+	unsigned int n;
+	int i;
+
+	while (frames > 0) {
+		n = frames < PROCESS_CHUNK_FRAMES ? frames : PROCESS_CHUNK_FRAMES;
+		_audio_io_convert_to_float(data, chain->type, chain->buffer, n * chain->channels);
+		for (i = 0; i < chain->stage_count; i++) {
+			stage = &chain->stages[i];
+			switch (stage->type) {
+			case AUDIO_IO_PROCESS_STAGE_DC_BLOCKER:
+				__dc_blocker(stage, chain->buffer, chain->channels, n);
+				break;
+			case AUDIO_IO_PROCESS_STAGE_HIGH_PASS:
+				__biquad(stage, chain->buffer, chain->channels, n);
+				break;
+			case AUDIO_IO_PROCESS_STAGE_AGC:
+				__agc(stage, chain->buffer, chain->channels, n);
+				break;
+			case AUDIO_IO_PROCESS_STAGE_NOISE_GATE:
+				__noise_gate(stage, chain->buffer, chain->channels, n);
+				break;
+			case AUDIO_IO_PROCESS_STAGE_CUSTOM:
+				stage->callback(input, chain->buffer, chain->channels, chain->sample_rate, n, stage->user_data);
+				break;
+			}
+		}
+		_audio_io_convert_from_float(chain->buffer, chain->type, data, n * chain->channels);
+		data = (char *)data + n * frame_size;
+		frames -= n;
+	}
+}
@@ -0,0 +1,237 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <audio_io_private.h>
+
+/*
+* Recording : the stream thread of the handle queues each captured period in a ring of
+* AUDIO_IO_RECORDING_QUEUE_MS of audio, without ever waiting for storage. The writer thread writes the
+* ring to the file straight from its memory, AUDIO_IO_RECORDING_BATCH_SIZE at a time, and empties it
+* when the recording stops. A period that does not fit in the ring is dropped whole and counted.
+*/
+static int __write_all(int fd, const void *data, size_t length)
+{
+	ssize_t n;
+
+	while (length > 0) {
+		n = write(fd, data, length);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		data = (const char *)data + n;
+		length -= n;
+	}
+	return 0;
+}
+
+static void __wake_writer(audio_io_recorder_s *rec)
+{
+	int value = 0;
+	sem_getvalue(&rec->sem, &value);
+	if (value == 0)
+		sem_post(&rec->sem);
+}
+
+/* called on the stream thread of the handle */
+static void __record_cb(audio_in_h input, const void *buffer, unsigned int length, void *user_data)
+{
+	audio_io_recorder_s *rec = (audio_io_recorder_s *)user_data;
+
+	__atomic_add_fetch(&rec->captured_periods, 1, __ATOMIC_RELAXED);
+	if (rec->write_error || _audio_io_ring_writable(rec->ring) < length) {
+		__atomic_add_fetch(&rec->dropped_periods, 1, __ATOMIC_RELAXED);
+		AUDIO_IO_LOGI_RATELIMITED("[%s] recording queue full, %u bytes dropped", __FUNCTION__, length);
+		return;
+	}
+	_audio_io_ring_write(rec->ring, buffer, length);
+	if (_audio_io_ring_readable(rec->ring) >= rec->batch_size)
+		__wake_writer(rec);
+}
+
+static void *__writer_thread(void *data)
+{
+	audio_io_recorder_s *rec = (audio_io_recorder_s *)data;
+	unsigned int length;
+	int stopping;
+	void *region;
+
+	for (;;) {
+		sem_wait(&rec->sem);
+		stopping = __atomic_load_n(&rec->stopping, __ATOMIC_ACQUIRE);
+		while (_audio_io_ring_readable(rec->ring) >= rec->batch_size || (stopping && _audio_io_ring_readable(rec->ring) > 0)) {
+			length = _audio_io_ring_get_read_region(rec->ring, &region);
+			if (length > rec->batch_size)
+				length = rec->batch_size;
+			if (!rec->write_error) {
+				if (__write_all(rec->fd, region, length) == 0) {
+					__atomic_add_fetch(&rec->written_bytes, length, __ATOMIC_RELAXED);
+				} else {
+					LOGE("[%s] failed to write the recording : %s", __FUNCTION__, strerror(errno));
+					rec->write_error = 1;
+				}
+			}
+			_audio_io_ring_consume(rec->ring, length);
+		}
+		if (stopping)
+			break;
+	}
+	return NULL;
+}
+
+/* writes what is queued, completes the file and releases the recording. Returns 0 or -1 when the file is incomplete. */
+static int __recorder_finish(audio_io_recorder_s *rec, audio_in_s *handle)
+{
+	unsigned char header[AUDIO_IO_WAV_HEADER_SIZE];
+	int ret = rec->write_error ? -1 : 0;
+
+	if (rec->writer_started) {
+		__atomic_store_n(&rec->stopping, 1, __ATOMIC_RELEASE);
+		sem_post(&rec->sem);
+		pthread_join(rec->thread, NULL);
+		ret = rec->write_error ? -1 : 0;
+	}
+	if (rec->fd >= 0) {
+		if (rec->container == AUDIO_IO_CONTAINER_WAV) {
+			_audio_io_wav_fill_header(header, handle->_type, _audio_io_get_channel_count(handle->_channel),
+					handle->_sample_rate, rec->written_bytes);
+			if (pwrite(rec->fd, header, AUDIO_IO_WAV_HEADER_SIZE, 0) != AUDIO_IO_WAV_HEADER_SIZE)
+				ret = -1;
+		}
+		if (close(rec->fd) != 0)
+			ret = -1;
+	}
+	sem_destroy(&rec->sem);
+	_audio_io_ring_destroy(rec->ring);
+	free(rec);
+	return ret;
+}
+
+int audio_in_start_recording(audio_in_h input, const char *path, audio_io_container_e container)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(path);
+	AUDIO_IO_CHECK_CONDITION(container == AUDIO_IO_CONTAINER_WAV || container == AUDIO_IO_CONTAINER_RAW, AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+	audio_in_s *handle = (audio_in_s *)input;
+	AUDIO_IO_CHECK_CONDITION(!handle->_prepared && handle->_stream_cb == NULL && handle->_recorder == NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	int channels = _audio_io_get_channel_count(handle->_channel);
+	unsigned char header[AUDIO_IO_WAV_HEADER_SIZE];
+	audio_io_recorder_s *rec;
+	unsigned int size;
+	int ret;
+
+	rec = (audio_io_recorder_s *)calloc(1, sizeof(audio_io_recorder_s));
+	if (rec == NULL) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)", __FUNCTION__, AUDIO_IO_ERROR_OUT_OF_MEMORY);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	rec->fd = -1;
+	rec->container = container;
+	sem_init(&rec->sem, 0, 0);
+
+	/* the queue holds whole periods, at least a few of them */
+	size = (unsigned long long)handle->_sample_rate * AUDIO_IO_RECORDING_QUEUE_MS / 1000 * channels * _audio_io_get_sample_size(handle->_type);
+	if (size < (unsigned int)handle->_buffer_size * AUDIO_IO_RING_PERIODS)
+		size = handle->_buffer_size * AUDIO_IO_RING_PERIODS;
+	rec->batch_size = size / 2 < AUDIO_IO_RECORDING_BATCH_SIZE ? size / 2 : AUDIO_IO_RECORDING_BATCH_SIZE;
+	if (_audio_io_ring_create(&rec->ring, size) != AUDIO_IO_ERROR_NONE) {
+		__recorder_finish(rec, handle);
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_OUT_OF_MEMORY(0x%08x)", __FUNCTION__, AUDIO_IO_ERROR_OUT_OF_MEMORY);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+
+	rec->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (rec->fd < 0) {
+		LOGE("[%s] AUDIO_IO_ERROR_PERMISSION_DENIED(0x%08x) : failed to create %s : %s", __FUNCTION__, AUDIO_IO_ERROR_PERMISSION_DENIED,
+				path, strerror(errno));
+		__recorder_finish(rec, handle);
+		return AUDIO_IO_ERROR_PERMISSION_DENIED;
+	}
+	/* the sizes are written when the recording stops */
+	if (container == AUDIO_IO_CONTAINER_WAV) {
+		_audio_io_wav_fill_header(header, handle->_type, channels, handle->_sample_rate, 0);
+		if (__write_all(rec->fd, header, AUDIO_IO_WAV_HEADER_SIZE) != 0) {
+			LOGE("[%s] AUDIO_IO_ERROR_PERMISSION_DENIED(0x%08x) : failed to write %s : %s", __FUNCTION__, AUDIO_IO_ERROR_PERMISSION_DENIED,
+					path, strerror(errno));
+			__recorder_finish(rec, handle);
+			return AUDIO_IO_ERROR_PERMISSION_DENIED;
+		}
+	}
+
+	if (pthread_create(&rec->thread, NULL, __writer_thread, rec) != 0) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_OPERATION(0x%08x) : failed to create writer thread", __FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+		__recorder_finish(rec, handle);
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	rec->writer_started = true;
+
+	/* the stream thread of the handle is the capture loop */
+	handle->_recorder = rec;
+	handle->_stream_cb = __record_cb;
+	handle->_stream_userdata = rec;
+	ret = audio_in_prepare(input);
+	if (ret != AUDIO_IO_ERROR_NONE) {
+		handle->_recorder = NULL;
+		handle->_stream_cb = NULL;
+		handle->_stream_userdata = NULL;
+		__recorder_finish(rec, handle);
+		return ret;
+	}
+	_audio_io_memlock_add(&handle->_memlock, rec->ring, sizeof(audio_io_ring_s));
+	_audio_io_memlock_add(&handle->_memlock, rec->ring->buffer, rec->ring->size);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_in_stop_recording(audio_in_h input)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	audio_in_s *handle = (audio_in_s *)input;
+	AUDIO_IO_CHECK_CONDITION(handle->_recorder != NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	audio_io_recorder_s *rec = handle->_recorder;
+	int ret;
+
+	/* joins the stream thread, after which nothing is queued any more */
+	ret = audio_in_unprepare(input);
+	handle->_recorder = NULL;
+	handle->_stream_cb = NULL;
+	handle->_stream_userdata = NULL;
+	if (__recorder_finish(rec, handle) != 0) {
+		LOGE("[%s] ERROR :  AUDIO_IO_ERROR_INVALID_OPERATION(0x%08x) : the recording is incomplete", __FUNCTION__, AUDIO_IO_ERROR_INVALID_OPERATION);
+		return AUDIO_IO_ERROR_INVALID_OPERATION;
+	}
+	return ret;
+}
+
+int audio_in_get_recording_status(audio_in_h input, audio_io_recording_status_s *status)
+{
+	AUDIO_IO_NULL_ARG_CHECK(input);
+	AUDIO_IO_NULL_ARG_CHECK(status);
+	audio_in_s *handle = (audio_in_s *)input;
+	AUDIO_IO_CHECK_CONDITION(handle->_recorder != NULL, AUDIO_IO_ERROR_INVALID_OPERATION, "AUDIO_IO_ERROR_INVALID_OPERATION");
+	audio_io_recorder_s *rec = handle->_recorder;
+
+	status->captured_periods = __atomic_load_n(&rec->captured_periods, __ATOMIC_RELAXED);
+	status->dropped_periods = __atomic_load_n(&rec->dropped_periods, __ATOMIC_RELAXED);
+	status->written_bytes = __atomic_load_n(&rec->written_bytes, __ATOMIC_RELAXED);
+	status->write_error = rec->write_error != 0;
+	return AUDIO_IO_ERROR_NONE;
+}
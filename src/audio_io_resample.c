@@ -0,0 +1,280 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <audio_io_private.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIO_IO_HAVE_NEON
+#endif
+
+/*
+* Polyphase windowed-sinc resampler working on planar float data.
+*
+* The output/input rate ratio is reduced to up/down. The read position is kept exactly in units of
+* 1/up input sample, and each output sample is the dot product of one filter phase with the input
+* around that position. When up exceeds AUDIO_IO_RESAMPLER_MAX_PHASES the output is interpolated
+* linearly between the two nearest phases.
+*/
+#define AUDIO_IO_RESAMPLER_MAX_PHASES	1024
+#define AUDIO_IO_RESAMPLER_MAX_TAPS	512
+
+typedef struct {
+	unsigned int taps;	/* filter length at a ratio of 1, scaled up when downsampling */
+	double beta;		/* Kaiser window shape */
+	double rolloff;		/* cutoff relative to the lower of the two Nyquist frequencies */
+} audio_io_resampler_tier_s;
+
+static const audio_io_resampler_tier_s __tiers[] = {
+	[AUDIO_IO_RESAMPLER_QUALITY_LOW] = { 16, 5.0, 0.85 },
+	[AUDIO_IO_RESAMPLER_QUALITY_MEDIUM] = { 32, 7.0, 0.91 },
+	[AUDIO_IO_RESAMPLER_QUALITY_HIGH] = { 64, 9.0, 0.95 },
+};
+
+static unsigned int __gcd(unsigned int a, unsigned int b)
+{
+	unsigned int t;
+	while (b != 0) {
+		t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/* zeroth order modified Bessel function of the first kind */
+static double __bessel_i0(double x)
+{
+	double sum = 1.0, term = 1.0, q = x * x / 4.0;
+	int k;
+	for (k = 1; k < 50 && term > sum * 1e-12; k++) {
+		term *= q / ((double)k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+static void __build_filter(audio_io_resampler_s *r, const audio_io_resampler_tier_s *tier)
+{
+	double ratio = (double)r->up / r->down;
+	double fc = 0.5 * (ratio < 1.0 ? ratio : 1.0) * tier->rolloff;
+	double half = r->taps / 2.0;
+	double i0_beta = __bessel_i0(tier->beta);
+	unsigned int p, k;
+
+	/* one extra phase at a fraction of 1.0 to interpolate against */
+	for (p = 0; p <= r->phases; p++) {
+		float *h = r->filter + p * r->taps;
+		double frac = (double)p / r->phases;
+		double sum = 0.0, x, t, w;
+
+		for (k = 0; k < r->taps; k++) {
+			x = (double)k - (half - 1.0) - frac;
+			t = x / half;
+			w = (t <= -1.0 || t >= 1.0) ? 0.0 : __bessel_i0(tier->beta * sqrt(1.0 - t * t)) / i0_beta;
+			h[k] = (x == 0.0 ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x)) * w;
+			sum += h[k];
+		}
+		/* unity gain at DC for every phase */
+		for (k = 0; k < r->taps; k++)
+			h[k] /= sum;
+	}
+}
+
+static inline float __dot(const float *h, const float *x, unsigned int n)
+{
+	unsigned int i = 0;
+	float sum;
+#if defined(__SSE__)
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	float lanes[4];
+	for (; i + 8 <= n; i += 8) {
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(h + i), _mm_loadu_ps(x + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(h + i + 4), _mm_loadu_ps(x + i + 4)));
+	}
+	_mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+	sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(AUDIO_IO_HAVE_NEON)
+	float32x4_t acc0 = vdupq_n_f32(0.0f);
+	float32x4_t acc1 = vdupq_n_f32(0.0f);
+	float32x2_t s;
+	for (; i + 8 <= n; i += 8) {
+		acc0 = vmlaq_f32(acc0, vld1q_f32(h + i), vld1q_f32(x + i));
+		acc1 = vmlaq_f32(acc1, vld1q_f32(h + i + 4), vld1q_f32(x + i + 4));
+	}
+	acc0 = vaddq_f32(acc0, acc1);
+	s = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+	sum = vget_lane_f32(vpadd_f32(s, s), 0);
+#else
+	sum = 0.0f;
+#endif
+	for (; i < n; i++)
+		sum += h[i] * x[i];
+	return sum;
+}
+
+int _audio_io_resampler_create(audio_io_resampler_s **resampler, int channels, int in_rate, int out_rate,
+		audio_io_resampler_quality_e quality, unsigned int max_in_frames)
+{
+	const audio_io_resampler_tier_s *tier = &__tiers[quality];
+	audio_io_resampler_s *r;
+	unsigned int g = __gcd(in_rate, out_rate);
+	unsigned int taps;
+	int i;
+
+	r = (audio_io_resampler_s *)malloc(sizeof(audio_io_resampler_s));
+	if (r == NULL)
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	memset(r, 0, sizeof(audio_io_resampler_s));
+
+	r->channels = channels;
+	r->up = out_rate / g;
+	r->down = in_rate / g;
+	r->phases = r->up < AUDIO_IO_RESAMPLER_MAX_PHASES ? r->up : AUDIO_IO_RESAMPLER_MAX_PHASES;
+
+	/* the passband shrinks when downsampling, so the filter gets longer to keep the same transition band */
+	taps = tier->taps;
+	if (r->down > r->up)
+		taps = taps * ((r->down + r->up - 1) / r->up);
+	if (taps > AUDIO_IO_RESAMPLER_MAX_TAPS)
+		taps = AUDIO_IO_RESAMPLER_MAX_TAPS;
+	r->taps = (taps + 7) & ~7U;
+	r->max_in_frames = max_in_frames;
+
+	if (posix_memalign((void **)&r->filter, AUDIO_IO_CACHE_LINE_SIZE, sizeof(float) * (r->phases + 1) * r->taps) != 0) {
+		free(r);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	for (i = 0; i < channels; i++) {
+		if (posix_memalign((void **)&r->history[i], AUDIO_IO_CACHE_LINE_SIZE, sizeof(float) * (r->taps + max_in_frames)) != 0) {
+			r->history[i] = NULL;
+			_audio_io_resampler_destroy(r);
+			return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+		}
+	}
+	__build_filter(r, tier);
+	_audio_io_resampler_reset(r);
+
+	*resampler = r;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+void _audio_io_resampler_destroy(audio_io_resampler_s *resampler)
+{
+	int i;
+
+	if (resampler == NULL)
+		return;
+	for (i = 0; i < resampler->channels; i++)
+		free(resampler->history[i]);
+	free(resampler->filter);
+	free(resampler);
+}
+
+void _audio_io_resampler_lock_memory(audio_io_resampler_s *resampler, audio_io_memlock_s *memlock)
+{
+	int i;
+
+	if (resampler == NULL)
+		return;
+	_audio_io_memlock_add(memlock, resampler, sizeof(audio_io_resampler_s));
+	_audio_io_memlock_add(memlock, resampler->filter, sizeof(float) * (resampler->phases + 1) * resampler->taps);
+	for (i = 0; i < resampler->channels; i++)
+		_audio_io_memlock_add(memlock, resampler->history[i], sizeof(float) * (resampler->taps + resampler->max_in_frames));
+}
+
+void _audio_io_resampler_reset(audio_io_resampler_s *resampler)
+{
+	/* half a window of silence in front of the stream, so that the first output is centered on the first input */
+	unsigned int lead = resampler->taps / 2 - 1;
+	int i;
+
+	for (i = 0; i < resampler->channels; i++)
+		memset(resampler->history[i], 0, sizeof(float) * lead);
+	resampler->fill = lead;
+	resampler->pos = (unsigned long long)lead * resampler->up;
+}
+
+unsigned int _audio_io_resampler_get_max_output(audio_io_resampler_s *resampler, unsigned int in_frames)
+{
+	return (unsigned int)(((unsigned long long)in_frames * resampler->up + resampler->down - 1) / resampler->down) + 1;
+}
+
+unsigned int _audio_io_resampler_get_max_input(audio_io_resampler_s *resampler, unsigned int out_frames)
+{
+	if (out_frames <= 1)
+		return 0;
+	return (unsigned int)((unsigned long long)(out_frames - 1) * resampler->down / resampler->up);
+}
+
+/* input frames the filter holds back : the last input sample reaches the output only after this many more */
+unsigned int _audio_io_resampler_get_delay(audio_io_resampler_s *resampler)
+{
+	return resampler->taps / 2;
+}
+
+unsigned int _audio_io_resampler_process(audio_io_resampler_s *resampler, float **in, unsigned int frames, float **out)
+{
+	audio_io_resampler_s *r = resampler;
+	unsigned int half = r->taps / 2;
+	unsigned int total = r->fill + frames;
+	unsigned long long pos = r->pos;
+	unsigned long long index;
+	unsigned long long phase;
+	unsigned int produced = 0;
+	unsigned int keep;
+	const float *h;
+	const float *x;
+	float frac, y;
+	int c;
+
+	for (c = 0; c < r->channels; c++)
+		memcpy(r->history[c] + r->fill, in[c], sizeof(float) * frames);
+
+	/* output at integer position i needs history[i - half + 1 .. i + half] */
+	while ((index = pos / r->up) + half < total) {
+		phase = (pos % r->up) * r->phases;
+		h = r->filter + (unsigned int)(phase / r->up) * r->taps;
+		if (r->phases == r->up) {
+			for (c = 0; c < r->channels; c++)
+				out[c][produced] = __dot(h, r->history[c] + index - half + 1, r->taps);
+		} else {
+			frac = (float)(phase % r->up) / r->up;
+			for (c = 0; c < r->channels; c++) {
+				x = r->history[c] + index - half + 1;
+				y = __dot(h, x, r->taps);
+				out[c][produced] = y + frac * (__dot(h + r->taps, x, r->taps) - y);
+			}
+		}
+		produced++;
+		pos += r->down;
+	}
+
+	/* drop the input no later output can reach */
+	keep = pos / r->up - half + 1 < total ? (unsigned int)(pos / r->up - half + 1) : total;
+	for (c = 0; c < r->channels; c++)
+		memmove(r->history[c], r->history[c] + keep, sizeof(float) * (total - keep));
+	r->fill = total - keep;
+	r->pos = pos - (unsigned long long)keep * r->up;
+	return produced;
+}
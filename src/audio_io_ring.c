@@ -0,0 +1,137 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <audio_io_private.h>
+
+/*
+* Single-producer / single-consumer byte ring.
+* head is only advanced by the producer and tail only by the consumer; both are
+* free running counters, so (head - tail) is the number of queued bytes.
+* The buffer is rounded up to a power of two for masking, but at most the requested size is queued.
+*/
+#define RING_LOAD(x)		__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define RING_STORE(x, v)	__atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+int _audio_io_ring_create(audio_io_ring_s **ring, unsigned int size)
+{
+	audio_io_ring_s *r;
+	unsigned int capacity = 1;
+
+	while (capacity < size)
+		capacity <<= 1;
+
+	r = (audio_io_ring_s *)malloc(sizeof(audio_io_ring_s));
+	if (r == NULL)
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	memset(r, 0, sizeof(audio_io_ring_s));
+
+	r->buffer = (unsigned char *)malloc(capacity);
+	if (r->buffer == NULL) {
+		free(r);
+		return AUDIO_IO_ERROR_OUT_OF_MEMORY;
+	}
+	r->size = capacity;
+	r->mask = capacity - 1;
+	r->limit = size;
+	*ring = r;
+	return AUDIO_IO_ERROR_NONE;
+}
+
+void _audio_io_ring_destroy(audio_io_ring_s *ring)
+{
+	if (ring == NULL)
+		return;
+	free(ring->buffer);
+	free(ring);
+}
+
+void _audio_io_ring_reset(audio_io_ring_s *ring)
+{
+	RING_STORE(ring->tail, RING_LOAD(ring->head));
+}
+
+unsigned int _audio_io_ring_readable(audio_io_ring_s *ring)
+{
+	return RING_LOAD(ring->head) - RING_LOAD(ring->tail);
+}
+
+unsigned int _audio_io_ring_writable(audio_io_ring_s *ring)
+{
+	return ring->limit - _audio_io_ring_readable(ring);
+}
+
+unsigned int _audio_io_ring_write(audio_io_ring_s *ring, const void *data, unsigned int length)
+{
+	unsigned int head = ring->head;
+	unsigned int space = ring->limit - (head - RING_LOAD(ring->tail));
+	unsigned int offset = head & ring->mask;
+	unsigned int first;
+
+	if (length > space)
+		length = space;
+	if (length == 0)
+		return 0;
+
+	first = ring->size - offset;
+	if (first > length)
+		first = length;
+	memcpy(ring->buffer + offset, data, first);
+	memcpy(ring->buffer, (const unsigned char *)data + first, length - first);
+
+	RING_STORE(ring->head, head + length);
+	return length;
+}
+
+unsigned int _audio_io_ring_read(audio_io_ring_s *ring, void *data, unsigned int length)
+{
+	unsigned int tail = ring->tail;
+	unsigned int avail = RING_LOAD(ring->head) - tail;
+	unsigned int offset = tail & ring->mask;
+	unsigned int first;
+
+	if (length > avail)
+		length = avail;
+	if (length == 0)
+		return 0;
+
+	first = ring->size - offset;
+	if (first > length)
+		first = length;
+	memcpy(data, ring->buffer + offset, first);
+	memcpy((unsigned char *)data + first, ring->buffer, length - first);
+
+	RING_STORE(ring->tail, tail + length);
+	return length;
+}
+
+unsigned int _audio_io_ring_get_read_region(audio_io_ring_s *ring, void **data)
+{
+	unsigned int tail = ring->tail;
+	unsigned int avail = RING_LOAD(ring->head) - tail;
+	unsigned int offset = tail & ring->mask;
+
+	if (avail > ring->size - offset)
+		avail = ring->size - offset;
+	*data = ring->buffer + offset;
+	return avail;
+}
+
+void _audio_io_ring_consume(audio_io_ring_s *ring, unsigned int length)
+{
+	RING_STORE(ring->tail, ring->tail + length);
+}
@@ -0,0 +1,108 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <string.h>
+#include <time.h>
+#include <audio_io_private.h>
+
+#define STATS_ADD(x, v)		__atomic_fetch_add(&(x), (v), __ATOMIC_RELAXED)
+#define STATS_LOAD(x)		__atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define STATS_STORE(x, v)	__atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+
+unsigned long long _audio_io_get_time_us(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+void _audio_io_stats_init(audio_io_stats_counters_s *stats, unsigned long long period_us)
+{
+	memset(stats, 0, sizeof(audio_io_stats_counters_s));
+	stats->period_us = period_us;
+}
+
+void _audio_io_stats_restart(audio_io_stats_counters_s *stats)
+{
+	STATS_STORE(stats->last_end_us, 0);
+}
+
+unsigned long long _audio_io_stats_begin(audio_io_stats_counters_s *stats)
+{
+	unsigned long long now = _audio_io_get_time_us();
+	unsigned long long last_end = STATS_LOAD(stats->last_end_us);
+
+	/* the device queue holds about one period, so a longer gap between calls means it ran dry (or full) */
+	if (last_end != 0 && now - last_end > stats->period_us)
+		STATS_ADD(stats->xrun_count, 1);
+	return now;
+}
+
+void _audio_io_stats_end(audio_io_stats_counters_s *stats, unsigned long long start_us, unsigned int requested, int result)
+{
+	unsigned long long now = _audio_io_get_time_us();
+	unsigned long long elapsed = now - start_us;
+	int bucket = 0;
+
+	while (elapsed > 1 && bucket < AUDIO_IO_STATS_LATENCY_BUCKETS - 1) {
+		elapsed >>= 1;
+		bucket++;
+	}
+
+	STATS_ADD(stats->call_count, 1);
+	STATS_ADD(stats->blocked_time_us, now - start_us);
+	STATS_ADD(stats->latency_histogram[bucket], 1);
+	if (result > 0) {
+		STATS_ADD(stats->total_bytes, result);
+		if ((unsigned int)result < requested)
+			STATS_ADD(stats->short_count, 1);
+	}
+	STATS_STORE(stats->last_end_us, now);
+}
+
+void _audio_io_stats_get(audio_io_stats_counters_s *stats, audio_io_stats_s *out)
+{
+	int i;
+
+	out->total_bytes = STATS_LOAD(stats->total_bytes);
+	out->call_count = STATS_LOAD(stats->call_count);
+	out->blocked_time_us = STATS_LOAD(stats->blocked_time_us);
+	out->short_count = STATS_LOAD(stats->short_count);
+	out->xrun_count = STATS_LOAD(stats->xrun_count);
+	for (i = 0; i < AUDIO_IO_STATS_LATENCY_BUCKETS; i++)
+		out->latency_histogram[i] = STATS_LOAD(stats->latency_histogram[i]);
+}
+
+void _audio_io_stats_reset(audio_io_stats_counters_s *stats)
+{
+	int i;
+
+	STATS_STORE(stats->total_bytes, 0);
+	STATS_STORE(stats->call_count, 0);
+	STATS_STORE(stats->blocked_time_us, 0);
+	STATS_STORE(stats->short_count, 0);
+	STATS_STORE(stats->xrun_count, 0);
+	for (i = 0; i < AUDIO_IO_STATS_LATENCY_BUCKETS; i++)
+		STATS_STORE(stats->latency_histogram[i], 0);
+}
+
+void _audio_io_position_update(audio_io_position_s *position, int transferred, int frame_size)
+{
+	if (transferred <= 0)
+		return;
+	__atomic_fetch_add(&position->frames, transferred / frame_size, __ATOMIC_RELAXED);
+	__atomic_store_n(&position->timestamp_us, _audio_io_get_time_us(), __ATOMIC_RELEASE);
+}
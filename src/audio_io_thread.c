@@ -0,0 +1,342 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <audio_io_private.h>
+
+/*
+* Real-time support : library threads apply their policy to themselves when they start, and fall
+* back to what they inherited when the process may not use it. Handle memory is locked region by region
+* while the handle is prepared; a region that cannot be locked leaves the handle reported as unlocked.
+* Page locks do not nest and small regions share pages with each other, so the locked pages are counted
+* in a table of the process, sorted by address, and a page is unlocked when the last region on it goes.
+*/
+#define AUDIO_IO_MAX_CPUS	64
+
+typedef struct {
+	uintptr_t page;
+	unsigned int count;		/* regions on the page */
+} audio_io_locked_page_s;
+
+static pthread_mutex_t __lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t __page_lock = PTHREAD_MUTEX_INITIALIZER;
+static audio_io_locked_page_s *__pages;
+static size_t __page_count;
+static size_t __page_capacity;
+static audio_io_thread_policy_s __policy = {
+	.is_set = true,
+	.policy = AUDIO_IO_THREAD_POLICY_NORMAL,
+};
+
+bool _audio_io_thread_policy_is_valid(audio_io_thread_policy_e policy, int priority)
+{
+	if (policy == AUDIO_IO_THREAD_POLICY_NORMAL)
+		return true;
+	if (policy != AUDIO_IO_THREAD_POLICY_FIFO && policy != AUDIO_IO_THREAD_POLICY_RR)
+		return false;
+	return priority >= sched_get_priority_min(SCHED_FIFO) && priority <= sched_get_priority_max(SCHED_FIFO);
+}
+
+void _audio_io_thread_policy_init(audio_io_thread_policy_s *out, audio_io_thread_policy_e policy, int priority, unsigned long long cpu_mask)
+{
+	out->is_set = true;
+	out->policy = policy;
+	out->priority = policy == AUDIO_IO_THREAD_POLICY_NORMAL ? 0 : priority;
+	out->cpu_mask = cpu_mask;
+}
+
+/* applies @policy to the calling thread and writes what it runs with to @granted. Returns 0 or the first error. */
+static int __apply(const audio_io_thread_policy_s *policy, audio_io_thread_policy_s *granted)
+{
+	struct sched_param param;
+	cpu_set_t set;
+	int sched_policy;
+	int err = 0;
+	int ret;
+	int i;
+
+	memset(granted, 0, sizeof(audio_io_thread_policy_s));
+	granted->is_set = true;
+
+	if (policy->cpu_mask != 0) {
+		CPU_ZERO(&set);
+		for (i = 0; i < AUDIO_IO_MAX_CPUS && i < CPU_SETSIZE; i++) {
+			if (policy->cpu_mask & (1ULL << i))
+				CPU_SET(i, &set);
+		}
+		ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+		if (ret == 0)
+			granted->cpu_mask = policy->cpu_mask;
+		else
+			err = ret;
+	}
+
+	if (policy->policy != AUDIO_IO_THREAD_POLICY_NORMAL) {
+		param.sched_priority = policy->priority;
+		ret = pthread_setschedparam(pthread_self(), policy->policy == AUDIO_IO_THREAD_POLICY_FIFO ? SCHED_FIFO : SCHED_RR, &param);
+		if (ret != 0 && err == 0)
+			err = ret;
+	}
+
+	/* report what the thread really runs with, which may also be a policy it inherited */
+	if (pthread_getschedparam(pthread_self(), &sched_policy, &param) == 0) {
+		if (sched_policy == SCHED_FIFO || sched_policy == SCHED_RR) {
+			granted->policy = sched_policy == SCHED_FIFO ? AUDIO_IO_THREAD_POLICY_FIFO : AUDIO_IO_THREAD_POLICY_RR;
+			granted->priority = param.sched_priority;
+		}
+	}
+	return err;
+}
+
+/* called by a library thread when it starts; @requested that is not set follows audio_io_set_thread_policy() */
+void _audio_io_thread_apply(const audio_io_thread_policy_s *requested, audio_io_thread_policy_s *granted)
+{
+	audio_io_thread_policy_s policy;
+	int ret;
+
+	if (requested != NULL && requested->is_set) {
+		policy = *requested;
+	} else {
+		pthread_mutex_lock(&__lock);
+		policy = __policy;
+		pthread_mutex_unlock(&__lock);
+	}
+	ret = __apply(&policy, granted);
+	if (ret != 0)
+		AUDIO_IO_LOGW("[%s] thread policy %d priority %d cpus 0x%llx not granted (%s), running with policy %d priority %d",
+				__FUNCTION__, policy.policy, policy.priority, policy.cpu_mask, strerror(ret), granted->policy, granted->priority);
+}
+
+void _audio_io_memlock_enable(audio_io_memlock_s *memlock)
+{
+	memlock->active = memlock->requested;
+	memlock->failed = false;
+	memlock->count = 0;
+}
+
+static size_t __find_page(uintptr_t page)
+{
+	size_t lo = 0;
+	size_t hi = __page_count;
+	size_t mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (__pages[mid].page < page)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* drops a reference to the pages of [first, end) and unlocks those no region holds any more, called with the lock held */
+static void __unref_pages(uintptr_t first, uintptr_t end, size_t page_size)
+{
+	size_t i = __find_page(first);
+	size_t kept = i;
+
+	for (; i < __page_count && __pages[i].page < end; i++) {
+		if (--__pages[i].count == 0)
+			munlock((void *)__pages[i].page, page_size);
+		else
+			__pages[kept++] = __pages[i];
+	}
+	memmove(&__pages[kept], &__pages[i], (__page_count - i) * sizeof(audio_io_locked_page_s));
+	__page_count -= i - kept;
+}
+
+/* takes a reference to the pages of [first, end) and locks them; returns 0 or -1, called with the lock held */
+static int __ref_pages(uintptr_t first, uintptr_t end, size_t page_size)
+{
+	size_t pages = (end - first) / page_size;
+	size_t lo = __find_page(first);
+	size_t hi = __find_page(end);
+	size_t missing = pages - (hi - lo);
+	size_t capacity;
+	size_t dst;
+	size_t k;
+	uintptr_t page;
+	audio_io_locked_page_s *grown;
+
+	if (missing == 0) {
+		for (k = lo; k < hi; k++)
+			__pages[k].count++;
+		return 0;
+	}
+	if (__page_count + missing > __page_capacity) {
+		capacity = __page_capacity ? __page_capacity : 256;
+		while (capacity < __page_count + missing)
+			capacity *= 2;
+		grown = (audio_io_locked_page_s *)realloc(__pages, capacity * sizeof(audio_io_locked_page_s));
+		if (grown == NULL)
+			return -1;
+		__pages = grown;
+		__page_capacity = capacity;
+	}
+	/* the range is merged in place from its end, the pages after it move up by the pages it adds */
+	memmove(&__pages[hi + missing], &__pages[hi], (__page_count - hi) * sizeof(audio_io_locked_page_s));
+	k = hi;
+	dst = lo + pages;
+	for (page = end; page > first; ) {
+		page -= page_size;
+		dst--;
+		if (k > lo && __pages[k - 1].page == page) {
+			k--;
+			__pages[dst] = __pages[k];
+			__pages[dst].count++;
+		} else {
+			__pages[dst].page = page;
+			__pages[dst].count = 1;
+		}
+	}
+	__page_count += missing;
+	/* locking a page again does nothing, so the whole range is locked in one call */
+	if (mlock((void *)first, end - first) != 0) {
+		__unref_pages(first, end, page_size);
+		return -1;
+	}
+	return 0;
+}
+
+static void __get_page_range(const void *addr, size_t length, uintptr_t *first, uintptr_t *end, size_t *page_size)
+{
+	*page_size = (size_t)sysconf(_SC_PAGESIZE);
+	*first = (uintptr_t)addr & ~(uintptr_t)(*page_size - 1);
+	*end = ((uintptr_t)addr + length + *page_size - 1) & ~(uintptr_t)(*page_size - 1);
+}
+
+/* locks a region of a handle whose memory lock is active; NULL and empty regions are skipped */
+void _audio_io_memlock_add(audio_io_memlock_s *memlock, void *addr, size_t length)
+{
+	uintptr_t first;
+	uintptr_t end;
+	size_t page_size;
+	int ret = -1;
+
+	if (!memlock->active || memlock->failed || addr == NULL || length == 0)
+		return;
+	__get_page_range(addr, length, &first, &end, &page_size);
+	if (memlock->count < AUDIO_IO_MAX_LOCKED_REGIONS) {
+		pthread_mutex_lock(&__page_lock);
+		ret = __ref_pages(first, end, page_size);
+		pthread_mutex_unlock(&__page_lock);
+	}
+	if (ret != 0) {
+		AUDIO_IO_LOGW("[%s] failed to lock %zu bytes, the handle memory stays pageable", __FUNCTION__, length);
+		memlock->failed = true;
+		return;
+	}
+	memlock->addr[memlock->count] = addr;
+	memlock->length[memlock->count] = length;
+	memlock->count++;
+}
+
+/* unlocks a region before it is freed; pages other regions hold stay locked */
+void _audio_io_memlock_remove(audio_io_memlock_s *memlock, const void *addr)
+{
+	uintptr_t first;
+	uintptr_t end;
+	size_t page_size;
+	int i;
+
+	for (i = 0; i < memlock->count; i++) {
+		if (memlock->addr[i] == addr) {
+			__get_page_range(memlock->addr[i], memlock->length[i], &first, &end, &page_size);
+			pthread_mutex_lock(&__page_lock);
+			__unref_pages(first, end, page_size);
+			pthread_mutex_unlock(&__page_lock);
+			memlock->count--;
+			memlock->addr[i] = memlock->addr[memlock->count];
+			memlock->length[i] = memlock->length[memlock->count];
+			return;
+		}
+	}
+}
+
+void _audio_io_memlock_release(audio_io_memlock_s *memlock)
+{
+	uintptr_t first;
+	uintptr_t end;
+	size_t page_size;
+	int i;
+
+	pthread_mutex_lock(&__page_lock);
+	for (i = 0; i < memlock->count; i++) {
+		__get_page_range(memlock->addr[i], memlock->length[i], &first, &end, &page_size);
+		__unref_pages(first, end, page_size);
+	}
+	pthread_mutex_unlock(&__page_lock);
+	memlock->count = 0;
+	memlock->active = false;
+	memlock->failed = false;
+}
+
+void _audio_io_realtime_status_get(const audio_io_thread_policy_s *granted, const audio_io_memlock_s *memlock,
+		audio_io_realtime_status_s *status)
+{
+	status->policy = granted->is_set ? granted->policy : AUDIO_IO_THREAD_POLICY_NORMAL;
+	status->priority = granted->is_set ? granted->priority : 0;
+	status->cpu_mask = granted->is_set ? granted->cpu_mask : 0;
+	status->memory_locked = memlock != NULL && memlock->active && !memlock->failed;
+}
+
+int audio_io_set_thread_policy(audio_io_thread_policy_e policy, int priority, unsigned long long cpu_mask)
+{
+	AUDIO_IO_CHECK_CONDITION(_audio_io_thread_policy_is_valid(policy, priority), AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+
+	pthread_mutex_lock(&__lock);
+	_audio_io_thread_policy_init(&__policy, policy, priority, cpu_mask);
+	pthread_mutex_unlock(&__lock);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_get_thread_policy(audio_io_thread_policy_e *policy, int *priority, unsigned long long *cpu_mask)
+{
+	AUDIO_IO_NULL_ARG_CHECK(policy);
+	AUDIO_IO_NULL_ARG_CHECK(priority);
+	AUDIO_IO_NULL_ARG_CHECK(cpu_mask);
+
+	pthread_mutex_lock(&__lock);
+	*policy = __policy.policy;
+	*priority = __policy.priority;
+	*cpu_mask = __policy.cpu_mask;
+	pthread_mutex_unlock(&__lock);
+	return AUDIO_IO_ERROR_NONE;
+}
+
+int audio_io_set_current_thread_policy(audio_io_thread_policy_e policy, int priority, unsigned long long cpu_mask)
+{
+	audio_io_thread_policy_s requested;
+	audio_io_thread_policy_s granted;
+	int ret;
+
+	AUDIO_IO_CHECK_CONDITION(_audio_io_thread_policy_is_valid(policy, priority), AUDIO_IO_ERROR_INVALID_PARAMETER, "AUDIO_IO_ERROR_INVALID_PARAMETER");
+
+	_audio_io_thread_policy_init(&requested, policy, priority, cpu_mask);
+	ret = __apply(&requested, &granted);
+	if (ret != 0) {
+		LOGE("[%s] AUDIO_IO_ERROR_PERMISSION_DENIED(0x%08x) : %s", __FUNCTION__, AUDIO_IO_ERROR_PERMISSION_DENIED, strerror(ret));
+		return AUDIO_IO_ERROR_PERMISSION_DENIED;
+	}
+	return AUDIO_IO_ERROR_NONE;
+}
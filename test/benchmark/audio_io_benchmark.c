@@ -0,0 +1,469 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+* Benchmark of the audio-io library against the mm-sound stand-in of mm_sound_stub.c.
+*
+* usage : audio_io_benchmark [-q] [output.json]
+*
+*   -q     shorter runs, for a quick check
+*
+* The results are written as JSON to the given file, or to the standard output :
+*
+*   call_overhead   time per audio_out_write() / audio_in_read() of one buffer, device time excluded
+*   create_destroy  time to create and destroy a handle, with and without the handle cache
+*   throughput      processing speed for every sample rate, channel type and sample type
+*   jitter          spread of the write completion times of concurrent real-time handles
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <audio_io.h>
+#include "mm_sound_stub.h"
+
+#define JITTER_HANDLES		16
+
+typedef struct {
+	int sample_rate;
+	audio_channel_e channel;
+	audio_sample_type_e type;
+	const char *name;
+} benchmark_format_s;
+
+typedef struct {
+	audio_out_h output;
+	int periods;
+	unsigned long long *completions;
+	int ret;
+} jitter_thread_s;
+
+static const int __rates[] = { 8000, 11025, 16000, 22050, 32000, 44100, 48000, 96000, 192000 };
+
+static const struct {
+	audio_channel_e channel;
+	const char *name;
+} __channels[] = {
+	{ AUDIO_CHANNEL_MONO, "mono" },
+	{ AUDIO_CHANNEL_STEREO, "stereo" },
+	{ AUDIO_CHANNEL_MULTI_3, "multi_3" },
+	{ AUDIO_CHANNEL_MULTI_4, "multi_4" },
+	{ AUDIO_CHANNEL_MULTI_5, "multi_5" },
+	{ AUDIO_CHANNEL_MULTI_6, "multi_6" },
+	{ AUDIO_CHANNEL_MULTI_7, "multi_7" },
+	{ AUDIO_CHANNEL_MULTI_8, "multi_8" },
+};
+
+static const struct {
+	audio_sample_type_e type;
+	const char *name;
+} __types[] = {
+	{ AUDIO_SAMPLE_TYPE_U8, "u8" },
+	{ AUDIO_SAMPLE_TYPE_S16_LE, "s16le" },
+	{ AUDIO_SAMPLE_TYPE_S24_LE, "s24le" },
+	{ AUDIO_SAMPLE_TYPE_S32_LE, "s32le" },
+	{ AUDIO_SAMPLE_TYPE_FLOAT32_LE, "float32le" },
+};
+
+/* the device format, a converted format and a resampled format */
+static const benchmark_format_s __call_formats[] = {
+	{ 48000, AUDIO_CHANNEL_STEREO, AUDIO_SAMPLE_TYPE_S16_LE, "direct" },
+	{ 48000, AUDIO_CHANNEL_MULTI_6, AUDIO_SAMPLE_TYPE_FLOAT32_LE, "converted" },
+	{ 96000, AUDIO_CHANNEL_STEREO, AUDIO_SAMPLE_TYPE_S16_LE, "resampled" },
+};
+
+static int __quick;
+
+static unsigned long long __now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int __compare_ull(const void *a, const void *b)
+{
+	unsigned long long x = *(const unsigned long long *)a;
+	unsigned long long y = *(const unsigned long long *)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static int __channel_count(audio_channel_e channel)
+{
+	return channel - AUDIO_CHANNEL_MONO + 1;
+}
+
+static int __sample_size(audio_sample_type_e type)
+{
+	switch (type) {
+	case AUDIO_SAMPLE_TYPE_U8:
+		return 1;
+	case AUDIO_SAMPLE_TYPE_S16_LE:
+		return 2;
+	case AUDIO_SAMPLE_TYPE_S24_LE:
+		return 3;
+	default:
+		return 4;
+	}
+}
+
+static const char *__channel_name(audio_channel_e channel)
+{
+	return __channels[channel - AUDIO_CHANNEL_MONO].name;
+}
+
+static const char *__type_name(audio_sample_type_e type)
+{
+	return __types[type - AUDIO_SAMPLE_TYPE_U8].name;
+}
+
+/* prints mean, median and 99th percentile of @samples, which is sorted in place */
+static void __print_distribution(FILE *out, unsigned long long *samples, int count, const char *unit)
+{
+	unsigned long long sum = 0;
+	int i;
+
+	qsort(samples, count, sizeof(unsigned long long), __compare_ull);
+	for (i = 0; i < count; i++)
+		sum += samples[i];
+	fprintf(out, "\"mean_%s\": %.1f, \"p50_%s\": %llu, \"p99_%s\": %llu, \"max_%s\": %llu",
+			unit, (double)sum / count, unit, samples[count / 2], unit, samples[count * 99 / 100], unit, samples[count - 1]);
+}
+
+static int __bench_call_overhead(FILE *out)
+{
+	int iterations = __quick ? 200 : 2000;
+	unsigned long long *samples = malloc(sizeof(unsigned long long) * iterations);
+	const benchmark_format_s *f;
+	audio_out_h output;
+	audio_in_h input;
+	void *buffer = NULL;
+	unsigned long long start;
+	int size, i, d, k;
+	int ret = 0;
+
+	if (samples == NULL)
+		return -1;
+	fprintf(out, "  \"call_overhead\": [\n");
+	for (k = 0; k < (int)(sizeof(__call_formats) / sizeof(__call_formats[0])); k++) {
+		f = &__call_formats[k];
+		for (d = 0; d < 2; d++) {
+			if (d == 0) {
+				ret = audio_out_create(f->sample_rate, f->channel, f->type, SOUND_TYPE_MEDIA, &output);
+				if (ret == AUDIO_IO_ERROR_NONE)
+					ret = audio_out_get_buffer_size(output, &size);
+			} else {
+				ret = audio_in_create(f->sample_rate, f->channel, f->type, &input);
+				if (ret == AUDIO_IO_ERROR_NONE)
+					ret = audio_in_get_buffer_size(input, &size);
+			}
+			if (ret != AUDIO_IO_ERROR_NONE)
+				goto out;
+			buffer = calloc(1, size);
+			if (buffer == NULL) {
+				ret = -1;
+				goto out;
+			}
+			if (d == 0)
+				audio_out_prepare(output);
+			else
+				audio_in_prepare(input);
+			for (i = 0; i < iterations; i++) {
+				start = __now_ns();
+				ret = d == 0 ? audio_out_write(output, buffer, size) : audio_in_read(input, buffer, size);
+				samples[i] = __now_ns() - start;
+				if (ret != size)
+					break;
+			}
+			if (d == 0)
+				audio_out_destroy(output);
+			else
+				audio_in_destroy(input);
+			free(buffer);
+			buffer = NULL;
+			if (i < iterations)
+				goto out;
+			fprintf(out, "    { \"direction\": \"%s\", \"path\": \"%s\", \"rate\": %d, \"channel\": \"%s\", \"type\": \"%s\", "
+					"\"bytes\": %d, \"iterations\": %d, ",
+					d == 0 ? "out" : "in", f->name, f->sample_rate, __channel_name(f->channel), __type_name(f->type),
+					size, iterations);
+			__print_distribution(out, samples, iterations, "ns");
+			fprintf(out, " }%s\n", k == (int)(sizeof(__call_formats) / sizeof(__call_formats[0])) - 1 && d == 1 ? "" : ",");
+		}
+	}
+	fprintf(out, "  ],\n");
+	ret = 0;
+out:
+	free(samples);
+	return ret;
+}
+
+static int __bench_create_destroy(FILE *out)
+{
+	int iterations = __quick ? 100 : 1000;
+	unsigned long long *samples = malloc(sizeof(unsigned long long) * iterations);
+	audio_out_h output;
+	audio_in_h input;
+	unsigned long long start;
+	int cache, d, i;
+	int ret = 0;
+
+	if (samples == NULL)
+		return -1;
+	fprintf(out, "  \"create_destroy\": [\n");
+	for (cache = 0; cache < 2; cache++) {
+		audio_io_set_handle_cache(cache ? 4 : 0, 10000);
+		for (d = 0; d < 2; d++) {
+			for (i = 0; i < iterations; i++) {
+				start = __now_ns();
+				if (d == 0) {
+					ret = audio_out_create(48000, AUDIO_CHANNEL_STEREO, AUDIO_SAMPLE_TYPE_S16_LE, SOUND_TYPE_MEDIA, &output);
+					if (ret == AUDIO_IO_ERROR_NONE)
+						ret = audio_out_destroy(output);
+				} else {
+					ret = audio_in_create(48000, AUDIO_CHANNEL_STEREO, AUDIO_SAMPLE_TYPE_S16_LE, &input);
+					if (ret == AUDIO_IO_ERROR_NONE)
+						ret = audio_in_destroy(input);
+				}
+				samples[i] = __now_ns() - start;
+				if (ret != AUDIO_IO_ERROR_NONE)
+					goto out;
+			}
+			fprintf(out, "    { \"direction\": \"%s\", \"handle_cache\": %s, \"iterations\": %d, ",
+					d == 0 ? "out" : "in", cache ? "true" : "false", iterations);
+			__print_distribution(out, samples, iterations, "ns");
+			fprintf(out, " }%s\n", cache == 1 && d == 1 ? "" : ",");
+		}
+	}
+	fprintf(out, "  ],\n");
+out:
+	audio_io_set_handle_cache(0, 0);
+	free(samples);
+	return ret;
+}
+
+/* processes @seconds of audio and prints the speed relative to real time */
+static int __bench_throughput_one(FILE *out, int direction, int rate, audio_channel_e channel, audio_sample_type_e type,
+		double seconds, int last)
+{
+	unsigned long long frames = (unsigned long long)(rate * seconds);
+	int frame_size = __channel_count(channel) * __sample_size(type);
+	unsigned long long done = 0;
+	unsigned long long start, elapsed;
+	audio_out_h output = NULL;
+	audio_in_h input = NULL;
+	void *buffer;
+	int size, ret;
+
+	if (direction == 0)
+		ret = audio_out_create(rate, channel, type, SOUND_TYPE_MEDIA, &output);
+	else
+		ret = audio_in_create(rate, channel, type, &input);
+	if (ret != AUDIO_IO_ERROR_NONE)
+		return ret;
+	if (direction == 0)
+		audio_out_get_buffer_size(output, &size);
+	else
+		audio_in_get_buffer_size(input, &size);
+	buffer = calloc(1, size);
+	if (buffer == NULL) {
+		ret = -1;
+		goto out;
+	}
+	if (direction == 0)
+		audio_out_prepare(output);
+	else
+		audio_in_prepare(input);
+
+	start = __now_ns();
+	while (done < frames) {
+		ret = direction == 0 ? audio_out_write(output, buffer, size) : audio_in_read(input, buffer, size);
+		if (ret <= 0)
+			goto out;
+		done += ret / frame_size;
+	}
+	elapsed = __now_ns() - start;
+	ret = 0;
+
+	fprintf(out, "    { \"direction\": \"%s\", \"rate\": %d, \"channel\": \"%s\", \"type\": \"%s\", \"frames\": %llu, "
+			"\"elapsed_ns\": %llu, \"realtime_factor\": %.1f, \"mb_per_s\": %.1f }%s\n",
+			direction == 0 ? "out" : "in", rate, __channel_name(channel), __type_name(type), done, elapsed,
+			(double)done / rate * 1e9 / elapsed, (double)done * frame_size * 1e3 / elapsed, last ? "" : ",");
+out:
+	free(buffer);
+	if (output)
+		audio_out_destroy(output);
+	if (input)
+		audio_in_destroy(input);
+	return ret;
+}
+
+static int __bench_throughput(FILE *out)
+{
+	int rate_count = sizeof(__rates) / sizeof(__rates[0]);
+	int channel_count = sizeof(__channels) / sizeof(__channels[0]);
+	int type_count = sizeof(__types) / sizeof(__types[0]);
+	double seconds = __quick ? 0.1 : 1.0;
+	int d, r, c, t, ret;
+
+	fprintf(out, "  \"throughput\": [\n");
+	for (d = 0; d < 2; d++)
+		for (r = 0; r < rate_count; r++)
+			for (c = 0; c < channel_count; c++)
+				for (t = 0; t < type_count; t++) {
+					ret = __bench_throughput_one(out, d, __rates[r], __channels[c].channel, __types[t].type, seconds,
+							d == 1 && r == rate_count - 1 && c == channel_count - 1 && t == type_count - 1);
+					if (ret != 0)
+						return ret;
+				}
+	fprintf(out, "  ],\n");
+	return 0;
+}
+
+static void *__jitter_thread(void *data)
+{
+	jitter_thread_s *thread = (jitter_thread_s *)data;
+	void *buffer;
+	int size, i;
+
+	audio_out_get_buffer_size(thread->output, &size);
+	buffer = calloc(1, size);
+	if (buffer == NULL) {
+		thread->ret = -1;
+		return NULL;
+	}
+	for (i = 0; i < thread->periods; i++) {
+		thread->ret = audio_out_write(thread->output, buffer, size);
+		thread->completions[i] = __now_ns();
+		if (thread->ret != size)
+			break;
+	}
+	thread->ret = i == thread->periods ? 0 : -1;
+	free(buffer);
+	return NULL;
+}
+
+/*
+* Each handle writes one period at a time to a real-time device from its own thread. In steady state every write
+* completes one period after the previous one; the deviation from that is the jitter added by the library and the
+* scheduler.
+*/
+static int __bench_jitter(FILE *out)
+{
+	jitter_thread_s threads[JITTER_HANDLES];
+	pthread_t ids[JITTER_HANDLES];
+	int periods = __quick ? 25 : 250;
+	/* the first periods fill the device buffer and return at once */
+	int warmup = 5;
+	int count = JITTER_HANDLES * (periods - warmup - 1);
+	unsigned long long *deviations = malloc(sizeof(unsigned long long) * count);
+	unsigned long long period_ns = 0;
+	double sum = 0.0, sum_sq = 0.0, interval;
+	int size, i, k, n = 0;
+	int ret = 0;
+
+	if (deviations == NULL)
+		return -1;
+	memset(threads, 0, sizeof(threads));
+	mm_sound_stub_set_realtime(1);
+	for (k = 0; k < JITTER_HANDLES; k++) {
+		threads[k].periods = periods;
+		threads[k].completions = malloc(sizeof(unsigned long long) * periods);
+		if (threads[k].completions == NULL)
+			ret = -1;
+		else
+			ret = audio_out_create(48000, AUDIO_CHANNEL_STEREO, AUDIO_SAMPLE_TYPE_S16_LE, SOUND_TYPE_MEDIA, &threads[k].output);
+		if (ret != AUDIO_IO_ERROR_NONE)
+			goto out;
+		audio_out_prepare(threads[k].output);
+	}
+	audio_out_get_buffer_size(threads[0].output, &size);
+	period_ns = (unsigned long long)size / 4 * 1000000000ULL / 48000;
+
+	for (k = 0; k < JITTER_HANDLES; k++)
+		pthread_create(&ids[k], NULL, __jitter_thread, &threads[k]);
+	for (k = 0; k < JITTER_HANDLES; k++) {
+		pthread_join(ids[k], NULL);
+		if (threads[k].ret != 0)
+			ret = -1;
+	}
+	if (ret != 0)
+		goto out;
+
+	for (k = 0; k < JITTER_HANDLES; k++) {
+		for (i = warmup + 1; i < periods; i++) {
+			interval = (double)(threads[k].completions[i] - threads[k].completions[i - 1]);
+			sum += interval;
+			sum_sq += interval * interval;
+			deviations[n++] = (unsigned long long)fabs(interval - (double)period_ns);
+		}
+	}
+	fprintf(out, "  \"jitter\": { \"handles\": %d, \"period_ns\": %llu, \"intervals\": %d, \"interval_stddev_ns\": %.1f, ",
+			JITTER_HANDLES, period_ns, n, sqrt(sum_sq / n - (sum / n) * (sum / n)));
+	__print_distribution(out, deviations, n, "deviation_ns");
+	fprintf(out, " }\n");
+out:
+	for (k = 0; k < JITTER_HANDLES; k++) {
+		if (threads[k].output)
+			audio_out_destroy(threads[k].output);
+		free(threads[k].completions);
+	}
+	mm_sound_stub_set_realtime(0);
+	free(deviations);
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = NULL;
+	FILE *out = stdout;
+	int ret, i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-q") == 0)
+			__quick = 1;
+		else
+			path = argv[i];
+	}
+	if (path) {
+		out = fopen(path, "w");
+		if (out == NULL) {
+			perror(path);
+			return 1;
+		}
+	}
+
+	fprintf(out, "{\n  \"benchmark\": \"capi-media-audio-io\",\n  \"version\": 1,\n  \"quick\": %s,\n", __quick ? "true" : "false");
+	ret = __bench_call_overhead(out);
+	if (ret == 0)
+		ret = __bench_create_destroy(out);
+	if (ret == 0)
+		ret = __bench_throughput(out);
+	if (ret == 0)
+		ret = __bench_jitter(out);
+	fprintf(out, "}\n");
+
+	if (path)
+		fclose(out);
+	if (ret != 0) {
+		fprintf(stderr, "benchmark failed (%d)\n", ret);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,184 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <mm.h>
+#include <mm_sound.h>
+#include "mm_sound_stub.h"
+
+typedef struct {
+	unsigned int rate;
+	unsigned int frame_size;
+	unsigned int buffer_size;
+	int started;
+	int realtime;
+	unsigned long long start_ns;
+	unsigned long long frames;
+	void *sink;
+	unsigned int sink_size;
+} mm_sound_stub_stream_s;
+
+static int __realtime;
+
+void mm_sound_stub_set_realtime(int realtime)
+{
+	__atomic_store_n(&__realtime, realtime, __ATOMIC_RELAXED);
+}
+
+static unsigned long long __now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void __sleep_until(unsigned long long deadline_ns)
+{
+	struct timespec ts;
+	ts.tv_sec = deadline_ns / 1000000000ULL;
+	ts.tv_nsec = deadline_ns % 1000000000ULL;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+		;
+}
+
+static int __open(MMSoundPcmHandle_t *handle, unsigned int rate, MMSoundPcmChannel_t channel, MMSoundPcmFormat_t format)
+{
+	mm_sound_stub_stream_s *s;
+
+	if (handle == NULL)
+		return MM_ERROR_SOUND_INVALID_POINTER;
+	s = (mm_sound_stub_stream_s *)calloc(1, sizeof(mm_sound_stub_stream_s));
+	if (s == NULL)
+		return MM_ERROR_SOUND_INTERNAL;
+	s->rate = rate;
+	s->frame_size = (channel == MMSOUND_PCM_STEREO ? 2 : 1) * (format == MMSOUND_PCM_U8 ? 1 : 2);
+	s->buffer_size = rate * MM_SOUND_STUB_PERIOD_MS / 1000 * s->frame_size;
+	*handle = s;
+	return s->buffer_size;
+}
+
+static int __start(MMSoundPcmHandle_t handle)
+{
+	mm_sound_stub_stream_s *s = (mm_sound_stub_stream_s *)handle;
+	s->started = 1;
+	s->realtime = __atomic_load_n(&__realtime, __ATOMIC_RELAXED);
+	s->start_ns = __now_ns();
+	s->frames = 0;
+	return MM_ERROR_NONE;
+}
+
+static int __stop(MMSoundPcmHandle_t handle)
+{
+	((mm_sound_stub_stream_s *)handle)->started = 0;
+	return MM_ERROR_NONE;
+}
+
+static int __close(MMSoundPcmHandle_t handle)
+{
+	mm_sound_stub_stream_s *s = (mm_sound_stub_stream_s *)handle;
+	free(s->sink);
+	free(s);
+	return MM_ERROR_NONE;
+}
+
+/* position in the stream, in ns from the start, at which @frames frames have been played or recorded */
+static unsigned long long __frames_to_ns(mm_sound_stub_stream_s *s, unsigned long long frames)
+{
+	return s->start_ns + frames * 1000000000ULL / s->rate;
+}
+
+int mm_sound_pcm_capture_open(MMSoundPcmHandle_t *handle, const unsigned int rate, MMSoundPcmChannel_t channel, MMSoundPcmFormat_t format)
+{
+	return __open(handle, rate, channel, format);
+}
+
+int mm_sound_pcm_capture_start(MMSoundPcmHandle_t handle)
+{
+	return __start(handle);
+}
+
+int mm_sound_pcm_capture_stop(MMSoundPcmHandle_t handle)
+{
+	return __stop(handle);
+}
+
+int mm_sound_pcm_capture_read(MMSoundPcmHandle_t handle, void *buffer, const unsigned int length)
+{
+	mm_sound_stub_stream_s *s = (mm_sound_stub_stream_s *)handle;
+	unsigned int frames = length / s->frame_size;
+
+	if (!s->started)
+		return MM_ERROR_SOUND_INVALID_STATE;
+	s->frames += frames;
+	if (s->realtime)
+		__sleep_until(__frames_to_ns(s, s->frames));
+	/* the copy out of the server */
+	memset(buffer, 0, frames * s->frame_size);
+	return frames * s->frame_size;
+}
+
+int mm_sound_pcm_capture_close(MMSoundPcmHandle_t handle)
+{
+	return __close(handle);
+}
+
+int mm_sound_pcm_play_open(MMSoundPcmHandle_t *handle, const unsigned int rate, MMSoundPcmChannel_t channel, MMSoundPcmFormat_t format, const volume_type_t volume_type)
+{
+	return __open(handle, rate, channel, format);
+}
+
+int mm_sound_pcm_play_start(MMSoundPcmHandle_t handle)
+{
+	return __start(handle);
+}
+
+int mm_sound_pcm_play_stop(MMSoundPcmHandle_t handle)
+{
+	return __stop(handle);
+}
+
+int mm_sound_pcm_play_write(MMSoundPcmHandle_t handle, void *ptr, unsigned int length_byte)
+{
+	mm_sound_stub_stream_s *s = (mm_sound_stub_stream_s *)handle;
+	unsigned int buffered = s->buffer_size / s->frame_size;
+
+	if (!s->started)
+		return MM_ERROR_SOUND_INVALID_STATE;
+	if (ptr == NULL)
+		return MM_ERROR_SOUND_INVALID_POINTER;
+	/* the copy into the server */
+	if (s->sink_size < length_byte) {
+		free(s->sink);
+		s->sink = malloc(length_byte);
+		if (s->sink == NULL) {
+			s->sink_size = 0;
+			return MM_ERROR_SOUND_INTERNAL;
+		}
+		s->sink_size = length_byte;
+	}
+	memcpy(s->sink, ptr, length_byte);
+	s->frames += length_byte / s->frame_size;
+	if (s->realtime && s->frames > buffered)
+		__sleep_until(__frames_to_ns(s, s->frames - buffered));
+	return length_byte;
+}
+
+int mm_sound_pcm_play_close(MMSoundPcmHandle_t handle)
+{
+	return __close(handle);
+}
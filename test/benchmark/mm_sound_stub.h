@@ -0,0 +1,33 @@
+/*
+* Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef __TIZEN_MEDIA_AUDIO_IO_MM_SOUND_STUB_H__
+#define __TIZEN_MEDIA_AUDIO_IO_MM_SOUND_STUB_H__
+
+/*
+* Stand-in for the mm-sound PCM API used by the benchmark.
+*
+* Streams accept and produce data immediately, so that only the cost of the library is measured.
+* In real-time mode a stream moves data at its sample rate instead : a write returns once the device,
+* which buffers one period, has room for the data, and a read returns once the data has been recorded.
+*/
+
+/* buffer size returned by the open calls */
+#define MM_SOUND_STUB_PERIOD_MS		20
+
+void mm_sound_stub_set_realtime(int realtime);
+
+#endif //__TIZEN_MEDIA_AUDIO_IO_MM_SOUND_STUB_H__